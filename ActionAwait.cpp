@@ -0,0 +1,164 @@
+#include "ActionAwait.h"
+
+#ifdef INPUT_COROUTINES_ENABLED
+#include <algorithm>
+#include <SDL2/SDL_timer.h>
+
+#define INPUT_TASK_FRAME_GRANULARITY	64
+#define INPUT_TASK_FRAME_SIZE_CLASSES	16
+
+namespace {
+	// Free lists of coroutine frames per size class. Frames larger than the biggest class use the global heap.
+	struct TaskFramePool {
+		struct FreeFrame {
+			FreeFrame* Next;
+		};
+		FreeFrame* FreeLists[INPUT_TASK_FRAME_SIZE_CLASSES] = { };
+
+		~TaskFramePool() {
+			for ( FreeFrame*& list : FreeLists ) {
+				while ( list ) {
+					FreeFrame* next = list->Next;
+					::operator delete( list );
+					list = next;
+				}
+			}
+		}
+	};
+
+	thread_local TaskFramePool t_TaskFramePool;
+
+	int GetSizeClass( size_t size ) {
+		return static_cast<int>( ( size + INPUT_TASK_FRAME_GRANULARITY - 1 ) / INPUT_TASK_FRAME_GRANULARITY ) - 1;
+	}
+}
+
+void* InputTask::promise_type::operator new( size_t size ) {
+	int sizeClass = GetSizeClass( size );
+	if ( sizeClass >= INPUT_TASK_FRAME_SIZE_CLASSES ) {
+		return ::operator new( size );
+	}
+	TaskFramePool::FreeFrame*& list = t_TaskFramePool.FreeLists[sizeClass];
+	if ( list ) {
+		void* frame = list;
+		list = list->Next;
+		return frame;
+	}
+	return ::operator new( ( sizeClass + 1 ) * INPUT_TASK_FRAME_GRANULARITY );
+}
+
+void InputTask::promise_type::operator delete( void* memory, size_t size ) {
+	int sizeClass = GetSizeClass( size );
+	if ( sizeClass >= INPUT_TASK_FRAME_SIZE_CLASSES ) {
+		::operator delete( memory );
+		return;
+	}
+	TaskFramePool::FreeFrame* frame = static_cast<TaskFramePool::FreeFrame*>( memory );
+	frame->Next = t_TaskFramePool.FreeLists[sizeClass];
+	t_TaskFramePool.FreeLists[sizeClass] = frame;
+}
+
+void ActionAwaiter::await_suspend( std::coroutine_handle<> handle ) {
+	m_Scheduler.Suspend( *this, handle );
+}
+
+ActionScheduler::ActionScheduler( const KeyBindings& keyBindings, InputContext& input )
+	: m_Notifier( keyBindings, input ), m_Input( input ) {
+	m_UpdateCallbackHandle = m_Input.RegisterUpdateInterest( std::bind( &ActionScheduler::Update, this ) );
+}
+
+ActionScheduler::~ActionScheduler() {
+	m_Input.UnregisterUpdateInterest( m_UpdateCallbackHandle );
+	// Waiters that never resumed own their coroutine frames
+	for ( Waiter& waiter : m_Waiters ) {
+		if ( waiter.Active ) {
+			waiter.Active = false;
+			waiter.Handle.destroy();
+		}
+	}
+}
+
+void ActionScheduler::Update() {
+	Uint32 now = SDL_GetTicks();
+	auto   later = [] ( const Timeout& lhs, const Timeout& rhs ) {
+		return static_cast<Sint32>( lhs.Deadline - rhs.Deadline ) > 0;
+	};
+	while ( !m_Timeouts.empty() && static_cast<Sint32>( now - m_Timeouts.front().Deadline ) >= 0 ) {
+		std::pop_heap( m_Timeouts.begin(), m_Timeouts.end(), later );
+		Timeout timeout = m_Timeouts.back();
+		m_Timeouts.pop_back();
+		if ( m_Waiters[timeout.Waiter].Active && m_Waiters[timeout.Waiter].Generation == timeout.Generation ) {
+			Complete( timeout.Waiter, ActionIdentifier() );
+		}
+	}
+	// Also resumes the waiters that timed out
+	ResumeStarted();
+}
+
+void ActionScheduler::ResumeStarted() {
+	m_Notifier.Dispatch();
+	for ( const Start& started : m_Started ) {
+		if ( m_Waiters[started.Waiter].Active && m_Waiters[started.Waiter].Generation == started.Generation ) {
+			Complete( started.Waiter, started.Action );
+		}
+	}
+	m_Started.clear();
+
+	// Resumed coroutines may suspend again, which must not touch the list being iterated
+	pVector<std::coroutine_handle<>> ready;
+	ready.swap( m_Ready );
+	for ( std::coroutine_handle<> handle : ready ) {
+		handle.resume();
+	}
+}
+
+int ActionScheduler::GetNrOfWaiters() const {
+	return static_cast<int>( m_Waiters.size() - m_FreeWaiters.size() );
+}
+
+void ActionScheduler::Suspend( ActionAwaiter& awaiter, std::coroutine_handle<> handle ) {
+	int index;
+	if ( m_FreeWaiters.empty() ) {
+		index = static_cast<int>( m_Waiters.size() );
+		m_Waiters.emplace_back();
+		m_Subscriptions.resize( m_Waiters.size() * INPUT_AWAIT_MAX_ACTIONS );
+	} else {
+		index = m_FreeWaiters.back();
+		m_FreeWaiters.pop_back();
+	}
+	Waiter& waiter = m_Waiters[index];
+	waiter.Handle  = handle;
+	waiter.Awaiter = &awaiter;
+	waiter.Active  = true;
+	++waiter.Generation;
+
+	for ( int i = 0; i < awaiter.m_Actions.size(); ++i ) {
+		ActionIdentifier action = awaiter.m_Actions[i];
+		m_Subscriptions[index * INPUT_AWAIT_MAX_ACTIONS + i] = m_Notifier.Subscribe( awaiter.m_BindContext, action, awaiter.m_InputType,
+			[this, index, action] ( const ActionChange& change ) {
+				// Completed after Dispatch since completing unsubscribes this callback
+				if ( change.Phase == ACTION_PHASE_STARTED ) {
+					m_Started.push_back( Start { index, m_Waiters[index].Generation, action } );
+				}
+			} );
+	}
+	if ( awaiter.m_TimeoutTicks > 0 ) {
+		m_Timeouts.push_back( Timeout { SDL_GetTicks() + awaiter.m_TimeoutTicks, index, waiter.Generation } );
+		std::push_heap( m_Timeouts.begin(), m_Timeouts.end(), [] ( const Timeout& lhs, const Timeout& rhs ) {
+			return static_cast<Sint32>( lhs.Deadline - rhs.Deadline ) > 0;
+		} );
+	}
+}
+
+void ActionScheduler::Complete( int index, ActionIdentifier result ) {
+	Waiter& waiter = m_Waiters[index];
+	for ( int i = 0; i < waiter.Awaiter->m_Actions.size(); ++i ) {
+		m_Notifier.Unsubscribe( m_Subscriptions[index * INPUT_AWAIT_MAX_ACTIONS + i] );
+	}
+	waiter.Awaiter->m_Result = result;
+	waiter.Active			 = false;
+	m_Ready.push_back( waiter.Handle );
+	m_FreeWaiters.push_back( index );
+}
+
+#endif
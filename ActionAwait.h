@@ -0,0 +1,141 @@
+#pragma once
+
+// Coroutine awaitables for actions. Requires C++20, enable with the INPUT_ENABLE_COROUTINES CMake option.
+#if defined( __cpp_impl_coroutine ) && __has_include( <coroutine> )
+#define INPUT_COROUTINES_ENABLED
+
+#include <coroutine>
+#include <array>
+#include INPUT_ALLOCATION_HEADER
+#include "InputLibraryDefine.h"
+#include "ActionNotifier.h"
+#include "Types.h"
+
+class ActionScheduler;
+
+// Fire and forget coroutine started by calling it. The frame is allocated from a per thread pool
+// and freed when the coroutine finishes or when the scheduler it is suspended on is destroyed.
+class InputTask {
+public:
+	struct promise_type {
+		InputTask			get_return_object() { return InputTask(); }
+		std::suspend_never	initial_suspend() noexcept { return { }; }
+		std::suspend_never	final_suspend() noexcept { return { }; }
+		void				return_void() { }
+		void				unhandled_exception() { std::terminate(); }
+
+		INPUT_API static void* operator new ( size_t size );
+		INPUT_API static void  operator delete ( void* memory, size_t size );
+	};
+};
+
+#define INPUT_AWAIT_MAX_ACTIONS 8
+
+// Up to INPUT_AWAIT_MAX_ACTIONS actions, built from a braced list such as { jump, fire }. Unlike
+// std::initializer_list it has no backing array temporary, which GCC 12 rejects inside co_await expressions.
+class ActionList {
+public:
+	template<typename... Actions>
+	ActionList( Actions... actions )
+		: m_Actions { { actions... } }, m_NrOfActions( static_cast<int>( sizeof...( Actions ) ) ) {
+		static_assert( sizeof...( Actions ) <= INPUT_AWAIT_MAX_ACTIONS, "Too many actions to await" );
+	}
+
+	const ActionIdentifier* begin() const { return m_Actions.data(); }
+	const ActionIdentifier* end() const { return m_Actions.data() + m_NrOfActions; }
+	int						size() const { return m_NrOfActions; }
+	ActionIdentifier		operator [] ( int index ) const { return m_Actions[index]; }
+
+private:
+	std::array<ActionIdentifier, INPUT_AWAIT_MAX_ACTIONS> m_Actions;
+	int													  m_NrOfActions;
+};
+
+// Suspends until one of actions starts in bindContextHandle or until timeoutTicks have passed.
+// Resumes with the started action, or an invalid ActionIdentifier on timeout.
+class ActionAwaiter {
+public:
+	ActionAwaiter( ActionScheduler& scheduler, BindContextHandle bindContextHandle, const ActionList& actions, INPUT_TYPE inputType, Uint32 timeoutTicks )
+		: m_Scheduler( scheduler ), m_BindContext( bindContextHandle ), m_InputType( inputType ), m_TimeoutTicks( timeoutTicks ), m_Actions( actions ) {
+	}
+
+	bool			 await_ready() const noexcept { return m_Actions.size() == 0; }
+	INPUT_API void	 await_suspend ( std::coroutine_handle<> handle );
+	ActionIdentifier await_resume() const noexcept { return m_Result; }
+
+private:
+	friend class ActionScheduler;
+	ActionScheduler&  m_Scheduler;
+	BindContextHandle m_BindContext;
+	INPUT_TYPE		  m_InputType;
+	Uint32			  m_TimeoutTicks;
+	ActionList		  m_Actions;
+	ActionIdentifier  m_Result;
+};
+
+// Resumes suspended ActionAwaiters when their actions start. Waiters are never resumed while events are being
+// handled, since they could change bindings or consume input while the edge stacks are still being filled.
+// They are resumed, and timeouts checked, by Update, which InputContext::Update calls. Call Update once more
+// after the frame's events were handled to resume them in the same frame polling code sees the action.
+// Waiters that are not resumed cost nothing.
+class ActionScheduler {
+public:
+	INPUT_API ActionScheduler( const KeyBindings& keyBindings, InputContext& input );
+	INPUT_API ~ActionScheduler();
+
+	ActionScheduler( const ActionScheduler& rhs ) = delete;
+	ActionScheduler& operator = ( const ActionScheduler& rhs ) = delete;
+
+	ActionAwaiter WaitForAction( BindContextHandle bindContextHandle, ActionIdentifier action, INPUT_TYPE inputType = INPUT_TYPE_ANY ) {
+		return ActionAwaiter( *this, bindContextHandle, ActionList( action ), inputType, 0 );
+	}
+
+	// co_await WaitForAny( context, { jump, fire }, 500 ). timeoutTicks of 0 waits indefinitely.
+	ActionAwaiter WaitForAny( BindContextHandle bindContextHandle, const ActionList& actions, Uint32 timeoutTicks = 0,
+							  INPUT_TYPE inputType = INPUT_TYPE_ANY ) {
+		return ActionAwaiter( *this, bindContextHandle, actions, inputType, timeoutTicks );
+	}
+
+	// Resumes the waiters whose actions started or that timed out since the last call.
+	INPUT_API void Update ();
+	INPUT_API int  GetNrOfWaiters () const;
+
+private:
+	friend class ActionAwaiter;
+
+	struct Waiter {
+		std::coroutine_handle<>	 Handle;
+		ActionAwaiter*			 Awaiter	= nullptr;
+		Uint32					 Generation = 0;
+		bool					 Active		= false;
+	};
+
+	struct Timeout {
+		Uint32 Deadline;
+		int	   Waiter;
+		Uint32 Generation;
+	};
+
+	struct Start {
+		int				 Waiter;
+		Uint32			 Generation;
+		ActionIdentifier Action;
+	};
+
+	void Suspend ( ActionAwaiter& awaiter, std::coroutine_handle<> handle );
+	void Complete ( int waiter, ActionIdentifier result );
+	void ResumeStarted ();
+
+	ActionNotifier			  m_Notifier;
+	InputContext&			  m_Input;
+	InputUpdateCallbackHandle m_UpdateCallbackHandle;
+
+	pVector<Waiter>								 m_Waiters;
+	pVector<int>								 m_FreeWaiters;
+	pVector<ActionSubscriptionHandle>			 m_Subscriptions;		// [waiter * INPUT_AWAIT_MAX_ACTIONS + action]
+	pVector<Timeout>							 m_Timeouts;			// Min heap on deadline
+	pVector<Start>								 m_Started;
+	pVector<std::coroutine_handle<>>			 m_Ready;
+};
+
+#endif
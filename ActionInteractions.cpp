@@ -0,0 +1,219 @@
+#include "ActionInteractions.h"
+#include <algorithm>
+#include "InputContext.h"
+#include "KeyBindings.h"
+
+#define INTERACTION_NR_OF_DEVICES ( INPUT_MAX_NR_OF_GAMEPADS + 1 )
+
+ActionInteractions::ActionInteractions( INPUT_TYPE inputType )
+	: m_InputType( inputType ) {
+	m_NewestSequences.resize( INTERACTION_NR_OF_DEVICES, 0 );
+	m_HasNewest.resize( INTERACTION_NR_OF_DEVICES, 0 );
+}
+
+ActionInteractionHandle ActionInteractions::Add( ActionIdentifier action, const ActionInteractionDefinition& definition ) {
+	int actionIndex = static_cast<int>( action );
+	if ( actionIndex < 0 ) {
+		return ActionInteractionHandle();
+	}
+	if ( actionIndex >= static_cast<int>( m_FirstInteractions.size() ) ) {
+		m_FirstInteractions.resize( actionIndex + 1, -1 );
+		m_HeldInputs.resize( actionIndex + 1, 0 );
+	}
+	m_NextInteractions.push_back( m_FirstInteractions[actionIndex] );
+	m_FirstInteractions[actionIndex] = static_cast<int>( m_Actions.size() );
+
+	m_Actions.push_back( action );
+	m_Types.push_back( definition.Type );
+	m_Durations.push_back( definition.Duration );
+	m_Windows.push_back( definition.Window );
+	m_Counts.push_back( definition.Count );
+	m_Flags.push_back( 0 );
+	m_PressTicks.push_back( 0 );
+	m_LastTapTicks.push_back( 0 );
+	m_TapCounts.push_back( 0 );
+	return static_cast<ActionInteractionHandle>( static_cast<int>( m_Actions.size() - 1 ) );
+}
+
+void ActionInteractions::Clear() {
+	m_Actions.clear();
+	m_Types.clear();
+	m_Durations.clear();
+	m_Windows.clear();
+	m_Counts.clear();
+	m_Flags.clear();
+	m_PressTicks.clear();
+	m_LastTapTicks.clear();
+	m_TapCounts.clear();
+	m_NextInteractions.clear();
+	m_HeldInputs.clear();
+	m_FirstInteractions.clear();
+}
+
+void ActionInteractions::Reset() {
+	std::fill( m_Flags.begin(), m_Flags.end(), 0 );
+	std::fill( m_TapCounts.begin(), m_TapCounts.end(), 0 );
+	std::fill( m_HeldInputs.begin(), m_HeldInputs.end(), 0 );
+}
+
+void ActionInteractions::Evaluate( const KeyBindings& keyBindings, BindContextHandle bindContextHandle, const InputContext& input, Uint32 ticks ) {
+	for ( Uint8& flags : m_Flags ) {
+		flags &= ~( INTERACTION_FLAG_TRIGGERED | INTERACTION_FLAG_ACTIVE );
+	}
+
+	m_Edges.clear();
+	if ( m_InputType == INPUT_TYPE_ANY ) {
+		GatherEdges( keyBindings, bindContextHandle, input, INPUT_TYPE_KEYBOARD, ticks );
+		for ( int i = 0; i < INPUT_MAX_NR_OF_GAMEPADS; ++i ) {
+			GatherEdges( keyBindings, bindContextHandle, input, static_cast<INPUT_TYPE>( i ), ticks );
+		}
+	} else {
+		GatherEdges( keyBindings, bindContextHandle, input, m_InputType, ticks );
+	}
+	std::stable_sort( m_Edges.begin(), m_Edges.end(), []( const ActionEdge& lhs, const ActionEdge& rhs ) {
+		return static_cast<Sint32>( lhs.Ticks - rhs.Ticks ) < 0;
+	} );
+
+	// An action is pressed when its first bound input goes down and released when its last one goes up
+	for ( const ActionEdge& edge : m_Edges ) {
+		Uint8& held = m_HeldInputs[static_cast<int>( edge.Action )];
+		if ( edge.Press ) {
+			if ( ++held == 1 ) {
+				Press( edge.Action, edge.Ticks );
+			}
+		} else if ( held > 0 && --held == 0 ) {	// Releases of inputs pressed before the first evaluation are ignored
+			Release( edge.Action, edge.Ticks );
+		}
+	}
+
+	// Timers that expire without an edge
+	for ( size_t i = 0; i < m_Actions.size(); ++i ) {
+		if ( m_Flags[i] & INTERACTION_FLAG_DOWN ) {
+			if ( static_cast<Sint32>( ticks - m_PressTicks[i] ) < static_cast<Sint32>( m_Durations[i] ) ) {
+				continue;
+			}
+			if ( m_Types[i] == ActionInteraction::Hold ) {
+				m_Flags[i] |= INTERACTION_FLAG_TRIGGERED | INTERACTION_FLAG_ACTIVE;
+			} else if ( m_Types[i] == ActionInteraction::LongPress && !( m_Flags[i] & INTERACTION_FLAG_FIRED ) ) {
+				m_Flags[i] |= INTERACTION_FLAG_TRIGGERED | INTERACTION_FLAG_FIRED;
+			}
+		} else if ( m_TapCounts[i] > 0 && ticks - m_LastTapTicks[i] > m_Windows[i] ) {
+			m_TapCounts[i] = 0;
+		}
+	}
+}
+
+bool ActionInteractions::IsTriggered( ActionInteractionHandle handle ) const {
+	int index = static_cast<int>( handle );
+	return index >= 0 && index < static_cast<int>( m_Flags.size() ) && ( m_Flags[index] & INTERACTION_FLAG_TRIGGERED ) != 0;
+}
+
+bool ActionInteractions::IsActive( ActionInteractionHandle handle ) const {
+	int index = static_cast<int>( handle );
+	return index >= 0 && index < static_cast<int>( m_Flags.size() ) && ( m_Flags[index] & INTERACTION_FLAG_ACTIVE ) != 0;
+}
+
+float ActionInteractions::GetProgress( ActionInteractionHandle handle, Uint32 ticks ) const {
+	int index = static_cast<int>( handle );
+	if ( index < 0 || index >= static_cast<int>( m_Flags.size() ) || !( m_Flags[index] & INTERACTION_FLAG_DOWN ) ) {
+		return 0.0f;
+	}
+	if ( m_Durations[index] == 0 ) {
+		return 1.0f;
+	}
+	Sint32 held = static_cast<Sint32>( ticks - m_PressTicks[index] );
+	return held <= 0 ? 0.0f : std::min( 1.0f, static_cast<float>( held ) / m_Durations[index] );
+}
+
+void ActionInteractions::GatherEdges( const KeyBindings& keyBindings, BindContextHandle bindContextHandle, const InputContext& input, INPUT_TYPE inputType, Uint32 ticks ) {
+	int device = static_cast<int>( inputType ) + 1;
+	if ( device < 0 || device >= INTERACTION_NR_OF_DEVICES ) {
+		return;
+	}
+	bool   hasNewest = m_HasNewest[device] != 0;
+	Uint32 newest	 = m_NewestSequences[device];
+	auto add = [this]( ActionIdentifier action, Uint32 edgeTicks, Uint32 sequence, bool press ) {
+		int index = static_cast<int>( action );
+		if ( index >= 0 && index < static_cast<int>( m_FirstInteractions.size() ) && m_FirstInteractions[index] != -1 ) {
+			m_Edges.push_back( ActionEdge { edgeTicks, sequence, action, press } );
+		}
+	};
+	// Returns false for edges already evaluated or consumed, remembering the newest edge of the device
+	auto isNew = [this, device, hasNewest, newest]( Uint32 sequence, bool consumed ) {
+		if ( hasNewest && static_cast<Sint32>( sequence - newest ) <= 0 ) {
+			return false;
+		}
+		if ( !m_HasNewest[device] || static_cast<Sint32>( sequence - m_NewestSequences[device] ) > 0 ) {
+			m_NewestSequences[device] = sequence;
+			m_HasNewest[device]		  = 1;
+		}
+		return !consumed;
+	};
+	size_t first = m_Edges.size();
+	for ( bool press : { true, false } ) {
+		if ( inputType == INPUT_TYPE_KEYBOARD ) {
+			const InputEdgeStack<SDL_Scancode>& stack = input.GetKeyboardEdgeStack( press );
+			for ( int i = 0; i < static_cast<int>( stack.Size() ); ++i ) {
+				if ( isNew( stack.GetSequence( i ), stack.IsConsumed( i ) ) ) {
+					add( keyBindings.GetActiveActionFromScancode( bindContextHandle, stack.GetCodes()[i] ), stack.GetTime( i ).GetTicks(), stack.GetSequence( i ), press );
+				}
+			}
+			const InputEdgeStack<MOUSE_BUTTON>& mouseStack = input.GetMouseEdgeStack( press );
+			for ( int i = 0; i < static_cast<int>( mouseStack.Size() ); ++i ) {
+				if ( isNew( mouseStack.GetSequence( i ), mouseStack.IsConsumed( i ) ) ) {
+					add( keyBindings.GetActiveActionFromMouseBinding( bindContextHandle, InputBinding::Mouse( mouseStack.GetCodes()[i] ) ),
+						 mouseStack.GetTime( i ).GetTicks(), mouseStack.GetSequence( i ), press );
+				}
+			}
+		} else {
+			const InputEdgeStack<Uint8>& stack = input.GetGamepadContext( static_cast<unsigned int>( inputType ) ).GetEdgeStack( press );
+			for ( int i = 0; i < static_cast<int>( stack.Size() ); ++i ) {
+				if ( isNew( stack.GetSequence( i ), stack.IsConsumed( i ) ) ) {
+					add( keyBindings.GetActiveActionFromButton( bindContextHandle, static_cast<SDL_GameControllerButton>( stack.GetCodes()[i] ), inputType ),
+						 stack.GetTime( i ).GetTicks(), stack.GetSequence( i ), press );
+				}
+			}
+		}
+	}
+	// Edges of the same millisecond keep the order they happened in
+	std::stable_sort( m_Edges.begin() + first, m_Edges.end(), []( const ActionEdge& lhs, const ActionEdge& rhs ) {
+		return static_cast<Sint32>( lhs.Sequence - rhs.Sequence ) < 0;
+	} );
+
+	// Wheel bindings are pressed and released within a frame that scrolled, so they are stamped with the evaluation
+	if ( inputType == INPUT_TYPE_KEYBOARD ) {
+		for ( int wheel = MOUSE_WHEEL_UP; wheel <= MOUSE_WHEEL_RIGHT; ++wheel ) {
+			if ( input.MouseWheelScrolled( static_cast<MOUSE_WHEEL>( wheel ) ) ) {
+				ActionIdentifier action = keyBindings.GetActiveActionFromMouseBinding( bindContextHandle, InputBinding::Wheel( static_cast<MOUSE_WHEEL>( wheel ) ) );
+				add( action, ticks, 0, true );
+				add( action, ticks, 0, false );
+			}
+		}
+	}
+}
+
+void ActionInteractions::Press( ActionIdentifier action, Uint32 ticks ) {
+	for ( int i = m_FirstInteractions[static_cast<int>( action )]; i != -1; i = m_NextInteractions[i] ) {
+		m_Flags[i]		= ( m_Flags[i] | INTERACTION_FLAG_DOWN ) & ~INTERACTION_FLAG_FIRED;
+		m_PressTicks[i] = ticks;
+		if ( m_Types[i] == ActionInteraction::MultiTap ) {
+			m_TapCounts[i]	  = m_TapCounts[i] > 0 && ticks - m_LastTapTicks[i] <= m_Windows[i] ? m_TapCounts[i] + 1 : 1;
+			m_LastTapTicks[i] = ticks;
+			if ( m_TapCounts[i] >= m_Counts[i] ) {
+				m_Flags[i] |= INTERACTION_FLAG_TRIGGERED;
+				m_TapCounts[i] = 0;
+			}
+		}
+	}
+}
+
+void ActionInteractions::Release( ActionIdentifier action, Uint32 ticks ) {
+	for ( int i = m_FirstInteractions[static_cast<int>( action )]; i != -1; i = m_NextInteractions[i] ) {
+		m_Flags[i] &= ~( INTERACTION_FLAG_DOWN | INTERACTION_FLAG_ACTIVE );
+		Uint32 held = ticks - m_PressTicks[i];
+		if ( ( m_Types[i] == ActionInteraction::Tap && held < m_Durations[i] ) ||
+			 ( m_Types[i] == ActionInteraction::ReleaseAfterHold && held >= m_Durations[i] ) ) {
+			m_Flags[i] |= INTERACTION_FLAG_TRIGGERED;
+		}
+	}
+}
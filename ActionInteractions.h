@@ -0,0 +1,95 @@
+#pragma once
+
+#include INPUT_ALLOCATION_HEADER
+#include "InputLibraryDefine.h"
+#include "Types.h"
+
+class InputContext;
+class KeyBindings;
+
+enum class ActionInteraction : Uint8 {
+	Tap,				// Released within Duration of the press
+	Hold,				// Triggered every evaluation while held for at least Duration
+	LongPress,			// Triggered once when held for Duration
+	ReleaseAfterHold,	// Released after being held for at least Duration
+	MultiTap			// Count presses, each within Window of the previous one
+};
+
+struct ActionInteractionDefinition {
+	ActionInteraction Type;
+	Uint32			  Duration = 0;	// Milliseconds
+	Uint32			  Window   = 0;	// Milliseconds between presses for MultiTap
+	Uint8			  Count	   = 2;	// Presses for MultiTap
+};
+
+struct ActionInteractionHandle_tag { };
+typedef Handle<ActionInteractionHandle_tag, int, -1> ActionInteractionHandle;
+
+// Tap, hold and multi tap detection for the actions of one bind context. The state machines are driven by
+// the time stamps of this frame's unconsumed key, mouse and gamepad button edges whose bindings the bind context
+// stack leaves active, and advanced together by
+// KeyBindings::EvaluateInteractions once per frame after the frame's events are handled. Timers and states are kept
+// as one array per field, indexed by interaction, so the per frame pass runs over contiguous memory.
+class ActionInteractions {
+public:
+	// Edges of inputType are used. INPUT_TYPE_ANY treats the keyboard and every gamepad as one device.
+	INPUT_API explicit ActionInteractions( INPUT_TYPE inputType = INPUT_TYPE_ANY );
+
+	INPUT_API ActionInteractionHandle Add ( ActionIdentifier action, const ActionInteractionDefinition& definition );
+	INPUT_API void					  Clear ();
+	// Forgets held inputs and partial taps, e.g. when the context becomes active again.
+	INPUT_API void					  Reset ();
+
+	INPUT_API void Evaluate ( const KeyBindings& keyBindings, BindContextHandle bindContextHandle, const InputContext& input, Uint32 ticks );
+
+	// True if the interaction triggered during the last Evaluate.
+	INPUT_API bool	IsTriggered ( ActionInteractionHandle handle ) const;
+	// True while a Hold is being held past its duration.
+	INPUT_API bool	IsActive ( ActionInteractionHandle handle ) const;
+	// How far the current press is towards Duration, from 0 to 1. 0 while released.
+	INPUT_API float GetProgress ( ActionInteractionHandle handle, Uint32 ticks ) const;
+
+private:
+	enum INTERACTION_FLAG : Uint8 {
+		INTERACTION_FLAG_DOWN	   = 0x01,
+		INTERACTION_FLAG_TRIGGERED = 0x02,
+		INTERACTION_FLAG_ACTIVE	   = 0x04,
+		INTERACTION_FLAG_FIRED	   = 0x08,	// LongPress already triggered for this press
+	};
+
+	struct ActionEdge {
+		Uint32			 Ticks;
+		Uint32			 Sequence;
+		ActionIdentifier Action;
+		bool			 Press;
+	};
+
+	void GatherEdges ( const KeyBindings& keyBindings, BindContextHandle bindContextHandle, const InputContext& input, INPUT_TYPE inputType, Uint32 ticks );
+	void Press ( ActionIdentifier action, Uint32 ticks );
+	void Release ( ActionIdentifier action, Uint32 ticks );
+
+	INPUT_TYPE m_InputType;
+
+	// Per interaction
+	pVector<ActionIdentifier>  m_Actions;
+	pVector<ActionInteraction> m_Types;
+	pVector<Uint32>			   m_Durations;
+	pVector<Uint32>			   m_Windows;
+	pVector<Uint8>			   m_Counts;
+	pVector<Uint8>			   m_Flags;
+	pVector<Uint32>			   m_PressTicks;
+	pVector<Uint32>			   m_LastTapTicks;
+	pVector<Uint8>			   m_TapCounts;
+	pVector<int>			   m_NextInteractions;	// Next interaction of the same action or -1
+
+	// Per action
+	pVector<Uint8> m_HeldInputs;	// Inputs bound to the action that are down
+	pVector<int>   m_FirstInteractions;	// -1 for actions without interactions
+
+	// Per device, the keyboard first. Edges a tick window retains are seen again, so only those with a newer
+	// sequence number are taken. Ticks would drop edges that share a millisecond with the newest one.
+	pVector<Uint32> m_NewestSequences;
+	pVector<Uint8>	m_HasNewest;
+
+	pVector<ActionEdge> m_Edges;	// This frame's edges in time order
+};
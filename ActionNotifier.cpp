@@ -0,0 +1,203 @@
+#include "ActionNotifier.h"
+#include <algorithm>
+#include "KeyBindings.h"
+#include "BindContext.h"
+#include "InputState.h"
+#include "GamepadState.h"
+#include "LogInput.h"
+
+ActionNotifier::ActionNotifier( const KeyBindings& keyBindings, InputContext& input )
+	: m_KeyBindings( keyBindings ), m_Input( input ), m_HeldRevision( keyBindings.GetBindingIndex().GetRevision() ) {
+	m_EdgeCallbackHandle = m_Input.RegisterEdgeInterest( std::bind( &ActionNotifier::OnEdge, this, std::placeholders::_1,
+		std::placeholders::_2, std::placeholders::_3 ) );
+}
+
+ActionNotifier::~ActionNotifier() {
+	m_Input.UnregisterEdgeInterest( m_EdgeCallbackHandle );
+}
+
+ActionSubscriptionHandle ActionNotifier::Subscribe( BindContextHandle bindContextHandle, ActionIdentifier action, INPUT_TYPE inputType,
+													ActionChangeCallbackFunction callbackFunction ) {
+	int handle = m_NextHandle++;
+	m_Subscriptions[handle] = Subscription { bindContextHandle, action, inputType, callbackFunction };
+	m_SubscriptionsByAction[GetActionKey( bindContextHandle, action )].push_back( handle );
+	AddWatch( bindContextHandle, 1 );
+	return static_cast<ActionSubscriptionHandle>( handle );
+}
+
+void ActionNotifier::Unsubscribe( ActionSubscriptionHandle handle ) {
+	auto it = m_Subscriptions.find( static_cast<int>( handle ) );
+	if ( it == m_Subscriptions.end() ) {
+		INPUT_LOG( LogSeverity::WARNING_MSG, "ActionNotifier", "Tried to unsubscribe invalid action subscription handle: " + rToString( static_cast<int>( handle ) ) );
+		return;
+	}
+	Uint64		  key		  = GetActionKey( it->second.BindContext, it->second.Action );
+	pVector<int>& subscribers = m_SubscriptionsByAction[key];
+	subscribers.erase( std::remove( subscribers.begin(), subscribers.end(), it->first ), subscribers.end() );
+	if ( subscribers.empty() ) {
+		m_SubscriptionsByAction.erase( key );
+	}
+	AddWatch( it->second.BindContext, -1 );
+	m_Subscriptions.erase( it );
+}
+
+void ActionNotifier::Watch( BindContextHandle bindContextHandle ) {
+	AddWatch( bindContextHandle, 1 );
+}
+
+void ActionNotifier::Unwatch( BindContextHandle bindContextHandle ) {
+	AddWatch( bindContextHandle, -1 );
+}
+
+void ActionNotifier::Dispatch() {
+	UpdateHeldInputs();
+	m_Changes.swap( m_Pending );
+	m_Pending.clear();
+	for ( const ActionChange& change : m_Changes ) {
+		auto subscribers = m_SubscriptionsByAction.find( GetActionKey( change.BindContext, change.Action ) );
+		if ( subscribers == m_SubscriptionsByAction.end() ) {
+			continue;
+		}
+		// Copied since callbacks may subscribe or unsubscribe
+		pVector<int> handles = subscribers->second;
+		for ( int handle : handles ) {
+			auto subscription = m_Subscriptions.find( handle );
+			if ( subscription != m_Subscriptions.end() &&
+				 ( subscription->second.InputType == INPUT_TYPE_ANY || subscription->second.InputType == change.InputType ) ) {
+				subscription->second.Function( change );
+			}
+		}
+	}
+}
+
+const pVector<ActionChange>& ActionNotifier::GetChanges() const {
+	return m_Changes;
+}
+
+bool ActionNotifier::IsActive( BindContextHandle bindContextHandle, ActionIdentifier action, INPUT_TYPE inputType ) const {
+	return m_HeldInputs.find( GetActiveKey( bindContextHandle, action, inputType ) ) != m_HeldInputs.end();
+}
+
+void ActionNotifier::OnEdge( INPUT_TYPE inputType, int code, INPUT_EDGE edge ) {
+	UpdateHeldInputs();
+	if ( edge == INPUT_EDGE_DEVICE_REMOVED ) {
+		for ( auto it = m_HeldInputs.begin(); it != m_HeldInputs.end(); ) {
+			if ( static_cast<int>( it->first & 0xFF ) - 3 == inputType ) {
+				BindContextHandle context = static_cast<BindContextHandle>( static_cast<int>( it->first >> 40 ) );
+				ActionIdentifier  action  = static_cast<ActionIdentifier>( static_cast<int>( ( it->first >> 8 ) & 0xFFFFFFFF ) );
+				m_Pending.push_back( ActionChange { context, action, inputType, ACTION_PHASE_CANCELED } );
+				it = m_HeldInputs.erase( it );
+			} else {
+				++it;
+			}
+		}
+		return;
+	}
+
+	for ( BindContextHandle context : m_WatchedContexts ) {
+		ActionIdentifier action = GetBoundAction( context, inputType, code );
+		if ( static_cast<int>( action ) < 0 ) {
+			continue;
+		}
+		Uint64 key = GetActiveKey( context, action, inputType );
+		if ( edge == INPUT_EDGE_PRESS ) {
+			if ( ++m_HeldInputs[key] == 1 ) {
+				m_Pending.push_back( ActionChange { context, action, inputType, ACTION_PHASE_STARTED } );
+			}
+		} else {
+			auto held = m_HeldInputs.find( key );
+			// Releases of inputs pressed before the context was watched are ignored
+			if ( held != m_HeldInputs.end() && --held->second == 0 ) {
+				m_HeldInputs.erase( held );
+				m_Pending.push_back( ActionChange { context, action, inputType, ACTION_PHASE_COMPLETED } );
+			}
+		}
+	}
+}
+
+ActionIdentifier ActionNotifier::GetBoundAction( BindContextHandle bindContextHandle, INPUT_TYPE inputType, int code ) const {
+	const BindContext* context = m_KeyBindings.GetBindContext( bindContextHandle );
+	if ( context == nullptr ) {
+		return ActionIdentifier();
+	}
+	if ( inputType == INPUT_TYPE_KEYBOARD && code >= INPUT_EDGE_MOUSE_CODE ) {
+		return context->GetKeyBindCollection().GetActionFromMouseBinding( InputBinding::FromMouseIndex( code - INPUT_EDGE_MOUSE_CODE ) );
+	}
+	if ( inputType == INPUT_TYPE_KEYBOARD ) {
+		return context->GetKeyBindCollection().GetGetActionFromScancode( static_cast<SDL_Scancode>( code ) );
+	}
+	return context->GetActionFromButton( static_cast<SDL_GameControllerButton>( code ), inputType );
+}
+
+void ActionNotifier::UpdateHeldInputs() {
+	Uint32 revision = m_KeyBindings.GetBindingIndex().GetRevision();
+	if ( revision == m_HeldRevision ) {
+		return;
+	}
+	m_HeldRevision = revision;
+	// Counts of inputs that were bound when they were pressed no longer pair up with their releases
+	for ( auto it = m_HeldInputs.begin(); it != m_HeldInputs.end(); ) {
+		BindContextHandle context	= static_cast<BindContextHandle>( static_cast<int>( it->first >> 40 ) );
+		ActionIdentifier  action	= static_cast<ActionIdentifier>( static_cast<int>( ( it->first >> 8 ) & 0xFFFFFFFF ) );
+		INPUT_TYPE		  inputType = static_cast<INPUT_TYPE>( static_cast<int>( it->first & 0xFF ) - 3 );
+		int				  held		= CountHeldInputs( context, action, inputType );
+		if ( held == 0 ) {
+			m_Pending.push_back( ActionChange { context, action, inputType, ACTION_PHASE_COMPLETED } );
+			it = m_HeldInputs.erase( it );
+		} else {
+			it->second = held;
+			++it;
+		}
+	}
+}
+
+int ActionNotifier::CountHeldInputs( BindContextHandle bindContextHandle, ActionIdentifier action, INPUT_TYPE inputType ) const {
+	const BindContext* context = static_cast<int>( bindContextHandle ) < m_KeyBindings.GetNrOfBindContexts() ? m_KeyBindings.GetBindContext( bindContextHandle ) : nullptr;
+	if ( context == nullptr ) {
+		return 0;
+	}
+	const InputState& state = m_Input.GetInputState();
+	if ( inputType == INPUT_TYPE_KEYBOARD ) {
+		const KeyBindingCollection& keys	  = context->GetKeyBindCollection();
+		InputBinding				mouse	  = keys.GetMouseBindingFromAction( action );
+		int							held	  = 0;
+		const rVector<SDL_Scancode>* slots[] = { &keys.GetPrimaryBindings(), &keys.GetSecondaryBindings() };
+		for ( const rVector<SDL_Scancode>* slot : slots ) {
+			if ( static_cast<int>( action ) < static_cast<int>( slot->size() ) && ( *slot )[static_cast<int>( action )] != SDL_SCANCODE_UNKNOWN &&
+				 state.IsKeyDown( ( *slot )[static_cast<int>( action )] ) ) {
+				++held;
+			}
+		}
+		if ( mouse.GetDevice() == InputDevice::MouseButton && state.IsMouseButtonDown( mouse.GetMouseButton() ) ) {
+			++held;
+		}
+		return held;
+	}
+	const GamepadState*		 gamepad = state.GetGamepadState( static_cast<unsigned int>( inputType ) );
+	SDL_GameControllerButton button	 = context->GetButtonFromAction( action, inputType );
+	return gamepad && button != SDL_CONTROLLER_BUTTON_INVALID && gamepad->ButtonDown( button ) ? 1 : 0;
+}
+
+void ActionNotifier::AddWatch( BindContextHandle bindContextHandle, int count ) {
+	int index = static_cast<int>( bindContextHandle );
+	if ( index >= static_cast<int>( m_WatchCounts.size() ) ) {
+		m_WatchCounts.resize( index + 1, 0 );
+	}
+	int previous = m_WatchCounts[index];
+	m_WatchCounts[index] = std::max( 0, previous + count );
+	if ( previous == 0 && m_WatchCounts[index] > 0 ) {
+		m_WatchedContexts.push_back( bindContextHandle );
+	} else if ( previous > 0 && m_WatchCounts[index] == 0 ) {
+		m_WatchedContexts.erase( std::remove( m_WatchedContexts.begin(), m_WatchedContexts.end(), bindContextHandle ), m_WatchedContexts.end() );
+	}
+}
+
+Uint64 ActionNotifier::GetActionKey( BindContextHandle bindContextHandle, ActionIdentifier action ) {
+	return ( static_cast<Uint64>( static_cast<int>( bindContextHandle ) ) << 32 ) | static_cast<Uint32>( static_cast<int>( action ) );
+}
+
+Uint64 ActionNotifier::GetActiveKey( BindContextHandle bindContextHandle, ActionIdentifier action, INPUT_TYPE inputType ) {
+	// Context in the top 24 bits, action in the middle 32 and input type in the low 8
+	return ( static_cast<Uint64>( static_cast<int>( bindContextHandle ) ) << 40 ) | ( static_cast<Uint64>( static_cast<Uint32>( static_cast<int>( action ) ) ) << 8 ) |
+		   static_cast<Uint64>( inputType + 3 );
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <functional>
+#include <utility/Handle.h>
+#include INPUT_ALLOCATION_HEADER
+#include "InputLibraryDefine.h"
+#include "InputContext.h"
+#include "Types.h"
+
+class KeyBindings;
+
+enum ACTION_PHASE {
+	ACTION_PHASE_STARTED,		// First bound input of the action was pressed
+	ACTION_PHASE_COMPLETED,		// Last held input of the action was released
+	ACTION_PHASE_CANCELED,		// The device was removed while the action was held
+};
+
+struct ActionChange {
+	BindContextHandle BindContext;
+	ActionIdentifier  Action;
+	INPUT_TYPE		  InputType;
+	ACTION_PHASE	  Phase;
+};
+
+struct ActionSubscriptionHandle_tag { };
+typedef Handle<ActionSubscriptionHandle_tag, int, -1> ActionSubscriptionHandle;
+typedef std::function<void ( const ActionChange& change )> ActionChangeCallbackFunction;
+
+// Push based alternative to polling KeyBindings::ActionDown/ActionUpDown. Key, mouse button and gamepad edges
+// from the InputContext are resolved to actions in the watched bind contexts as they arrive, so the work per
+// frame depends on how much input there was rather than on how many systems are interested. When bindings
+// change, held actions are recounted from the inputs now bound to them and complete if none is held.
+class ActionNotifier {
+public:
+	INPUT_API ActionNotifier( const KeyBindings& keyBindings, InputContext& input );
+	INPUT_API ~ActionNotifier();
+
+	ActionNotifier( const ActionNotifier& rhs ) = delete;
+	ActionNotifier& operator = ( const ActionNotifier& rhs ) = delete;
+
+	// inputType may be INPUT_TYPE_ANY to be notified for the keyboard and all gamepads.
+	INPUT_API ActionSubscriptionHandle Subscribe ( BindContextHandle bindContextHandle, ActionIdentifier action, INPUT_TYPE inputType,
+												   ActionChangeCallbackFunction callbackFunction );
+	INPUT_API void					   Unsubscribe ( ActionSubscriptionHandle handle );
+	// Tracks every action of the bind context for GetChanges without subscribing to single actions.
+	INPUT_API void					   Watch ( BindContextHandle bindContextHandle );
+	INPUT_API void					   Unwatch ( BindContextHandle bindContextHandle );
+
+	// Invokes subscribers for the changes since the last call. Call once per frame after events have been handled.
+	INPUT_API void						 Dispatch ();
+	// Changes delivered by the last Dispatch, in the order they happened.
+	INPUT_API const pVector<ActionChange>& GetChanges () const;
+	INPUT_API bool						 IsActive ( BindContextHandle bindContextHandle, ActionIdentifier action, INPUT_TYPE inputType ) const;
+
+private:
+	struct Subscription {
+		BindContextHandle			 BindContext;
+		ActionIdentifier			 Action;
+		INPUT_TYPE					 InputType;
+		ActionChangeCallbackFunction Function;
+	};
+
+	void			 OnEdge ( INPUT_TYPE inputType, int code, INPUT_EDGE edge );
+	ActionIdentifier GetBoundAction ( BindContextHandle bindContextHandle, INPUT_TYPE inputType, int code ) const;
+	void			 AddWatch ( BindContextHandle bindContextHandle, int count );
+	// Recounts the held actions if any binding changed since the counts were taken.
+	void			 UpdateHeldInputs ();
+	int				 CountHeldInputs ( BindContextHandle bindContextHandle, ActionIdentifier action, INPUT_TYPE inputType ) const;
+
+	static Uint64 GetActionKey ( BindContextHandle bindContextHandle, ActionIdentifier action );
+	static Uint64 GetActiveKey ( BindContextHandle bindContextHandle, ActionIdentifier action, INPUT_TYPE inputType );
+
+	const KeyBindings&		m_KeyBindings;
+	InputContext&			m_Input;
+	InputEdgeCallbackHandle m_EdgeCallbackHandle;
+
+	pUnorderedMap<int, Subscription>	  m_Subscriptions;
+	pUnorderedMap<Uint64, pVector<int>> m_SubscriptionsByAction;
+	int									  m_NextHandle = 0;
+
+	pVector<int>				m_WatchCounts;		// Per bind context, subscriptions and watches
+	pVector<BindContextHandle>	m_WatchedContexts;
+	pUnorderedMap<Uint64, int>	m_HeldInputs;		// Number of bound inputs held per context, action and input type
+	Uint32						m_HeldRevision;		// Binding index revision the counts are for
+
+	pVector<ActionChange> m_Pending;
+	pVector<ActionChange> m_Changes;
+};
@@ -1,101 +1,306 @@
 #include "BindContext.h"
-#include <SDL2/SDL_keyboard.h>
+#include <algorithm>
+#include "InputNames.h"
 #include <utility/Config.h>
 #include "LogInput.h"
+#include "StaticActionTable.h"
+#include "KeyBindings.h"
+#include "BindingIndex.h"
 
-BindContext::BindContext( const pString& name )
-	: m_Name( name ) {
+BindContext::BindContext( const pString& name, const KeyBindings* owner )
+	: m_Owner( owner ), m_Name( name ), m_PlayersKey( name + "players" ), m_KeyBindingCollection( owner ), m_GamepadBindingCollection( owner ) {
 }
 
-void BindContext::LoadFromConfig( Config& cfg, const pVector<pString> descriptions ) {
-	for ( auto& title : m_ActionTitleToAction ) {
-		pString keyName = cfg.GetString( m_Name + "primary." + title.first, SDL_GetScancodeName( title.second.DefaultScancode ),
-			descriptions.at( static_cast<int>( title.second.Action ) ) );
-		if ( keyName != "" ) {
-			SDL_Scancode scanCode = SDL_GetScancodeFromName( keyName.c_str() );
-			if ( scanCode == SDL_SCANCODE_UNKNOWN ) {
-				LogInput( "Failed to interpret " + keyName + " as a scancode", "KeyBindings", LogSeverity::WARNING_MSG );
-			} else {
-				m_KeyBindingCollection.AddMappingWithScancode( scanCode, title.second.Action );
+BindContext::~BindContext() {
+	IndexPlayerButtons( false );
+}
+
+const pString& BindContext::GetName() const {
+	return m_Name;
+}
+
+void BindContext::LoadFromConfig( Config& cfg, const KeyBindings& keyBindings ) {
+	DescriptionFunction description = [&keyBindings]( ActionIdentifier action ) { return keyBindings.GetDescription( action ); };
+	pVector<pString>	values;
+	ReadConfigValues( cfg, description, values );
+	LoadFromConfigValues( values.data(), description );
+}
+
+void BindContext::ReadConfigValues( Config& cfg, const DescriptionFunction& description, pVector<pString>& values ) const {
+	for ( auto& action : m_Actions ) {
+		values.push_back( cfg.GetString( m_Strings.Get( action.PrimaryKey ), InputNames::GetScancodeName( action.DefaultScancode ),
+			description( action.Action ) ) );
+	}
+	for ( auto& action : m_Actions ) {
+		values.push_back( cfg.GetString( m_Strings.Get( action.SecondaryKey ), "", description( action.Action ) ) );
+	}
+	for ( auto& action : m_Actions ) {
+		values.push_back( cfg.GetString( m_Strings.Get( action.MouseKey ), "", description( action.Action ) ) );
+	}
+	for ( auto& action : m_Actions ) {
+		values.push_back( cfg.GetString( m_Strings.Get( action.GamepadKey ), InputNames::GetButtonName( action.DefaultButton ),
+			description( action.Action ) ) );
+	}
+	values.push_back( cfg.GetString( m_PlayersKey, "", "Gamepad buttons rebound per player as player:action=button, separated by commas" ) );
+}
+
+void BindContext::LoadFromConfigValues( const pString* values, const DescriptionFunction& description, pVector<pString>* warnings ) {
+	const size_t nrOfActions = m_Actions.size();
+	// Primary keys before secondary ones, so the primary slots are filled first
+	for ( size_t slot = 0; slot < 2; ++slot ) {
+		const pString* keyName = values + slot * nrOfActions;
+		for ( size_t i = 0; i < nrOfActions; ++i ) {
+			if ( keyName[i] != "" ) {
+				SDL_Scancode scanCode = InputNames::GetScancodeFromName( keyName[i].c_str() );
+				if ( scanCode == SDL_SCANCODE_UNKNOWN ) {
+					Warn( warnings, "Failed to interpret " + keyName[i] + " as a scancode" );
+				} else {
+					m_KeyBindingCollection.AddMappingWithScancode( scanCode, m_Actions[i].Action );
+				}
 			}
 		}
 	}
-	for ( auto& title : m_ActionTitleToAction ) {
-		pString keyName = cfg.GetString( m_Name + "secondary." + title.first, "", descriptions.at( static_cast<int>( title.second.Action ) ) );
-		if ( keyName != "" ) {
-			SDL_Scancode scanCode = SDL_GetScancodeFromName( keyName.c_str() );
-			if ( scanCode == SDL_SCANCODE_UNKNOWN ) {
-				LogInput( "Failed to interpret " + keyName + " as a scancode", "KeyBindings", LogSeverity::WARNING_MSG );
+	const pString* mouseNames = values + 2 * nrOfActions;
+	for ( size_t i = 0; i < nrOfActions; ++i ) {
+		const pString& mouseName = mouseNames[i];
+		const ActionTitleMapping& action = m_Actions[i];
+		if ( mouseName != "" ) {
+			InputBinding binding = InputNames::GetMouseBindingFromName( mouseName.c_str() );
+			if ( !binding.IsValid() ) {
+				Warn( warnings, "Failed to interpret " + mouseName + " as a mouse button or wheel direction" );
+			} else if ( m_KeyBindingCollection.GetActionFromMouseBinding( binding ) != ActionIdentifier() ) {
+				Warn( warnings, "Can't bind mouse input: \"" + mouseName + "\" to action " + description( action.Action ) +
+									" because it is already bound to action \"" +
+									description( m_KeyBindingCollection.GetActionFromMouseBinding( binding ) ) + "\"" );
 			} else {
-				m_KeyBindingCollection.AddMappingWithScancode( scanCode, title.second.Action );
+				m_KeyBindingCollection.BindMouse( action.Action, binding, false );
 			}
 		}
 	}
-	for ( auto& title : m_ActionTitleToAction ) {
-		pString buttonName =
-			cfg.GetString( m_Name + "gamepad." + title.first, title.second.DefaultButton != SDL_CONTROLLER_BUTTON_INVALID ? SDL_GameControllerGetStringForButton(
-					title.second.DefaultButton ) : "",
-				descriptions.at( static_cast<int>( title.second.Action ) ) );
+	const pString* buttonNames = values + 3 * nrOfActions;
+	for ( size_t i = 0; i < nrOfActions; ++i ) {
+		const pString& buttonName = buttonNames[i];
 		if ( buttonName != "" ) {
-			SDL_GameControllerButton button = SDL_GameControllerGetButtonFromString( buttonName.c_str() );
+			SDL_GameControllerButton button = InputNames::GetButtonFromName( buttonName.c_str() );
 			if ( button == SDL_CONTROLLER_BUTTON_INVALID ) {
-				LogInput( "Failed to interpret " + buttonName + " as a button", "KeyBindings", LogSeverity::WARNING_MSG );
+				Warn( warnings, "Failed to interpret " + buttonName + " as a button" );
 			} else {
-				m_GamepadBindingCollection.AddMappingWithButton( button, title.second.Action );
+				m_GamepadBindingCollection.AddMappingWithButton( button, m_Actions[i].Action );
 			}
 		}
 	}
+	LoadPlayerButtons( values[4 * nrOfActions], warnings );
+}
+
+void BindContext::LoadPlayerButtons( const pString& value, pVector<pString>* warnings ) {
+	IndexPlayerButtons( false );
+	m_PlayerButtons.clear();
+	m_PlayersWithBindings = 0;
+	++m_Revision;
+
+	size_t start = 0;
+	while ( start < value.size() ) {
+		size_t end = value.find( ',', start );
+		if ( end == pString::npos ) {
+			end = value.size();
+		}
+		pString entry  = value.substr( start, end - start );
+		start		   = end + 1;
+		size_t	colon  = entry.find( ':' );
+		size_t	equals = entry.find( '=', colon == pString::npos ? 0 : colon );
+		if ( colon == pString::npos || equals == pString::npos ) {
+			Warn( warnings, "Failed to interpret " + entry + " as player:action=button" );
+			continue;
+		}
+		pString playerName = entry.substr( 0, colon );
+		pString actionName = entry.substr( colon + 1, equals - colon - 1 );
+		pString buttonName = entry.substr( equals + 1 );
+
+		char* parsedEnd = nullptr;
+		long  player	= strtol( playerName.c_str(), &parsedEnd, 10 );
+		if ( playerName.empty() || *parsedEnd != '\0' || player < 0 || player >= INPUT_MAX_NR_OF_GAMEPADS ) {
+			Warn( warnings, "Failed to interpret " + playerName + " as a player" );
+			continue;
+		}
+		StringId nameId = m_Strings.Find( actionName.c_str(), actionName.size() );
+		if ( nameId == STRING_ID_INVALID || nameId >= m_ActionsByName.size() || m_ActionsByName[nameId] == -1 ) {
+			Warn( warnings, "No action named " + actionName + " in bind context " + m_Name );
+			continue;
+		}
+		// An empty button unbinds the action for the player
+		SDL_GameControllerButton button = buttonName == "" ? SDL_CONTROLLER_BUTTON_INVALID : InputNames::GetButtonFromName( buttonName.c_str() );
+		if ( buttonName != "" && button == SDL_CONTROLLER_BUTTON_INVALID ) {
+			Warn( warnings, "Failed to interpret " + buttonName + " as a button" );
+			continue;
+		}
+		ActionIdentifier action = m_Actions[m_ActionsByName[nameId]].Action;
+		if ( !SetPlayerButton( static_cast<INPUT_TYPE>( player ), action, button ) ) {
+			Warn( warnings, "Can't bind button: \"" + buttonName + "\" to action \"" + actionName + "\" of player " + playerName +
+								" because the player already uses it" );
+		}
+	}
+}
+
+void BindContext::CopyActions( const BindContext& other ) {
+	m_Actions.reserve( m_Actions.size() + other.m_Actions.size() );
+	for ( const ActionTitleMapping& action : other.m_Actions ) {
+		AddAction( action.Action, other.m_Strings.Get( action.Name ), action.DefaultScancode, action.DefaultButton );
+	}
+}
+
+void BindContext::SwapBindings( BindContext& other ) {
+	SwapBindingCollections( other.m_KeyBindingCollection, other.m_GamepadBindingCollection );
+	IndexPlayerButtons( false );
+	other.IndexPlayerButtons( false );
+	m_PlayerButtons.swap( other.m_PlayerButtons );
+	std::swap( m_PlayersWithBindings, other.m_PlayersWithBindings );
+	IndexPlayerButtons( true );
+	other.IndexPlayerButtons( true );
+}
+
+void BindContext::Warn( pVector<pString>* warnings, const pString& message ) {
+	if ( warnings ) {
+		warnings->push_back( message );
+	} else {
+		INPUT_LOG( LogSeverity::WARNING_MSG, "KeyBindings", message );
+	}
 }
 
 void BindContext::SaveToConfig( Config& cfg ) const {
-	for ( auto& keybinding : m_ActionTitleToAction ) {
-		SDL_Scancode primary = m_KeyBindingCollection.GetPrimaryScancodeFromAction( keybinding.second.Action );
-		cfg.SetString( m_Name + "primary." + keybinding.first, SDL_GetScancodeName( primary ) );
+	pVector<ConfigEntry> entries;
+	GetConfigEntries( entries );
+	for ( const ConfigEntry& entry : entries ) {
+		cfg.SetString( entry.Key, entry.Value );
+	}
+}
+
+void BindContext::GetConfigEntries( pVector<ConfigEntry>& entries ) const {
+	entries.reserve( entries.size() + m_Actions.size() * 4 );
+	for ( auto& action : m_Actions ) {
+		SDL_Scancode primary = m_KeyBindingCollection.GetPrimaryScancodeFromAction( action.Action );
+		entries.push_back( ConfigEntry { m_Strings.Get( action.PrimaryKey ), InputNames::GetScancodeName( primary ) } );
+	}
+	for ( auto& action : m_Actions ) {
+		SDL_Scancode secondary = m_KeyBindingCollection.GetSecondaryScancodeFromAction( action.Action );
+		entries.push_back( ConfigEntry { m_Strings.Get( action.SecondaryKey ), InputNames::GetScancodeName( secondary ) } );
 	}
-	for ( auto& keybinding : m_ActionTitleToAction ) {
-		SDL_Scancode secondary = m_KeyBindingCollection.GetSecondaryScancodeFromAction( keybinding.second.Action );
-		cfg.SetString( m_Name + "secondary." + keybinding.first, SDL_GetScancodeName( secondary ) );
+	for ( auto& action : m_Actions ) {
+		InputBinding mouse = m_KeyBindingCollection.GetMouseBindingFromAction( action.Action );
+		entries.push_back( ConfigEntry { m_Strings.Get( action.MouseKey ), InputNames::GetMouseBindingName( mouse ) } );
 	}
-	for ( auto& buttonBinding : m_ActionTitleToAction ) {
-		SDL_GameControllerButton button = m_GamepadBindingCollection.GetButtonFromAction( buttonBinding.second.Action );
-		cfg.SetString( m_Name + "gamepad." + buttonBinding.first, SDL_GameControllerGetStringForButton( button ) );
+	for ( auto& action : m_Actions ) {
+		SDL_GameControllerButton button = m_GamepadBindingCollection.GetButtonFromAction( action.Action );
+		entries.push_back( ConfigEntry { m_Strings.Get( action.GamepadKey ), InputNames::GetButtonName( button ) } );
 	}
+	pString players;
+	for ( const PlayerButton& entry : m_PlayerButtons ) {
+		auto mapping = std::find_if( m_Actions.begin(), m_Actions.end(), [&entry]( const ActionTitleMapping& action ) { return action.Action == entry.Action; } );
+		if ( mapping == m_Actions.end() ) {
+			continue;
+		}
+		if ( !players.empty() ) {
+			players += ",";
+		}
+		players += rToString( entry.Player ) + ":" + m_Strings.Get( mapping->Name ) + "=" + InputNames::GetButtonName( entry.Button );
+	}
+	entries.push_back( ConfigEntry { m_PlayersKey, players } );
 }
 
 void BindContext::ClearBindings() {
-	m_KeyBindingCollection = KeyBindingCollection();
-	m_GamepadBindingCollection = GamepadBindingCollection();
+	m_KeyBindingCollection = KeyBindingCollection( m_Owner );
+	m_GamepadBindingCollection = GamepadBindingCollection( m_Owner );
+	++m_Revision;
 }
 
 void BindContext::ClearActions() {
 	ClearBindings();
-	m_ActionTitleToAction.clear();
+	IndexPlayerButtons( false );
+	m_PlayerButtons.clear();
+	m_PlayersWithBindings = 0;
+	m_Actions.clear();
+	m_ActionsByName.clear();
+	m_Strings.Clear();
 }
 
 void BindContext::AddAction( ActionIdentifier actionIdentifier, const pString& name, SDL_Scancode defaultScancode, SDL_GameControllerButton defaultButton ) {
-	m_ActionTitleToAction[name] = ActionTitleMapping {
-		actionIdentifier, defaultScancode, defaultButton
-	};
+	StringId nameId = m_Strings.Find( name.c_str(), name.size() );
+	if ( nameId != STRING_ID_INVALID && nameId < m_ActionsByName.size() && m_ActionsByName[nameId] != -1 ) {
+		ActionTitleMapping& action = m_Actions[m_ActionsByName[nameId]];
+		action.Action			   = actionIdentifier;
+		action.DefaultScancode	   = defaultScancode;
+		action.DefaultButton	   = defaultButton;
+		return;
+	}
+	PushMapping( actionIdentifier, name.c_str(), defaultScancode, defaultButton );
+}
+
+void BindContext::AddActions( ActionIdentifier firstAction, const ActionDefinition* definitions, int count ) {
+	if ( !m_Actions.empty() ) {
+		// Names may clash with actions added before
+		for ( int i = 0; i < count; ++i ) {
+			AddAction( static_cast<ActionIdentifier>( static_cast<int>( firstAction ) + i ), definitions[i].Name, definitions[i].DefaultScancode,
+				definitions[i].DefaultButton );
+		}
+		return;
+	}
+	// Name and four config keys per action
+	size_t nrOfCharacters = 0;
+	for ( int i = 0; i < count; ++i ) {
+		nrOfCharacters += ( strlen( definitions[i].Name ) + m_Name.size() ) * 5 + 40;
+	}
+	m_Strings.Reserve( count * 5, nrOfCharacters );
+	m_Actions.reserve( count );
+	for ( int i = 0; i < count; ++i ) {
+		PushMapping( static_cast<ActionIdentifier>( static_cast<int>( firstAction ) + i ), definitions[i].Name, definitions[i].DefaultScancode,
+			definitions[i].DefaultButton );
+	}
+}
+
+BindContext::ActionTitleMapping BindContext::MakeMapping( ActionIdentifier action, const char* name, SDL_Scancode defaultScancode,
+	SDL_GameControllerButton defaultButton ) {
+	ActionTitleMapping mapping;
+	mapping.Action			= action;
+	mapping.DefaultScancode = defaultScancode;
+	mapping.DefaultButton	= defaultButton;
+	mapping.Name			= m_Strings.Intern( name );
+	mapping.PrimaryKey		= m_Strings.Concatenate( m_Name.c_str(), "primary.", name );
+	mapping.SecondaryKey	= m_Strings.Concatenate( m_Name.c_str(), "secondary.", name );
+	mapping.GamepadKey		= m_Strings.Concatenate( m_Name.c_str(), "gamepad.", name );
+	mapping.MouseKey		= m_Strings.Concatenate( m_Name.c_str(), "mouse.", name );
+	return mapping;
+}
+
+void BindContext::PushMapping( ActionIdentifier action, const char* name, SDL_Scancode defaultScancode, SDL_GameControllerButton defaultButton ) {
+	m_Actions.push_back( MakeMapping( action, name, defaultScancode, defaultButton ) );
+	StringId nameId = m_Actions.back().Name;
+	if ( nameId >= m_ActionsByName.size() ) {
+		m_ActionsByName.resize( m_Strings.GetNrOfStrings(), -1 );
+	}
+	m_ActionsByName[nameId] = static_cast<int>( m_Actions.size() ) - 1;
 }
 
 void BindContext::GetDefaultKeyBindings( KeyBindingCollection& collection ) const {
-	collection = KeyBindingCollection();
+	collection = KeyBindingCollection( m_Owner );
 
-	for ( auto& title : m_ActionTitleToAction ) {
-		collection.AddMappingWithScancode( title.second.DefaultScancode, title.second.Action );
+	for ( auto& action : m_Actions ) {
+		collection.AddMappingWithScancode( action.DefaultScancode, action.Action );
 	}
 }
 
 void BindContext::GetDefaultGamepadBindings( GamepadBindingCollection& collection ) const {
-	collection = GamepadBindingCollection();
+	collection = GamepadBindingCollection( m_Owner );
 
-	for ( auto& title : m_ActionTitleToAction ) {
-		collection.AddMappingWithButton( title.second.DefaultButton, title.second.Action );
+	for ( auto& action : m_Actions ) {
+		collection.AddMappingWithButton( action.DefaultButton, action.Action );
 	}
 }
 
-const rMap<rString, BindContext::ActionTitleMapping>& BindContext::GetActionTitleToAction() const {
-	return m_ActionTitleToAction;
+const pVector<BindContext::ActionTitleMapping>& BindContext::GetActions() const {
+	return m_Actions;
+}
+
+const StringPool& BindContext::GetStrings() const {
+	return m_Strings;
 }
 
 const KeyBindingCollection& BindContext::GetKeyBindCollection( ) const {
@@ -108,6 +313,8 @@ KeyBindingCollection& BindContext::GetEditableKeyBindCollection( ) {
 
 void BindContext::SetKeyBindingCollection( const KeyBindingCollection& collection ) {
 	m_KeyBindingCollection = collection;
+	m_KeyBindingCollection.SetOwner( m_Owner );
+	++m_Revision;
 }
 
 const GamepadBindingCollection& BindContext::GetGamepadBindCollection( ) const {
@@ -120,5 +327,181 @@ GamepadBindingCollection& BindContext::GetEditableGamepadBindCollection( ) {
 
 void BindContext::SetGamepadBindingCollection( const GamepadBindingCollection& collection ) {
 	m_GamepadBindingCollection = collection;
+	m_GamepadBindingCollection.SetOwner( m_Owner );
+	++m_Revision;
+}
+
+void BindContext::SwapBindingCollections( KeyBindingCollection& keys, GamepadBindingCollection& buttons ) {
+	m_KeyBindingCollection.Swap( keys );
+	m_GamepadBindingCollection.Swap( buttons );
+	++m_Revision;
+}
+
+void BindContext::SetBindingIndex( BindingIndex* index, BindContextHandle handle ) {
+	m_KeyBindingCollection.SetIndex( index, handle );
+	m_GamepadBindingCollection.SetIndex( index, handle );
+	IndexPlayerButtons( false );
+	m_Index		  = index;
+	m_IndexHandle = handle;
+	IndexPlayerButtons( true );
 }
 
+bool BindContext::SetPlayerButton( INPUT_TYPE player, ActionIdentifier action, SDL_GameControllerButton button, bool clearConflicting ) {
+	if ( !InputTypeIsGamepad( player ) || static_cast<int>( player ) >= INPUT_MAX_NR_OF_GAMEPADS || static_cast<int>( action ) < 0 ) {
+		return false;
+	}
+	if ( button != SDL_CONTROLLER_BUTTON_INVALID ) {
+		ActionIdentifier conflicting = GetActionFromButton( button, player );
+		if ( conflicting != ActionIdentifier() && conflicting != action ) {
+			if ( !clearConflicting ) {
+				return false;
+			}
+			StorePlayerButton( player, conflicting, SDL_CONTROLLER_BUTTON_INVALID );
+		}
+	}
+	StorePlayerButton( player, action, button );
+	return true;
+}
+
+void BindContext::ResetPlayerButton( INPUT_TYPE player, ActionIdentifier action ) {
+	auto it = FindPlayerButton( player, action );
+	if ( it != m_PlayerButtons.end() && it->Player == player && it->Action == action ) {
+		IndexPlayerButton( *it, false );
+		m_PlayerButtons.erase( it );
+		UpdatePlayerMask( player );
+		++m_Revision;
+	}
+}
+
+void BindContext::ResetPlayerBindings( INPUT_TYPE player ) {
+	for ( auto it = FindPlayerButton( player, ActionIdentifier( 0 ) ); it != m_PlayerButtons.end() && it->Player == player; ++it ) {
+		IndexPlayerButton( *it, false );
+	}
+	size_t nrOfButtons = m_PlayerButtons.size();
+	m_PlayerButtons.erase( std::remove_if( m_PlayerButtons.begin(), m_PlayerButtons.end(), [player]( const PlayerButton& entry ) { return entry.Player == player; } ),
+						   m_PlayerButtons.end() );
+	UpdatePlayerMask( player );
+	if ( m_PlayerButtons.size() != nrOfButtons ) {
+		++m_Revision;
+	}
+}
+
+const pVector<BindContext::PlayerButton>& BindContext::GetPlayerButtons() const {
+	return m_PlayerButtons;
+}
+
+bool BindContext::HasPlayerBindings( INPUT_TYPE player ) const {
+	return InputTypeIsGamepad( player ) && static_cast<int>( player ) < INPUT_MAX_NR_OF_GAMEPADS && ( m_PlayersWithBindings & ( 1u << player ) ) != 0;
+}
+
+SDL_GameControllerButton BindContext::GetButtonFromAction( ActionIdentifier action, INPUT_TYPE inputType ) const {
+	if ( HasPlayerBindings( inputType ) ) {
+		auto it = FindPlayerButton( inputType, action );
+		if ( it != m_PlayerButtons.end() && it->Player == inputType && it->Action == action ) {
+			return it->Button;
+		}
+	}
+	return m_GamepadBindingCollection.GetButtonFromAction( action );
+}
+
+ActionIdentifier BindContext::GetActionFromButton( SDL_GameControllerButton button, INPUT_TYPE inputType ) const {
+	if ( !HasPlayerBindings( inputType ) ) {
+		return m_GamepadBindingCollection.GetActionFromButton( button );
+	}
+	// A player rebinding action moves it away from the shared button, so both tables are checked
+	for ( auto it = FindPlayerButton( inputType, ActionIdentifier( 0 ) ); it != m_PlayerButtons.end() && it->Player == inputType; ++it ) {
+		if ( it->Button == button ) {
+			return it->Action;
+		}
+	}
+	ActionIdentifier shared = m_GamepadBindingCollection.GetActionFromButton( button );
+	if ( shared != ActionIdentifier() && GetButtonFromAction( shared, inputType ) != button ) {
+		return ActionIdentifier();
+	}
+	return shared;
+}
+
+pVector<BindContext::PlayerButton>::iterator BindContext::FindPlayerButton( int player, ActionIdentifier action ) {
+	return std::lower_bound( m_PlayerButtons.begin(), m_PlayerButtons.end(), PlayerButton { player, action, SDL_CONTROLLER_BUTTON_INVALID },
+							 []( const PlayerButton& lhs, const PlayerButton& rhs ) {
+								 return lhs.Player != rhs.Player ? lhs.Player < rhs.Player : static_cast<int>( lhs.Action ) < static_cast<int>( rhs.Action );
+							 } );
+}
+
+pVector<BindContext::PlayerButton>::const_iterator BindContext::FindPlayerButton( int player, ActionIdentifier action ) const {
+	return const_cast<BindContext*>( this )->FindPlayerButton( player, action );
+}
+
+void BindContext::StorePlayerButton( int player, ActionIdentifier action, SDL_GameControllerButton button ) {
+	auto it = FindPlayerButton( player, action );
+	bool found = it != m_PlayerButtons.end() && it->Player == player && it->Action == action;
+	if ( found ) {
+		IndexPlayerButton( *it, false );
+		it->Button = button;
+	} else {
+		it = m_PlayerButtons.insert( it, PlayerButton { player, action, button } );
+	}
+	IndexPlayerButton( *it, true );
+	UpdatePlayerMask( player );
+	++m_Revision;
+}
+
+void BindContext::UpdatePlayerMask( int player ) {
+	if ( player < 0 || player >= INPUT_MAX_NR_OF_GAMEPADS ) {
+		return;
+	}
+	auto first = FindPlayerButton( player, ActionIdentifier( 0 ) );
+	if ( first != m_PlayerButtons.end() && first->Player == player ) {
+		m_PlayersWithBindings |= 1u << player;
+	} else {
+		m_PlayersWithBindings &= ~( 1u << player );
+	}
+}
+
+void BindContext::IndexPlayerButton( const PlayerButton& entry, bool add ) {
+	if ( m_Index == nullptr ) {
+		return;
+	}
+	BindingUse use { m_IndexHandle, entry.Action, KeyBindingType::Primary, static_cast<INPUT_TYPE>( entry.Player ) };
+	if ( entry.Button == SDL_CONTROLLER_BUTTON_INVALID ) {
+		// Unbinding hides the shared button without being a use of its own
+		m_Index->MarkChanged();
+	} else if ( add ) {
+		m_Index->AddButtonUse( entry.Button, use );
+	} else {
+		m_Index->RemoveButtonUse( entry.Button, use );
+	}
+}
+
+void BindContext::IndexPlayerButtons( bool add ) {
+	for ( const PlayerButton& entry : m_PlayerButtons ) {
+		IndexPlayerButton( entry, add );
+	}
+}
+
+BindingTransaction BindContext::BeginTransaction() {
+	return BindingTransaction( *this );
+}
+
+Uint32 BindContext::GetRevision() const {
+	return m_Revision;
+}
+
+bool BindContext::IsDirty() const {
+	return m_Revision != m_CleanRevision || m_KeyBindingCollection.GetRevision() != m_CleanKeyRevision ||
+		   m_GamepadBindingCollection.GetRevision() != m_CleanButtonRevision;
+}
+
+void BindContext::MarkClean() {
+	MarkClean( GetRevisions() );
+}
+
+BindContext::Revisions BindContext::GetRevisions() const {
+	return Revisions { m_Revision, m_KeyBindingCollection.GetRevision(), m_GamepadBindingCollection.GetRevision() };
+}
+
+void BindContext::MarkClean( const Revisions& revisions ) {
+	m_CleanRevision		  = revisions.Context;
+	m_CleanKeyRevision	  = revisions.Keys;
+	m_CleanButtonRevision = revisions.Buttons;
+}
@@ -1,43 +1,149 @@
 #pragma once
 #include <SDL2/SDL_scancode.h>
 #include <SDL2/SDL_gamecontroller.h>
+#include <functional>
 #include "Types.h"
 #include "KeyBindingCollection.h"
 #include "GamepadBindingCollection.h"
+#include "StringPool.h"
+#include "BindingTransaction.h"
 
 class Config;
+class KeyBindings;
+struct ActionDefinition;
 
 class BindContext {
 public:
 	struct ActionTitleMapping;
 
-	INPUT_API BindContext( const pString& name );
+	struct ConfigEntry {
+		pString Key;
+		pString Value;
+	};
+
+	// Description of an action, for config comments and warnings.
+	typedef std::function<const char*( ActionIdentifier )> DescriptionFunction;
+
+	// A gamepad button bound for one player. SDL_CONTROLLER_BUTTON_INVALID unbinds the action for the player.
+	struct PlayerButton {
+		int						 Player;
+		ActionIdentifier		 Action;
+		SDL_GameControllerButton Button;
+	};
 
-	INPUT_API void LoadFromConfig( Config& cfg, const pVector<pString> descriptions );
+	INPUT_API BindContext( const pString& name, const KeyBindings* owner = nullptr );
+	INPUT_API ~BindContext();
+
+	BindContext( const BindContext& rhs ) = delete;
+	BindContext& operator = ( const BindContext& rhs ) = delete;
+
+	INPUT_API const pString& GetName() const;
+	INPUT_API void LoadFromConfig( Config& cfg, const KeyBindings& keyBindings );
+	// The names LoadFromConfig reads, appended to values: the primary keys of all actions in order, then the
+	// secondary keys, mouse bindings and gamepad buttons, and last the player buttons of the context as one value.
+	INPUT_API void ReadConfigValues( Config& cfg, const DescriptionFunction& description, pVector<pString>& values ) const;
+	// Binds the actions from the names ReadConfigValues returned, starting at values. Replaces the player buttons.
+	// Warnings are appended to warnings, or logged if it is null. Only the context itself is touched, so a detached
+	// context filled by CopyActions can be loaded on any thread and handed over with SwapBindings.
+	INPUT_API void LoadFromConfigValues( const pString* values, const DescriptionFunction& description, pVector<pString>* warnings = nullptr );
+	// Adds the actions of other, without their bindings.
+	INPUT_API void CopyActions( const BindContext& other );
+	// Exchanges the collections and player buttons with other, which should have the same actions.
+	INPUT_API void SwapBindings( BindContext& other );
 	INPUT_API void SaveToConfig( Config& cfg ) const;
+	// The key/value pairs SaveToConfig writes, appended to entries.
+	INPUT_API void GetConfigEntries( pVector<ConfigEntry>& entries ) const;
 	INPUT_API void ClearBindings();
 	INPUT_API void ClearActions();
 	INPUT_API void AddAction( ActionIdentifier actionIdentifier, const pString &name, SDL_Scancode scancode, SDL_GameControllerButton = SDL_CONTROLLER_BUTTON_INVALID );
+	// Adds count actions with consecutive identifiers starting at firstAction.
+	INPUT_API void AddActions( ActionIdentifier firstAction, const ActionDefinition* definitions, int count );
 
 	INPUT_API void									   GetDefaultKeyBindings ( KeyBindingCollection& collection ) const;
 	INPUT_API void									   GetDefaultGamepadBindings ( GamepadBindingCollection& collection ) const;
-	INPUT_API const rMap<rString, ActionTitleMapping>& GetActionTitleToAction  () const;
+	// In the order the actions were added.
+	INPUT_API const pVector<ActionTitleMapping>&	   GetActions () const;
+	// Action names and config keys of the context.
+	INPUT_API const StringPool&						   GetStrings () const;
 	INPUT_API const KeyBindingCollection&	  GetKeyBindCollection () const;
 	INPUT_API KeyBindingCollection&			  GetEditableKeyBindCollection ();
 	INPUT_API void							  SetKeyBindingCollection ( const KeyBindingCollection& collection );
 	INPUT_API const GamepadBindingCollection& GetGamepadBindCollection () const;
 	INPUT_API GamepadBindingCollection&		  GetEditableGamepadBindCollection ();
 	INPUT_API void							  SetGamepadBindingCollection ( const GamepadBindingCollection& collection );
+	// Replaces both collections at once. The arguments receive the previous bindings.
+	INPUT_API void							  SwapBindingCollections ( KeyBindingCollection& keys, GamepadBindingCollection& buttons );
+	// Gamepad bindings of one player. Players use the bindings of the context until they rebind an action,
+	// and only the rebound actions are stored per player. A rebound action keeps its button when the shared
+	// binding changes, even if it was set to the shared button; ResetPlayerButton follows the shared one again. Fails if the button is used by another action of
+	// the player, unless clearConflicting unbinds that action for the player.
+	// Player buttons are saved to the config under the context name followed by "players".
+	INPUT_API bool							  SetPlayerButton ( INPUT_TYPE player, ActionIdentifier action, SDL_GameControllerButton button, bool clearConflicting = false );
+	INPUT_API void							  ResetPlayerButton ( INPUT_TYPE player, ActionIdentifier action );
+	INPUT_API void							  ResetPlayerBindings ( INPUT_TYPE player );
+	INPUT_API bool							  HasPlayerBindings ( INPUT_TYPE player ) const;
+	// Sorted by player and action.
+	INPUT_API const pVector<PlayerButton>&	  GetPlayerButtons () const;
+	// Bindings as seen by a gamepad, with player bindings applied.
+	INPUT_API SDL_GameControllerButton		  GetButtonFromAction ( ActionIdentifier action, INPUT_TYPE inputType ) const;
+	INPUT_API ActionIdentifier				  GetActionFromButton ( SDL_GameControllerButton button, INPUT_TYPE inputType ) const;
+	// Stages binding changes to apply together, see BindingTransaction.
+	INPUT_API BindingTransaction			  BeginTransaction ();
+	// Incremented when a collection is replaced or a player button changes. Changes within a collection are tracked by its own revision.
+	INPUT_API Uint32						  GetRevision () const;
+	// True if any binding changed since the last MarkClean.
+	INPUT_API bool							  IsDirty () const;
+	INPUT_API void							  MarkClean ();
+	// Revisions of the context and its collections, for marking it clean as of an earlier state.
+	struct Revisions {
+		Uint32 Context;
+		Uint32 Keys;
+		Uint32 Buttons;
+	};
+	INPUT_API Revisions						  GetRevisions () const;
+	// Changes made after revisions were taken keep the context dirty.
+	INPUT_API void							  MarkClean ( const Revisions& revisions );
+	// Registers the bindings of the context in index under handle.
+	INPUT_API void							  SetBindingIndex ( BindingIndex* index, BindContextHandle handle );
 
 	struct ActionTitleMapping {
 		ActionIdentifier		 Action;
 		SDL_Scancode			 DefaultScancode;
 		SDL_GameControllerButton DefaultButton;
+		StringId				 Name;
+		StringId				 PrimaryKey;	// Config keys, prefixed with the context name
+		StringId				 SecondaryKey;
+		StringId				 GamepadKey;
+		StringId				 MouseKey;
 	};
 
 private:
+	pVector<PlayerButton>::iterator		  FindPlayerButton ( int player, ActionIdentifier action );
+	pVector<PlayerButton>::const_iterator FindPlayerButton ( int player, ActionIdentifier action ) const;
+	void								  StorePlayerButton ( int player, ActionIdentifier action, SDL_GameControllerButton button );
+	void								  UpdatePlayerMask ( int player );
+	void								  IndexPlayerButton ( const PlayerButton& entry, bool add );
+	void								  IndexPlayerButtons ( bool add );
+	void								  LoadPlayerButtons ( const pString& value, pVector<pString>* warnings );
+	static void							  Warn ( pVector<pString>* warnings, const pString& message );
+
+	const KeyBindings*				  m_Owner;
 	pString							  m_Name;
-	pMap<pString, ActionTitleMapping> m_ActionTitleToAction;
+	pString							  m_PlayersKey;	// Config key of the player buttons
+	pVector<ActionTitleMapping>		  m_Actions;
+	pVector<int>					  m_ActionsByName;	// Index into m_Actions per name StringId, -1 for the other strings
+	StringPool						  m_Strings;
 	KeyBindingCollection			  m_KeyBindingCollection;
 	GamepadBindingCollection		  m_GamepadBindingCollection;
+	Uint32							  m_Revision = 0;
+	Uint32							  m_CleanRevision		 = 0;
+	Uint32							  m_CleanKeyRevision	 = 0;
+	Uint32							  m_CleanButtonRevision = 0;
+	pVector<PlayerButton>			  m_PlayerButtons;	// Sorted by player and action
+	Uint32							  m_PlayersWithBindings = 0;	// Bit per player with entries in m_PlayerButtons
+	BindingIndex*					  m_Index = nullptr;	// Where the player buttons are registered, the collections keep their own
+	BindContextHandle				  m_IndexHandle;
+
+	ActionTitleMapping MakeMapping ( ActionIdentifier action, const char* name, SDL_Scancode defaultScancode, SDL_GameControllerButton defaultButton );
+	void			   PushMapping ( ActionIdentifier action, const char* name, SDL_Scancode defaultScancode, SDL_GameControllerButton defaultButton );
 };
@@ -0,0 +1,220 @@
+#include "BindingIndex.h"
+#include <algorithm>
+
+BindingIndex::BindingIndex()
+	: m_ScancodeUses( SDL_NUM_SCANCODES ), m_MouseUses( INPUT_NR_OF_MOUSE_BINDINGS ), m_ButtonUses( SDL_CONTROLLER_BUTTON_MAX ) {
+}
+
+const BindingUse* BindingIndex::GetScancodeUses( SDL_Scancode scancode, int& nrOfUses ) const {
+	if ( scancode < 0 || scancode >= SDL_NUM_SCANCODES ) {
+		nrOfUses = 0;
+		return nullptr;
+	}
+	nrOfUses = static_cast<int>( m_ScancodeUses[scancode].size() );
+	return m_ScancodeUses[scancode].data();
+}
+
+const BindingUse* BindingIndex::GetMouseUses( InputBinding binding, int& nrOfUses ) const {
+	int index = binding.GetMouseIndex();
+	if ( index < 0 ) {
+		nrOfUses = 0;
+		return nullptr;
+	}
+	nrOfUses = static_cast<int>( m_MouseUses[index].size() );
+	return m_MouseUses[index].data();
+}
+
+const BindingUse* BindingIndex::GetButtonUses( SDL_GameControllerButton button, int& nrOfUses ) const {
+	if ( button < 0 || button >= SDL_CONTROLLER_BUTTON_MAX ) {
+		nrOfUses = 0;
+		return nullptr;
+	}
+	nrOfUses = static_cast<int>( m_ButtonUses[button].size() );
+	return m_ButtonUses[button].data();
+}
+
+void BindingIndex::SetSharingPolicy( BindContextHandle first, BindContextHandle second, BindingSharingPolicy policy ) {
+	int firstIndex	= static_cast<int>( first );
+	int secondIndex = static_cast<int>( second );
+	if ( firstIndex < 0 || secondIndex < 0 ) {
+		return;
+	}
+	int nrOfContexts = std::max( firstIndex, secondIndex ) + 1;
+	if ( nrOfContexts > m_NrOfPolicyContexts ) {
+		pVector<Uint8> exclusive( nrOfContexts * nrOfContexts, 0 );
+		for ( int row = 0; row < m_NrOfPolicyContexts; ++row ) {
+			for ( int column = 0; column < m_NrOfPolicyContexts; ++column ) {
+				exclusive[row * nrOfContexts + column] = m_Exclusive[row * m_NrOfPolicyContexts + column];
+			}
+		}
+		m_Exclusive.swap( exclusive );
+		m_NrOfPolicyContexts = nrOfContexts;
+	}
+	Uint8 value = policy == BindingSharingPolicy::Exclusive ? 1 : 0;
+	m_Exclusive[firstIndex * m_NrOfPolicyContexts + secondIndex] = value;
+	m_Exclusive[secondIndex * m_NrOfPolicyContexts + firstIndex] = value;
+	++m_Revision;
+	// Policies change rarely, so the conflicts are recounted rather than adjusted
+	CountConflicts();
+}
+
+BindingSharingPolicy BindingIndex::GetSharingPolicy( BindContextHandle first, BindContextHandle second ) const {
+	int firstIndex	= static_cast<int>( first );
+	int secondIndex = static_cast<int>( second );
+	if ( firstIndex < 0 || secondIndex < 0 || firstIndex >= m_NrOfPolicyContexts || secondIndex >= m_NrOfPolicyContexts ) {
+		return BindingSharingPolicy::Shared;
+	}
+	return m_Exclusive[firstIndex * m_NrOfPolicyContexts + secondIndex] ? BindingSharingPolicy::Exclusive : BindingSharingPolicy::Shared;
+}
+
+void BindingIndex::ClearSharingPolicies( BindContextHandle context ) {
+	int index = static_cast<int>( context );
+	if ( index < 0 || index >= m_NrOfPolicyContexts ) {
+		return;
+	}
+	for ( int other = 0; other < m_NrOfPolicyContexts; ++other ) {
+		m_Exclusive[index * m_NrOfPolicyContexts + other] = 0;
+		m_Exclusive[other * m_NrOfPolicyContexts + index] = 0;
+	}
+	++m_Revision;
+	CountConflicts();
+}
+
+bool BindingIndex::GetScancodeConflicts( BindContextHandle context, ActionIdentifier action, SDL_Scancode scancode, pVector<BindingUse>& conflicts ) const {
+	if ( scancode < 0 || scancode >= SDL_NUM_SCANCODES ) {
+		return false;
+	}
+	return GetConflicts( m_ScancodeUses[scancode], BindingUse { context, action, KeyBindingType::Primary }, conflicts );
+}
+
+bool BindingIndex::GetMouseConflicts( BindContextHandle context, ActionIdentifier action, InputBinding binding, pVector<BindingUse>& conflicts ) const {
+	int index = binding.GetMouseIndex();
+	if ( index < 0 ) {
+		return false;
+	}
+	return GetConflicts( m_MouseUses[index], BindingUse { context, action, KeyBindingType::Primary }, conflicts );
+}
+
+bool BindingIndex::GetButtonConflicts( BindContextHandle context, ActionIdentifier action, SDL_GameControllerButton button, pVector<BindingUse>& conflicts,
+									   INPUT_TYPE player ) const {
+	if ( button < 0 || button >= SDL_CONTROLLER_BUTTON_MAX ) {
+		return false;
+	}
+	return GetConflicts( m_ButtonUses[button], BindingUse { context, action, KeyBindingType::Primary, player }, conflicts );
+}
+
+int BindingIndex::GetNrOfConflicts() const {
+	return m_NrOfConflicts;
+}
+
+Uint32 BindingIndex::GetRevision() const {
+	return m_Revision;
+}
+
+void BindingIndex::MarkChanged() {
+	++m_Revision;
+}
+
+void BindingIndex::AddScancodeUse( SDL_Scancode scancode, const BindingUse& use ) {
+	if ( scancode > SDL_SCANCODE_UNKNOWN && scancode < SDL_NUM_SCANCODES ) {
+		AddUse( m_ScancodeUses[scancode], use );
+	}
+}
+
+void BindingIndex::RemoveScancodeUse( SDL_Scancode scancode, const BindingUse& use ) {
+	if ( scancode > SDL_SCANCODE_UNKNOWN && scancode < SDL_NUM_SCANCODES ) {
+		RemoveUse( m_ScancodeUses[scancode], use );
+	}
+}
+
+void BindingIndex::AddMouseUse( InputBinding binding, const BindingUse& use ) {
+	int index = binding.GetMouseIndex();
+	if ( index >= 0 ) {
+		AddUse( m_MouseUses[index], use );
+	}
+}
+
+void BindingIndex::RemoveMouseUse( InputBinding binding, const BindingUse& use ) {
+	int index = binding.GetMouseIndex();
+	if ( index >= 0 ) {
+		RemoveUse( m_MouseUses[index], use );
+	}
+}
+
+void BindingIndex::AddButtonUse( SDL_GameControllerButton button, const BindingUse& use ) {
+	if ( button > SDL_CONTROLLER_BUTTON_INVALID && button < SDL_CONTROLLER_BUTTON_MAX ) {
+		AddUse( m_ButtonUses[button], use );
+	}
+}
+
+void BindingIndex::RemoveButtonUse( SDL_GameControllerButton button, const BindingUse& use ) {
+	if ( button > SDL_CONTROLLER_BUTTON_INVALID && button < SDL_CONTROLLER_BUTTON_MAX ) {
+		RemoveUse( m_ButtonUses[button], use );
+	}
+}
+
+bool BindingIndex::Conflicts( const BindingUse& lhs, const BindingUse& rhs ) const {
+	// Different players never press the same gamepad
+	if ( lhs.Player != INPUT_TYPE_ANY && rhs.Player != INPUT_TYPE_ANY && lhs.Player != rhs.Player ) {
+		return false;
+	}
+	if ( lhs.BindContext == rhs.BindContext ) {
+		return lhs.Action != rhs.Action && lhs.Player == rhs.Player;
+	}
+	return GetSharingPolicy( lhs.BindContext, rhs.BindContext ) == BindingSharingPolicy::Exclusive;
+}
+
+void BindingIndex::AddUse( pVector<BindingUse>& uses, const BindingUse& use ) {
+	for ( const BindingUse& other : uses ) {
+		if ( Conflicts( use, other ) ) {
+			++m_NrOfConflicts;
+		}
+	}
+	uses.push_back( use );
+	++m_Revision;
+}
+
+void BindingIndex::RemoveUse( pVector<BindingUse>& uses, const BindingUse& use ) {
+	for ( size_t i = 0; i < uses.size(); ++i ) {
+		if ( uses[i].BindContext == use.BindContext && uses[i].Action == use.Action && uses[i].Slot == use.Slot && uses[i].Player == use.Player ) {
+			uses[i] = uses.back();
+			uses.pop_back();
+			++m_Revision;
+			for ( const BindingUse& other : uses ) {
+				if ( Conflicts( use, other ) ) {
+					--m_NrOfConflicts;
+				}
+			}
+			return;
+		}
+	}
+}
+
+bool BindingIndex::GetConflicts( const pVector<BindingUse>& uses, const BindingUse& candidate, pVector<BindingUse>& conflicts ) const {
+	bool found = false;
+	for ( const BindingUse& use : uses ) {
+		if ( Conflicts( candidate, use ) ) {
+			conflicts.push_back( use );
+			found = true;
+		}
+	}
+	return found;
+}
+
+void BindingIndex::CountConflicts() {
+	m_NrOfConflicts = 0;
+	auto count = [this]( const pVector<pVector<BindingUse>>& inputs ) {
+		for ( const pVector<BindingUse>& uses : inputs ) {
+			for ( size_t i = 0; i < uses.size(); ++i ) {
+				for ( size_t j = i + 1; j < uses.size(); ++j ) {
+					if ( Conflicts( uses[i], uses[j] ) ) {
+						++m_NrOfConflicts;
+					}
+				}
+			}
+		}
+	};
+	count( m_ScancodeUses );
+	count( m_MouseUses );
+	count( m_ButtonUses );
+}
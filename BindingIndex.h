@@ -0,0 +1,74 @@
+#pragma once
+#include <SDL2/SDL_scancode.h>
+#include <SDL2/SDL_gamecontroller.h>
+#include "InputLibraryDefine.h"
+#include "Types.h"
+#include "InputBinding.h"
+
+// One slot of a bind context bound to a key, mouse input or button.
+struct BindingUse {
+	BindContextHandle BindContext;
+	ActionIdentifier  Action;
+	KeyBindingType	  Slot;	// Primary for mouse inputs and gamepad buttons
+	INPUT_TYPE		  Player = INPUT_TYPE_ANY;	// A gamepad for per-player buttons, otherwise shared by all
+};
+
+enum class BindingSharingPolicy {
+	Shared,		// Both contexts may bind the same input, e.g. a menu and the game it pauses
+	Exclusive	// Binding an input in both contexts is a conflict
+};
+
+// Which bind contexts use each key, mouse input and button. Kept up to date by the binding collections and
+// player bindings of the contexts registered with KeyBindings, so queries cost as much as the number of uses found.
+class BindingIndex {
+public:
+	INPUT_API BindingIndex();
+
+	INPUT_API const BindingUse* GetScancodeUses ( SDL_Scancode scancode, int& nrOfUses ) const;
+	INPUT_API const BindingUse* GetMouseUses ( InputBinding binding, int& nrOfUses ) const;
+	// Shared and per-player uses alike, see BindingUse::Player.
+	INPUT_API const BindingUse* GetButtonUses ( SDL_GameControllerButton button, int& nrOfUses ) const;
+
+	// Contexts share inputs unless declared exclusive. A context never shares an input between its own actions.
+	INPUT_API void					 SetSharingPolicy ( BindContextHandle first, BindContextHandle second, BindingSharingPolicy policy );
+	INPUT_API BindingSharingPolicy GetSharingPolicy ( BindContextHandle first, BindContextHandle second ) const;
+	// Resets the policies of a context, e.g. when its handle is reused.
+	INPUT_API void					 ClearSharingPolicies ( BindContextHandle context );
+
+	// Appends the uses that binding the input to action in context would conflict with. Returns true if there were any.
+	// A player's buttons replace the shared ones of their context, so within a context they only conflict with the
+	// other buttons of that player.
+	INPUT_API bool GetScancodeConflicts ( BindContextHandle context, ActionIdentifier action, SDL_Scancode scancode, pVector<BindingUse>& conflicts ) const;
+	INPUT_API bool GetMouseConflicts ( BindContextHandle context, ActionIdentifier action, InputBinding binding, pVector<BindingUse>& conflicts ) const;
+	INPUT_API bool GetButtonConflicts ( BindContextHandle context, ActionIdentifier action, SDL_GameControllerButton button, pVector<BindingUse>& conflicts,
+										INPUT_TYPE player = INPUT_TYPE_ANY ) const;
+	// Number of pairs of uses that currently conflict.
+	INPUT_API int  GetNrOfConflicts () const;
+	// Incremented whenever a use or policy changes, or MarkChanged is called.
+	INPUT_API Uint32 GetRevision () const;
+	// For binding changes that add or remove no use, e.g. a player unbinding an action.
+	INPUT_API void	 MarkChanged ();
+
+	// Called by the binding collections.
+	INPUT_API void AddScancodeUse ( SDL_Scancode scancode, const BindingUse& use );
+	INPUT_API void RemoveScancodeUse ( SDL_Scancode scancode, const BindingUse& use );
+	INPUT_API void AddMouseUse ( InputBinding binding, const BindingUse& use );
+	INPUT_API void RemoveMouseUse ( InputBinding binding, const BindingUse& use );
+	INPUT_API void AddButtonUse ( SDL_GameControllerButton button, const BindingUse& use );
+	INPUT_API void RemoveButtonUse ( SDL_GameControllerButton button, const BindingUse& use );
+
+private:
+	bool Conflicts ( const BindingUse& lhs, const BindingUse& rhs ) const;
+	void AddUse ( pVector<BindingUse>& uses, const BindingUse& use );
+	void RemoveUse ( pVector<BindingUse>& uses, const BindingUse& use );
+	bool GetConflicts ( const pVector<BindingUse>& uses, const BindingUse& candidate, pVector<BindingUse>& conflicts ) const;
+	void CountConflicts ();
+
+	pVector<pVector<BindingUse>> m_ScancodeUses;	// SDL_NUM_SCANCODES entries
+	pVector<pVector<BindingUse>> m_MouseUses;		// INPUT_NR_OF_MOUSE_BINDINGS entries, see InputBinding::GetMouseIndex
+	pVector<pVector<BindingUse>> m_ButtonUses;		// SDL_CONTROLLER_BUTTON_MAX entries
+	pVector<Uint8>				 m_Exclusive;		// m_NrOfPolicyContexts squared, 1 if the pair is exclusive
+	int							 m_NrOfPolicyContexts = 0;
+	int							 m_NrOfConflicts = 0;
+	Uint32						 m_Revision = 0;
+};
@@ -0,0 +1,200 @@
+#include "BindingTransaction.h"
+#include <algorithm>
+#include "BindContext.h"
+
+BindingTransaction::BindingTransaction( BindContext& context )
+	: m_Context( &context ) {
+}
+
+void BindingTransaction::BindKey( ActionIdentifier action, SDL_Scancode scancode, KeyBindingType slot ) {
+	m_Changes.push_back( Change { action, slot == KeyBindingType::Secondary ? Slot::Secondary : Slot::Primary, static_cast<int>( scancode ) } );
+}
+
+void BindingTransaction::UnbindKey( ActionIdentifier action, KeyBindingType slot ) {
+	BindKey( action, SDL_SCANCODE_UNKNOWN, slot );
+}
+
+void BindingTransaction::BindMouse( ActionIdentifier action, InputBinding binding ) {
+	m_Changes.push_back( Change { action, Slot::Mouse, static_cast<int>( binding.GetValue() ) } );
+}
+
+void BindingTransaction::UnbindMouse( ActionIdentifier action ) {
+	BindMouse( action, InputBinding() );
+}
+
+void BindingTransaction::BindButton( ActionIdentifier action, SDL_GameControllerButton button ) {
+	m_Changes.push_back( Change { action, Slot::Button, static_cast<int>( button ) } );
+}
+
+void BindingTransaction::UnbindButton( ActionIdentifier action ) {
+	BindButton( action, SDL_CONTROLLER_BUTTON_INVALID );
+}
+
+void BindingTransaction::Clear() {
+	m_Changes.clear();
+}
+
+int BindingTransaction::GetNrOfChanges() const {
+	return static_cast<int>( m_Changes.size() );
+}
+
+bool BindingTransaction::Validate( bool clearConflicting, pVector<BindingConflict>* conflicts ) const {
+	rVector<SDL_Scancode>			  primary;
+	rVector<SDL_Scancode>			  secondary;
+	rVector<InputBinding>			  mouse;
+	rVector<SDL_GameControllerButton> buttons;
+	return Resolve( clearConflicting, conflicts, primary, secondary, mouse, buttons );
+}
+
+bool BindingTransaction::Commit( bool clearConflicting, pVector<BindingConflict>* conflicts ) {
+	rVector<SDL_Scancode>			  primary;
+	rVector<SDL_Scancode>			  secondary;
+	rVector<InputBinding>			  mouse;
+	rVector<SDL_GameControllerButton> buttons;
+	if ( !Resolve( clearConflicting, conflicts, primary, secondary, mouse, buttons ) ) {
+		return false;
+	}
+	// Built on the side and swapped in, so the context never holds a half applied transaction
+	KeyBindingCollection	 keys( m_Context->GetKeyBindCollection() );
+	GamepadBindingCollection gamepad( m_Context->GetGamepadBindCollection() );
+	keys.Assign( primary, secondary, mouse );
+	gamepad.Assign( buttons );
+	m_Context->SwapBindingCollections( keys, gamepad );
+	m_Changes.clear();
+	return true;
+}
+
+bool BindingTransaction::Resolve( bool clearConflicting, pVector<BindingConflict>* conflicts, rVector<SDL_Scancode>& primary,
+								  rVector<SDL_Scancode>& secondary, rVector<InputBinding>& mouse, rVector<SDL_GameControllerButton>& buttons ) const {
+	const KeyBindingCollection&		keyCollection	  = m_Context->GetKeyBindCollection();
+	const GamepadBindingCollection& gamepadCollection = m_Context->GetGamepadBindCollection();
+	bool							valid			  = true;
+	auto report = [&valid, conflicts]( BindingConflictType type, ActionIdentifier action, ActionIdentifier conflictingAction, SDL_Scancode scancode,
+									   InputBinding mouseBinding, SDL_GameControllerButton button ) {
+		valid = false;
+		if ( conflicts != nullptr ) {
+			conflicts->push_back( BindingConflict { type, action, conflictingAction, scancode, mouseBinding, button } );
+		}
+	};
+	auto reportInvalid = [&report]( ActionIdentifier action ) {
+		report( BindingConflictType::InvalidBinding, action, ActionIdentifier(), SDL_SCANCODE_UNKNOWN, InputBinding(), SDL_CONTROLLER_BUTTON_INVALID );
+	};
+
+	size_t nrOfActions = std::max( { keyCollection.GetPrimaryBindings().size(), keyCollection.GetSecondaryBindings().size(), keyCollection.GetMouseBindings().size() } );
+	for ( auto& buttonAndAction : gamepadCollection.GetButtonToActionMap() ) {
+		nrOfActions = std::max( nrOfActions, static_cast<size_t>( static_cast<int>( buttonAndAction.second ) ) + 1 );
+	}
+	for ( const Change& change : m_Changes ) {
+		int action = static_cast<int>( change.Action );
+		if ( action >= 0 && action < mc_MaxNrOfActions ) {
+			nrOfActions = std::max( nrOfActions, static_cast<size_t>( action ) + 1 );
+		}
+	}
+
+	primary = keyCollection.GetPrimaryBindings();
+	secondary = keyCollection.GetSecondaryBindings();
+	mouse = keyCollection.GetMouseBindings();
+	primary.resize( nrOfActions, SDL_SCANCODE_UNKNOWN );
+	secondary.resize( nrOfActions, SDL_SCANCODE_UNKNOWN );
+	mouse.resize( nrOfActions );
+	buttons.assign( nrOfActions, SDL_CONTROLLER_BUTTON_INVALID );
+	for ( auto& buttonAndAction : gamepadCollection.GetButtonToActionMap() ) {
+		buttons[static_cast<int>( buttonAndAction.second )] = buttonAndAction.first;
+	}
+
+	// Apply the changes in order, remembering which slots they touched
+	const Uint8	  slotBits[] = { 0x1, 0x2, 0x4, 0x8 };
+	rVector<Uint8> staged( nrOfActions, 0 );
+	for ( const Change& change : m_Changes ) {
+		int action = static_cast<int>( change.Action );
+		if ( action < 0 || action >= mc_MaxNrOfActions ) {
+			reportInvalid( change.Action );
+			continue;
+		}
+		if ( change.Target == Slot::Button ) {
+			if ( change.Value < SDL_CONTROLLER_BUTTON_INVALID || change.Value >= SDL_CONTROLLER_BUTTON_MAX ) {
+				reportInvalid( change.Action );
+				continue;
+			}
+			buttons[action] = static_cast<SDL_GameControllerButton>( change.Value );
+		} else if ( change.Target == Slot::Mouse ) {
+			InputBinding binding = InputBinding::FromValue( static_cast<Uint16>( change.Value ) );
+			if ( binding.IsValid() && binding.GetMouseIndex() < 0 ) {
+				reportInvalid( change.Action );
+				continue;
+			}
+			mouse[action] = binding;
+		} else {
+			if ( change.Value < SDL_SCANCODE_UNKNOWN || change.Value >= SDL_NUM_SCANCODES ) {
+				reportInvalid( change.Action );
+				continue;
+			}
+			( change.Target == Slot::Primary ? primary : secondary )[action] = static_cast<SDL_Scancode>( change.Value );
+		}
+		staged[action] |= slotBits[static_cast<int>( change.Target )];
+	}
+
+	// Claim inputs for staged slots first, so that slots the transaction did not touch are the ones cleared or
+	// reported when they collide with it
+	int keyOwners[SDL_NUM_SCANCODES];
+	int mouseOwners[INPUT_NR_OF_MOUSE_BINDINGS];
+	int buttonOwners[SDL_CONTROLLER_BUTTON_MAX];
+	std::fill( keyOwners, keyOwners + SDL_NUM_SCANCODES, -1 );
+	std::fill( mouseOwners, mouseOwners + INPUT_NR_OF_MOUSE_BINDINGS, -1 );
+	std::fill( buttonOwners, buttonOwners + SDL_CONTROLLER_BUTTON_MAX, -1 );
+	for ( int pass = 0; pass < 2; ++pass ) {
+		bool stagedPass = pass == 0;
+		for ( int action = 0; action < static_cast<int>( nrOfActions ); ++action ) {
+			for ( int slot = 0; slot < 4; ++slot ) {
+				if ( ( ( staged[action] & slotBits[slot] ) != 0 ) != stagedPass ) {
+					continue;
+				}
+				SDL_Scancode* scancode = nullptr;
+				int*		  owner	   = nullptr;
+				switch ( static_cast<Slot>( slot ) ) {
+					case Slot::Primary:
+					case Slot::Secondary:
+						scancode = &( slot == static_cast<int>( Slot::Primary ) ? primary : secondary )[action];
+						owner	 = *scancode != SDL_SCANCODE_UNKNOWN ? &keyOwners[*scancode] : nullptr;
+						break;
+					case Slot::Mouse:
+						owner = mouse[action].IsValid() ? &mouseOwners[mouse[action].GetMouseIndex()] : nullptr;
+						break;
+					case Slot::Button:
+						owner = buttons[action] != SDL_CONTROLLER_BUTTON_INVALID ? &buttonOwners[buttons[action]] : nullptr;
+						break;
+				}
+				if ( owner == nullptr ) {
+					continue;
+				}
+				if ( *owner == -1 ) {
+					*owner = action;
+					continue;
+				}
+				if ( *owner == action ) {
+					// Only the key slots can collide within one action, and one of them is enough
+					secondary[action] = SDL_SCANCODE_UNKNOWN;
+					continue;
+				}
+				ActionIdentifier conflicting = static_cast<ActionIdentifier>( *owner );
+				if ( !stagedPass && clearConflicting ) {
+					if ( scancode != nullptr ) {
+						*scancode = SDL_SCANCODE_UNKNOWN;
+					} else if ( slot == static_cast<int>( Slot::Mouse ) ) {
+						mouse[action] = InputBinding();
+					} else {
+						buttons[action] = SDL_CONTROLLER_BUTTON_INVALID;
+					}
+				} else if ( scancode != nullptr ) {
+					report( BindingConflictType::SharedKey, static_cast<ActionIdentifier>( action ), conflicting, *scancode, InputBinding(), SDL_CONTROLLER_BUTTON_INVALID );
+				} else if ( slot == static_cast<int>( Slot::Mouse ) ) {
+					report( BindingConflictType::SharedMouse, static_cast<ActionIdentifier>( action ), conflicting, SDL_SCANCODE_UNKNOWN, mouse[action],
+							SDL_CONTROLLER_BUTTON_INVALID );
+				} else {
+					report( BindingConflictType::SharedButton, static_cast<ActionIdentifier>( action ), conflicting, SDL_SCANCODE_UNKNOWN, InputBinding(), buttons[action] );
+				}
+			}
+		}
+	}
+	return valid;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <SDL2/SDL_scancode.h>
+#include <SDL2/SDL_gamecontroller.h>
+#include "InputLibraryDefine.h"
+#include "Types.h"
+#include "InputBinding.h"
+
+class BindContext;
+
+enum class BindingConflictType : Uint8 {
+	SharedKey,		// Two slots would be bound to Scancode
+	SharedButton,	// Two actions would be bound to Button
+	SharedMouse,	// Two actions would be bound to Mouse
+	InvalidBinding	// A staged change refers to an action, key or button outside the valid range
+};
+
+struct BindingConflict {
+	BindingConflictType		 Type;
+	ActionIdentifier		 Action;
+	ActionIdentifier		 ConflictingAction;
+	SDL_Scancode			 Scancode;
+	InputBinding			 Mouse;
+	SDL_GameControllerButton Button;
+};
+
+// Binding changes to one bind context, staged and then validated and applied together. Nothing is logged
+// and the live bindings are only touched if every change can be applied:
+//
+//	BindingTransaction transaction = context.BeginTransaction();
+//	transaction.BindKey( ACTION_JUMP, SDL_SCANCODE_SPACE );
+//	transaction.UnbindKey( ACTION_CROUCH, KeyBindingType::Secondary );
+//	if ( !transaction.Commit( true, &conflicts ) ) { ... }
+//
+// Later changes to the same slot replace earlier ones. Changes are applied on top of the bindings the context
+// has when committing, not when the transaction began.
+class BindingTransaction {
+public:
+	INPUT_API explicit BindingTransaction( BindContext& context );
+
+	// KeyBindingType::Any binds the primary slot.
+	INPUT_API void BindKey ( ActionIdentifier action, SDL_Scancode scancode, KeyBindingType slot = KeyBindingType::Primary );
+	INPUT_API void UnbindKey ( ActionIdentifier action, KeyBindingType slot = KeyBindingType::Primary );
+	// A mouse button or wheel direction for the mouse slot.
+	INPUT_API void BindMouse ( ActionIdentifier action, InputBinding binding );
+	INPUT_API void UnbindMouse ( ActionIdentifier action );
+	INPUT_API void BindButton ( ActionIdentifier action, SDL_GameControllerButton button );
+	INPUT_API void UnbindButton ( ActionIdentifier action );
+	INPUT_API void Clear ();
+	INPUT_API int  GetNrOfChanges () const;
+
+	// Checks the staged changes against the current bindings. Conflicts, if any, are appended to conflicts.
+	// With clearConflicting, inputs taken by a staged change are unbound from actions that are not part of the
+	// transaction instead of being reported. An action with the same key in both slots keeps only the primary.
+	INPUT_API bool Validate ( bool clearConflicting = false, pVector<BindingConflict>* conflicts = nullptr ) const;
+	// Validates and, if there are no conflicts, replaces the bindings of the context and clears the staged
+	// changes. Otherwise the context is left as it is.
+	INPUT_API bool Commit ( bool clearConflicting = false, pVector<BindingConflict>* conflicts = nullptr );
+
+private:
+	enum class Slot : Uint8 { Primary, Secondary, Mouse, Button };
+
+	struct Change {
+		ActionIdentifier Action;
+		Slot			 Target;
+		int				 Value;	// Scancode, InputBinding value or button, unknown/empty/invalid to unbind
+	};
+
+	bool Resolve ( bool clearConflicting, pVector<BindingConflict>* conflicts, rVector<SDL_Scancode>& primary,
+				   rVector<SDL_Scancode>& secondary, rVector<InputBinding>& mouse, rVector<SDL_GameControllerButton>& buttons ) const;
+
+	BindContext*	m_Context;
+	pVector<Change> m_Changes;
+
+	static const int mc_MaxNrOfActions = 200;	// Same limit as the binding collections
+};
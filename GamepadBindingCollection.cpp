@@ -1,21 +1,96 @@
 #include "GamepadBindingCollection.h"
 #include "LogInput.h"
+#include "InputNames.h"
 #include <cassert>
 #include "KeyBindings.h"
+#include "BindingIndex.h"
 
-GamepadBindingCollection::GamepadBindingCollection() {
+GamepadBindingCollection::GamepadBindingCollection( const KeyBindings* owner )
+	: m_Owner( owner ) {
+}
+
+GamepadBindingCollection::GamepadBindingCollection( const GamepadBindingCollection& other )
+	: m_Owner( other.m_Owner ), m_ButtonToAction( other.m_ButtonToAction ), m_ActionToButton( other.m_ActionToButton ), m_Revision( other.m_Revision ) {
 }
 
 GamepadBindingCollection::~GamepadBindingCollection() {
+	IndexBindings( false );
+}
+
+GamepadBindingCollection& GamepadBindingCollection::operator = ( const GamepadBindingCollection& other ) {
+	if ( this != &other ) {
+		IndexBindings( false );
+		m_Owner			 = other.m_Owner;
+		m_ButtonToAction = other.m_ButtonToAction;
+		m_ActionToButton = other.m_ActionToButton;
+		++m_Revision;
+		IndexBindings( true );
+	}
+	return *this;
+}
+
+void GamepadBindingCollection::SetOwner( const KeyBindings* owner ) {
+	m_Owner = owner;
+}
+
+void GamepadBindingCollection::SetIndex( BindingIndex* index, BindContextHandle context ) {
+	IndexBindings( false );
+	m_Index		   = index;
+	m_IndexContext = context;
+	IndexBindings( true );
+}
+
+void GamepadBindingCollection::Swap( GamepadBindingCollection& other ) {
+	IndexBindings( false );
+	other.IndexBindings( false );
+	m_ButtonToAction.swap( other.m_ButtonToAction );
+	m_ActionToButton.swap( other.m_ActionToButton );
+	++m_Revision;
+	++other.m_Revision;
+	IndexBindings( true );
+	other.IndexBindings( true );
+}
+
+void GamepadBindingCollection::IndexBindings( bool add ) {
+	if ( m_Index == nullptr ) {
+		return;
+	}
+	for ( size_t i = 0; i < m_ActionToButton.size(); ++i ) {
+		BindingUse use { m_IndexContext, static_cast<ActionIdentifier>( static_cast<int>( i ) ), KeyBindingType::Primary };
+		if ( add ) {
+			m_Index->AddButtonUse( m_ActionToButton[i], use );
+		} else {
+			m_Index->RemoveButtonUse( m_ActionToButton[i], use );
+		}
+	}
+}
+
+void GamepadBindingCollection::Assign( const rVector<SDL_GameControllerButton>& buttons ) {
+	IndexBindings( false );
+	m_ActionToButton = buttons;
+	m_ButtonToAction.clear();
+	for ( size_t action = 0; action < m_ActionToButton.size(); ++action ) {
+		if ( m_ActionToButton[action] != SDL_CONTROLLER_BUTTON_INVALID ) {
+			m_ButtonToAction[m_ActionToButton[action]] = static_cast<ActionIdentifier>( static_cast<int>( action ) );
+		}
+	}
+	++m_Revision;
+	IndexBindings( true );
+}
+
+const char* GamepadBindingCollection::GetDescription( ActionIdentifier action ) const {
+	// Collections made outside a bind context have no owner and describe their actions through the default instance
+	const KeyBindings& owner = m_Owner ? *m_Owner : g_KeyBindings;
+	return static_cast<int>( action ) >= 0 && static_cast<int>( action ) < owner.GetNrOfActions() ? owner.GetDescription( action ) : "";
 }
 
 bool GamepadBindingCollection::AddMappingWithName( const rString& keyName, ActionIdentifier action, bool overwrite, bool clearConflicting,
 												   rString* errorString ) {
-	SDL_GameControllerButton button = SDL_GameControllerGetButtonFromString( keyName.c_str() );
+	SDL_GameControllerButton button = InputNames::GetButtonFromName( keyName.c_str() );
 	if ( button != SDL_CONTROLLER_BUTTON_INVALID ) {
 		return AddMappingWithButton( button, action, overwrite, clearConflicting, errorString );
 	} else {
-		LogInput( "Failed to get scancode from name: " + keyName, "GamepadBindings", LogSeverity::WARNING_MSG );
+		INPUT_LOG( LogSeverity::WARNING_MSG, "GamepadBindings", "Failed to get scancode from name: " + keyName );
 		if ( errorString != nullptr ) {
 			*errorString = "Failed to get scancode from name: " + keyName;
 		}
@@ -29,35 +104,32 @@ bool GamepadBindingCollection::AddMappingWithButton( SDL_GameControllerButton bu
 	auto buttonIt = m_ButtonToAction.find( button );
 	// Warn about overwriting duplicate gamepad bindings
 	if ( buttonIt != m_ButtonToAction.end() && !clearConflicting ) {
-		LogInput( "Can't bind button: \"" + rString( SDL_GameControllerGetStringForButton( button ) ) + "\" to action " +
-				  g_KeyBindings.GetDescription( action ) + " because it is already bound to action \"" +
-				  g_KeyBindings.GetDescription( buttonIt->second ) + "\"",
-				  "KeyBindings", LogSeverity::WARNING_MSG );
+		INPUT_LOG( LogSeverity::WARNING_MSG, "KeyBindings", "Can't bind button: \"" + rString( InputNames::GetButtonName( button ) ) + "\" to action " +
+				  GetDescription( action ) + " because it is already bound to action \"" +
+				  GetDescription( buttonIt->second ) + "\"" );
 		if ( errorString != nullptr ) {
-			*errorString = "Can't bind key: \"" + rString( SDL_GameControllerGetStringForButton( button ) ) + "\" to action " +
-						   g_KeyBindings.GetDescription( action ) + " because it is already bound to action \"" +
-						   g_KeyBindings.GetDescription( buttonIt->second ) + "\"";
+			*errorString = "Can't bind key: \"" + rString( InputNames::GetButtonName( button ) ) + "\" to action " +
+						   GetDescription( action ) + " because it is already bound to action \"" +
+						   GetDescription( buttonIt->second ) + "\"";
 		}
 		return false;
 	} else {
 		if ( BindAction( action, button, overwrite ) ) {
 			// Bound button
-			LogInput( "Bound button \"" + rString( SDL_GameControllerGetStringForButton( button ) ) + "\" to action \"" +
-					  g_KeyBindings.GetDescription( action ) + "\"",
-					  "KeyBindings", LogSeverity::DEBUG_MSG );
+			INPUT_LOG( LogSeverity::DEBUG_MSG, "KeyBindings", "Bound button \"" + rString( InputNames::GetButtonName( button ) ) + "\" to action \"" +
+					  GetDescription( action ) + "\"" );
 			if ( errorString != nullptr ) {
-				*errorString = "Bound button \"" + rString( SDL_GameControllerGetStringForButton( button ) ) + "\" to action \"" +
-							   g_KeyBindings.GetDescription( action ) + "\"";
+				*errorString = "Bound button \"" + rString( InputNames::GetButtonName( button ) ) + "\" to action \"" +
+							   GetDescription( action ) + "\"";
 			}
 			return true;
 		} else {
 			// Failed to bind button
-			LogInput( "Can't bind button: \"" + rString( SDL_GameControllerGetStringForButton( button ) ) + "\" to action \"" +
-					  g_KeyBindings.GetDescription( action ) + "\" because no free bind slots are avaliable",
-					  "KeyBindings", LogSeverity::WARNING_MSG );
+			INPUT_LOG( LogSeverity::WARNING_MSG, "KeyBindings", "Can't bind button: \"" + rString( InputNames::GetButtonName( button ) ) + "\" to action \"" +
+					  GetDescription( action ) + "\" because no free bind slots are avaliable" );
 			if ( errorString != nullptr ) {
-				*errorString = "Can't bind button: \"" + rString( SDL_GameControllerGetStringForButton( button ) ) + "\" to action \"" +
-							   g_KeyBindings.GetDescription( action ) + "\" because no free bind slots are avaliable";
+				*errorString = "Can't bind button: \"" + rString( InputNames::GetButtonName( button ) ) + "\" to action \"" +
+							   GetDescription( action ) + "\" because no free bind slots are avaliable";
 			}
 			return false;
 		}
@@ -77,6 +149,9 @@ bool GamepadBindingCollection::BindAction( ActionIdentifier action, SDL_GameCont
 	auto freePrevious = [this, action, button]() {
 		SDL_GameControllerButton prevButton = m_ActionToButton[static_cast<int>( action )];
 		if ( prevButton != SDL_CONTROLLER_BUTTON_INVALID ) {
+			if ( m_Index ) {
+				m_Index->RemoveButtonUse( prevButton, BindingUse { m_IndexContext, action, KeyBindingType::Primary } );
+			}
 			auto it = m_ButtonToAction.find( prevButton );
 			if ( it != m_ButtonToAction.end() ) {
 				m_ButtonToAction.erase( it );
@@ -87,6 +162,10 @@ bool GamepadBindingCollection::BindAction( ActionIdentifier action, SDL_GameCont
 		freePrevious();
 		m_ActionToButton.at( static_cast<int>( action ) ) = button;
 		m_ButtonToAction[button] = action;
+		if ( m_Index ) {
+			m_Index->AddButtonUse( button, BindingUse { m_IndexContext, action, KeyBindingType::Primary } );
+		}
+		++m_Revision;
 	};
 
 	if ( overwrite ) {
@@ -104,9 +183,25 @@ bool GamepadBindingCollection::BindAction( ActionIdentifier action, SDL_GameCont
 	}
 }
 
+const rMap<SDL_GameControllerButton, ActionIdentifier>& GamepadBindingCollection::GetButtonToActionMap() const {
+	return m_ButtonToAction;
+}
+
+Uint32 GamepadBindingCollection::GetRevision() const {
+	return m_Revision;
+}
+
 SDL_GameControllerButton GamepadBindingCollection::GetButtonFromAction( ActionIdentifier action ) const {
 	if ( static_cast<size_t>( static_cast<int>( action ) ) >= m_ActionToButton.size( ) ) {
 		return SDL_CONTROLLER_BUTTON_INVALID;
 	}
 	return m_ActionToButton.at( static_cast<int>( action ) );
 }
+
+ActionIdentifier GamepadBindingCollection::GetActionFromButton( SDL_GameControllerButton button ) const {
+	auto it = m_ButtonToAction.find( button );
+	if ( it != m_ButtonToAction.end() ) {
+		return it->second;
+	}
+	return ActionIdentifier();
+}
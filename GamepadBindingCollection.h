@@ -3,10 +3,17 @@
 #include "InputLibraryDefine.h"
 #include "Types.h"
 
+class KeyBindings;
+class BindingIndex;
+
 class GamepadBindingCollection {
 public:
-	INPUT_API GamepadBindingCollection();
+	// Action descriptions used in log messages are looked up in owner, or in the default KeyBindings if null.
+	INPUT_API GamepadBindingCollection( const KeyBindings* owner = nullptr );
+	// Copies are not registered with the index of the original.
+	INPUT_API GamepadBindingCollection( const GamepadBindingCollection& other );
 	INPUT_API ~GamepadBindingCollection();
+	INPUT_API GamepadBindingCollection& operator = ( const GamepadBindingCollection& other );
 
 	INPUT_API bool AddMappingWithName( const rString& keyName, ActionIdentifier action, bool overwrite = false,
 									   bool clearConflicting = false, rString* errorString = nullptr );
@@ -16,13 +23,33 @@ public:
 
 	INPUT_API bool BindAction( ActionIdentifier action, SDL_GameControllerButton button, bool overwrite );
 
+	INPUT_API const rMap<SDL_GameControllerButton, ActionIdentifier>& GetButtonToActionMap() const;
+	// Incremented whenever a binding changes.
+	INPUT_API Uint32 GetRevision() const;
+
 	INPUT_API SDL_GameControllerButton GetButtonFromAction( ActionIdentifier action ) const;
+	INPUT_API ActionIdentifier		   GetActionFromButton( SDL_GameControllerButton button ) const;
+
+	INPUT_API void SetOwner( const KeyBindings* owner );
+	// Keeps index up to date with the bindings of this collection as those of context. Null to stop.
+	INPUT_API void SetIndex( BindingIndex* index, BindContextHandle context );
+	// Exchanges bindings with other without copying. Owners are kept.
+	INPUT_API void Swap( GamepadBindingCollection& other );
+	// Replaces all bindings with the given per action buttons. Buttons must not repeat.
+	INPUT_API void Assign( const rVector<SDL_GameControllerButton>& buttons );
 
 private:
-	void FillTheVoid( ActionIdentifier action );
+	void		   FillTheVoid( ActionIdentifier action );
+	const char*	   GetDescription( ActionIdentifier action ) const;
+	void		   IndexBindings( bool add );
+
+	const KeyBindings* m_Owner;
+	BindingIndex*	   m_Index = nullptr;
+	BindContextHandle  m_IndexContext;
 
 	rMap<SDL_GameControllerButton, ActionIdentifier> m_ButtonToAction;
 	rVector<SDL_GameControllerButton> m_ActionToButton;
+	Uint32 m_Revision = 0;
 
 	static const size_t mc_OverflowLimit = 200;
 };
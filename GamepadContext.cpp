@@ -2,7 +2,11 @@
 #include "InputState.h"
 #include "GamepadState.h"
 
-GamepadContext::GamepadContext( ) { }
+GamepadContext::GamepadContext( )
+	: m_InputState( &g_InputState ) { }
+
+GamepadContext::GamepadContext( InputState& inputState )
+	: m_InputState( &inputState ) { }
 
 void GamepadContext::Initialize( int gamepadIndex ) {
 	m_GamepadIndex = gamepadIndex;
@@ -13,20 +17,37 @@ void GamepadContext::Deinitialize( ) {
 }
 
 void GamepadContext::Update() {
-	m_PressStack.clear();
-	m_ReleaseStack.clear();
+	if ( m_TickWindowUsed ) {
+		m_PressStack.RetainFrom( m_TickWindowEnd );
+		m_ReleaseStack.RetainFrom( m_TickWindowEnd );
+	} else {
+		m_PressStack.Clear();
+		m_ReleaseStack.Clear();
+	}
+	m_TickWindow	 = InputTickWindow();
+	m_TickWindowUsed = false;
+}
+
+void GamepadContext::SetTickWindow( const InputTickWindow& window ) {
+	m_TickWindow	 = window;
+	m_TickWindowUsed = window.Active;	// Cleared, nothing is carried over
+	if ( window.Active ) {
+		m_TickWindowEnd = window.EndTicks;
+	}
 }
 
 bool GamepadContext::HandleEvent( const SDL_Event& event ) {
 	switch ( event.type ) {
 		case SDL_CONTROLLERBUTTONDOWN: {
 			if ( event.cbutton.which == m_GamepadIndex ) {
-				m_PressStack.push_back( event.cbutton.button );
+				m_PressStack.Push( event.cbutton.button, m_InputState->GetEventTime(), ++m_EdgeSequence );
+				return true;
 			}
 		} break;
 		case SDL_CONTROLLERBUTTONUP: {
 			if ( event.cbutton.which == m_GamepadIndex ) {
-				m_ReleaseStack.push_back( event.cbutton.button );
+				m_ReleaseStack.Push( event.cbutton.button, m_InputState->GetEventTime(), ++m_EdgeSequence );
+				return true;
 			}
 		} break;
 	}
@@ -34,25 +55,21 @@ bool GamepadContext::HandleEvent( const SDL_Event& event ) {
 }
 
 bool GamepadContext::ButtonUpDown( SDL_GameControllerButton button ) const {
-	for ( auto& pressed : m_PressStack ) {
-		if ( pressed == button ) {
-			return true;
-		}
-	}
-	return false;
+	return m_PressStack.Find( static_cast<Uint8>( button ), m_TickWindow ) != -1;
 }
 
 bool GamepadContext::ButtonDownUp( SDL_GameControllerButton button ) const {
-	for ( auto& pressed : m_ReleaseStack ) {
-		if ( pressed == button ) {
-			return true;
-		}
-	}
-	return false;
+	return m_ReleaseStack.Find( static_cast<Uint8>( button ), m_TickWindow ) != -1;
 }
 
 bool GamepadContext::ButtonDown( SDL_GameControllerButton button ) const {
-	const GamepadState* state = g_InputState.GetGamepadState( m_GamepadIndex );
+	if ( m_TickWindow.Active ) {
+		INPUT_STATE stateAtBegin = InputEdgeStateAt( m_PressStack, m_ReleaseStack, static_cast<Uint8>( button ), m_TickWindow.BeginTicks );
+		if ( stateAtBegin != INPUT_STATE_IGNORE ) {
+			return stateAtBegin == INPUT_STATE_DOWN || ButtonUpDown( button );
+		}
+	}
+	const GamepadState* state = m_InputState->GetGamepadState( m_GamepadIndex );
 
 	if ( state ) {
 		return state->ButtonDown( button );
@@ -62,7 +79,13 @@ bool GamepadContext::ButtonDown( SDL_GameControllerButton button ) const {
 }
 
 bool GamepadContext::ButtonUp( SDL_GameControllerButton button ) const {
-	const GamepadState* state = g_InputState.GetGamepadState( m_GamepadIndex );
+	if ( m_TickWindow.Active ) {
+		INPUT_STATE stateAtBegin = InputEdgeStateAt( m_PressStack, m_ReleaseStack, static_cast<Uint8>( button ), m_TickWindow.BeginTicks );
+		if ( stateAtBegin != INPUT_STATE_IGNORE ) {
+			return stateAtBegin == INPUT_STATE_UP || ButtonDownUp( button );
+		}
+	}
+	const GamepadState* state = m_InputState->GetGamepadState( m_GamepadIndex );
 
 	if ( state ) {
 		return state->ButtonUp( button );
@@ -71,3 +94,23 @@ bool GamepadContext::ButtonUp( SDL_GameControllerButton button ) const {
 	}
 }
 
+const InputEdgeStack<Uint8>& GamepadContext::GetEdgeStack( bool press ) const {
+	return press ? m_PressStack : m_ReleaseStack;
+}
+
+bool GamepadContext::ButtonUpDownConsume( SDL_GameControllerButton button ) {
+	return Consume( m_PressStack, button );
+}
+
+bool GamepadContext::ButtonDownUpConsume( SDL_GameControllerButton button ) {
+	return Consume( m_ReleaseStack, button );
+}
+
+bool GamepadContext::Consume( InputEdgeStack<Uint8>& stack, SDL_GameControllerButton button ) {
+	int index = stack.Find( static_cast<Uint8>( button ), m_TickWindow );
+	if ( index == -1 ) {
+		return false;
+	}
+	stack.Consume( index );
+	return true;
+}
@@ -3,27 +3,47 @@
 #include <SDL2/SDL_events.h>
 #include INPUT_ALLOCATION_HEADER
 #include "InputLibraryDefine.h"
+#include "InputEdgeStack.h"
+
+class InputState;
 
 class GamepadContext {
 public:
 	INPUT_API GamepadContext( );
+	INPUT_API explicit GamepadContext( InputState& inputState );
 
 	INPUT_API void Initialize( int gamepadIndex );
 	INPUT_API void Deinitialize( );
 	INPUT_API void Update( );
 
+	// Returns true if the event was an edge for this gamepad.
 	INPUT_API bool HandleEvent ( const SDL_Event& event );
+	// Set through InputContext::SetTickWindow and ClearTickWindow.
+	INPUT_API void SetTickWindow ( const InputTickWindow& window );
 
 	INPUT_API bool ButtonUpDown ( SDL_GameControllerButton button ) const;
 	INPUT_API bool ButtonDownUp ( SDL_GameControllerButton button ) const;
+	// Marks the first press (or release) of button as consumed if there was one.
+	INPUT_API bool ButtonUpDownConsume ( SDL_GameControllerButton button );
+	INPUT_API bool ButtonDownUpConsume ( SDL_GameControllerButton button );
 	INPUT_API bool ButtonDown ( SDL_GameControllerButton button ) const;
 	INPUT_API bool ButtonUp ( SDL_GameControllerButton button ) const;
 
+	INPUT_API const InputEdgeStack<Uint8>& GetEdgeStack ( bool press ) const;
+
 private:
 	const int INVALID_GAMEPAD_INDEX = -1;
 
-	pVector<Uint8> m_PressStack;
-	pVector<Uint8> m_ReleaseStack;
+	bool Consume ( InputEdgeStack<Uint8>& stack, SDL_GameControllerButton button );
+
+	InputState*			  m_InputState;
+	InputEdgeStack<Uint8> m_PressStack;
+	InputEdgeStack<Uint8> m_ReleaseStack;
+	Uint32				  m_EdgeSequence = 0;
 	int m_GamepadIndex = INVALID_GAMEPAD_INDEX;
+
+	InputTickWindow m_TickWindow;
+	bool			m_TickWindowUsed = false;
+	Uint32			m_TickWindowEnd	 = 0;
 };
 
@@ -15,6 +15,10 @@ GamepadState::~GamepadState() {
 
 void GamepadState::Update() {
 	if ( m_TrackGamepadState ) {
+		// Virtual gamepads only change through SetState
+		if ( IsVirtual() ) {
+			return;
+		}
 		// Only update if controller is attached
 		if ( SDL_GameControllerGetAttached( m_Controller ) == SDL_TRUE ) {
 			// Reset mask to no buttons being down
@@ -35,7 +39,7 @@ void GamepadState::Update() {
 			m_RightTrigger = SDL_GameControllerGetAxis( m_Controller, SDL_CONTROLLER_AXIS_TRIGGERRIGHT ) * GAMEPAD_AXIS_FACTOR;
 
 			if ( m_Connected == false ) {
-				LogInput( string( SDL_GameControllerName( m_Controller ) ) + " connected", "GamepadState", LogSeverity::INFO_MSG );
+				INPUT_LOG( LogSeverity::INFO_MSG, "GamepadState", string( SDL_GameControllerName( m_Controller ) ) + " connected" );
 				m_Connected = true;
 			}
 		} else {
@@ -46,10 +50,31 @@ void GamepadState::Update() {
 	}
 }
 
+void GamepadState::SetState( Uint32 buttonsMask, const float* axes ) {
+	if ( !m_TrackGamepadState ) {
+		return;
+	}
+	m_ButtonsMask  = buttonsMask;
+	m_RightStickX  = axes[SDL_CONTROLLER_AXIS_RIGHTX];
+	m_RightStickY  = axes[SDL_CONTROLLER_AXIS_RIGHTY];
+	m_LeftStickX   = axes[SDL_CONTROLLER_AXIS_LEFTX];
+	m_LeftStickY   = axes[SDL_CONTROLLER_AXIS_LEFTY];
+	m_LeftTrigger  = axes[SDL_CONTROLLER_AXIS_TRIGGERLEFT];
+	m_RightTrigger = axes[SDL_CONTROLLER_AXIS_TRIGGERRIGHT];
+	m_Connected	   = true;
+}
+
 string GamepadState::GetName() const {
+	if ( IsVirtual() ) {
+		return "Virtual gamepad";
+	}
 	return string( SDL_GameControllerName( m_Controller ) );
 }
 
+bool GamepadState::IsVirtual() const {
+	return m_Controller == nullptr;
+}
+
 bool GamepadState::ButtonDown( SDL_GameControllerButton button ) const {
 	// Check the bit corresponding to the specified button
 	return ( m_ButtonsMask         & ( 1 << button ) ) != 0;
@@ -61,6 +86,10 @@ bool GamepadState::ButtonUp( SDL_GameControllerButton button ) const {
 	return !( m_ButtonsMask     & ( 1 << button ) );
 }
 
+Uint32 GamepadState::GetButtonMask() const {
+	return m_ButtonsMask;
+}
+
 void GamepadState::ActivateStateTracking() {
 	m_TrackGamepadState = true;
 }
@@ -6,15 +6,19 @@
 
 class GamepadState {
 public:
+	// A null controller makes a virtual gamepad whose state is only changed through SetState.
 	GamepadState( SDL_GameController* controller );
 	~GamepadState();
 
 	void Update ();
+	void SetState ( Uint32 buttonsMask, const float* axes );
 
 	INPUT_API std::string GetName () const;
+	INPUT_API bool		  IsVirtual () const;
 
 	INPUT_API bool ButtonDown ( SDL_GameControllerButton button ) const;
 	INPUT_API bool ButtonUp ( SDL_GameControllerButton button ) const;
+	INPUT_API Uint32 GetButtonMask () const;
 
 	INPUT_API void ActivateStateTracking ();
 	INPUT_API void DeactivateStateTracking ();
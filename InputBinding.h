@@ -0,0 +1,92 @@
+#pragma once
+
+#include <SDL2/SDL_scancode.h>
+#include <SDL2/SDL_gamecontroller.h>
+#include "Types.h"
+
+enum class InputDevice : Uint8 {
+	None,
+	Key,
+	MouseButton,
+	MouseWheel,
+	GamepadButton
+};
+
+#define INPUT_NR_OF_MOUSE_BINDINGS ( MOUSE_BUTTON_5 + 4 )
+
+// Any single input an action can be bound to, packed in 16 bits with the device in the top four.
+// Unknown scancodes and invalid buttons make an empty binding.
+class InputBinding {
+public:
+	constexpr InputBinding() : m_Value( 0 ) { }
+
+	static constexpr InputBinding Key( SDL_Scancode scancode ) {
+		return scancode > SDL_SCANCODE_UNKNOWN && scancode < SDL_NUM_SCANCODES ? InputBinding( InputDevice::Key, scancode ) : InputBinding();
+	}
+	static constexpr InputBinding Mouse( MOUSE_BUTTON button ) {
+		return button >= MOUSE_BUTTON_LEFT && button <= MOUSE_BUTTON_5 ? InputBinding( InputDevice::MouseButton, button ) : InputBinding();
+	}
+	static constexpr InputBinding Wheel( MOUSE_WHEEL wheel ) {
+		return wheel <= MOUSE_WHEEL_RIGHT ? InputBinding( InputDevice::MouseWheel, wheel ) : InputBinding();
+	}
+	static constexpr InputBinding Button( SDL_GameControllerButton button ) {
+		return button > SDL_CONTROLLER_BUTTON_INVALID && button < SDL_CONTROLLER_BUTTON_MAX ? InputBinding( InputDevice::GamepadButton, button ) : InputBinding();
+	}
+	// Inverse of GetMouseIndex.
+	static constexpr InputBinding FromMouseIndex( int index ) {
+		return index >= 0 && index < MOUSE_BUTTON_5 ? Mouse( static_cast<MOUSE_BUTTON>( MOUSE_BUTTON_LEFT + index ) )
+			   : index >= MOUSE_BUTTON_5 && index < INPUT_NR_OF_MOUSE_BINDINGS ? Wheel( static_cast<MOUSE_WHEEL>( index - MOUSE_BUTTON_5 ) ) : InputBinding();
+	}
+	// For storage, see GetValue.
+	static constexpr InputBinding FromValue( Uint16 value ) {
+		return InputBinding( value );
+	}
+
+	constexpr InputDevice GetDevice() const {
+		return static_cast<InputDevice>( m_Value >> 12 );
+	}
+	constexpr int GetCode() const {
+		return m_Value & 0x0FFF;
+	}
+	constexpr Uint16 GetValue() const {
+		return m_Value;
+	}
+	constexpr bool IsValid() const {
+		return m_Value != 0;
+	}
+	constexpr bool IsMouse() const {
+		return GetDevice() == InputDevice::MouseButton || GetDevice() == InputDevice::MouseWheel;
+	}
+
+	constexpr SDL_Scancode GetScancode() const {
+		return GetDevice() == InputDevice::Key ? static_cast<SDL_Scancode>( GetCode() ) : SDL_SCANCODE_UNKNOWN;
+	}
+	// Only meaningful for mouse button and wheel bindings.
+	constexpr MOUSE_BUTTON GetMouseButton() const {
+		return static_cast<MOUSE_BUTTON>( GetCode() );
+	}
+	constexpr MOUSE_WHEEL GetMouseWheel() const {
+		return static_cast<MOUSE_WHEEL>( GetCode() );
+	}
+	// Mouse buttons followed by wheel directions, for tables of INPUT_NR_OF_MOUSE_BINDINGS entries. -1 for other devices.
+	constexpr int GetMouseIndex() const {
+		return GetDevice() == InputDevice::MouseButton && GetCode() >= MOUSE_BUTTON_LEFT && GetCode() <= MOUSE_BUTTON_5 ? GetCode() - MOUSE_BUTTON_LEFT
+			   : GetDevice() == InputDevice::MouseWheel && GetCode() <= MOUSE_WHEEL_RIGHT ? MOUSE_BUTTON_5 + GetCode() : -1;
+	}
+	constexpr SDL_GameControllerButton GetButton() const {
+		return GetDevice() == InputDevice::GamepadButton ? static_cast<SDL_GameControllerButton>( GetCode() ) : SDL_CONTROLLER_BUTTON_INVALID;
+	}
+
+	constexpr bool operator == ( InputBinding rhs ) const {
+		return m_Value == rhs.m_Value;
+	}
+	constexpr bool operator != ( InputBinding rhs ) const {
+		return m_Value != rhs.m_Value;
+	}
+
+private:
+	constexpr InputBinding( InputDevice device, int code ) : m_Value( static_cast<Uint16>( static_cast<int>( device ) << 12 | code ) ) { }
+	explicit constexpr InputBinding( Uint16 value ) : m_Value( value ) { }
+
+	Uint16 m_Value;
+};
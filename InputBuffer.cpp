@@ -0,0 +1,154 @@
+#include "InputBuffer.h"
+#include <algorithm>
+#include "InputContext.h"
+#include "GamepadContext.h"
+#include "KeyBindings.h"
+
+#define INPUT_BUFFER_NR_OF_DEVICES ( INPUT_MAX_NR_OF_GAMEPADS + 1 )
+
+InputBuffer::InputBuffer( int capacity )
+	: m_Capacity( std::max( capacity, 1 ) ) {
+	m_Edges.resize( m_Capacity * INPUT_BUFFER_NR_OF_DEVICES );
+	m_Heads.resize( INPUT_BUFFER_NR_OF_DEVICES, 0 );
+	m_Sizes.resize( INPUT_BUFFER_NR_OF_DEVICES, 0 );
+	m_NewestSequences.resize( INPUT_BUFFER_NR_OF_DEVICES, 0 );
+	m_HasNewest.resize( INPUT_BUFFER_NR_OF_DEVICES, 0 );
+}
+
+void InputBuffer::Capture( const KeyBindings& keyBindings, BindContextHandle bindContextHandle, const InputContext& input, Uint32 ticks ) {
+	m_Ticks = ticks;
+	for ( int device = 0; device < INPUT_BUFFER_NR_OF_DEVICES; ++device ) {
+		INPUT_TYPE inputType = static_cast<INPUT_TYPE>( device - 1 );
+		// Edges retained by a tick window are seen again next frame, so only those with a newer sequence number are taken
+		bool   hasNewest = m_HasNewest[device] != 0;
+		Uint32 newest	 = m_NewestSequences[device];
+		auto isNew = [this, device, hasNewest, newest]( Uint32 sequence, bool consumed ) {
+			if ( hasNewest && static_cast<Sint32>( sequence - newest ) <= 0 ) {
+				return false;
+			}
+			if ( !m_HasNewest[device] || static_cast<Sint32>( sequence - m_NewestSequences[device] ) > 0 ) {
+				m_NewestSequences[device] = sequence;
+				m_HasNewest[device]		  = 1;
+			}
+			return !consumed;
+		};
+		m_Frame.clear();
+		for ( bool press : { true, false } ) {
+			if ( inputType == INPUT_TYPE_KEYBOARD ) {
+				const InputEdgeStack<SDL_Scancode>& stack = input.GetKeyboardEdgeStack( press );
+				for ( int i = 0; i < static_cast<int>( stack.Size() ); ++i ) {
+					if ( isNew( stack.GetSequence( i ), stack.IsConsumed( i ) ) ) {
+						ActionIdentifier action = keyBindings.GetActiveActionFromScancode( bindContextHandle, stack.GetCodes()[i] );
+						if ( action != ActionIdentifier() ) {
+							m_Frame.push_back( BufferedEdge { stack.GetTime( i ).GetTicks(), stack.GetSequence( i ), action, press, false } );
+						}
+					}
+				}
+				// The mouse is part of the keyboard device
+				const InputEdgeStack<MOUSE_BUTTON>& mouseStack = input.GetMouseEdgeStack( press );
+				for ( int i = 0; i < static_cast<int>( mouseStack.Size() ); ++i ) {
+					if ( isNew( mouseStack.GetSequence( i ), mouseStack.IsConsumed( i ) ) ) {
+						ActionIdentifier action = keyBindings.GetActiveActionFromMouseBinding( bindContextHandle, InputBinding::Mouse( mouseStack.GetCodes()[i] ) );
+						if ( action != ActionIdentifier() ) {
+							m_Frame.push_back( BufferedEdge { mouseStack.GetTime( i ).GetTicks(), mouseStack.GetSequence( i ), action, press, false } );
+						}
+					}
+				}
+			} else {
+				const InputEdgeStack<Uint8>& stack = input.GetGamepadContext( static_cast<unsigned int>( inputType ) ).GetEdgeStack( press );
+				for ( int i = 0; i < static_cast<int>( stack.Size() ); ++i ) {
+					if ( isNew( stack.GetSequence( i ), stack.IsConsumed( i ) ) ) {
+						ActionIdentifier action = keyBindings.GetActiveActionFromButton( bindContextHandle, static_cast<SDL_GameControllerButton>( stack.GetCodes()[i] ), inputType );
+						if ( action != ActionIdentifier() ) {
+							m_Frame.push_back( BufferedEdge { stack.GetTime( i ).GetTicks(), stack.GetSequence( i ), action, press, false } );
+						}
+					}
+				}
+			}
+		}
+		std::stable_sort( m_Frame.begin(), m_Frame.end(), []( const BufferedEdge& lhs, const BufferedEdge& rhs ) {
+			return static_cast<Sint32>( lhs.Sequence - rhs.Sequence ) < 0;
+		} );
+
+		// Wheel bindings are pressed and released within a frame that scrolled, so they are stamped with the capture
+		if ( inputType == INPUT_TYPE_KEYBOARD ) {
+			for ( int wheel = MOUSE_WHEEL_UP; wheel <= MOUSE_WHEEL_RIGHT; ++wheel ) {
+				ActionIdentifier action = keyBindings.GetActiveActionFromMouseBinding( bindContextHandle, InputBinding::Wheel( static_cast<MOUSE_WHEEL>( wheel ) ) );
+				if ( action != ActionIdentifier() && input.MouseWheelScrolled( static_cast<MOUSE_WHEEL>( wheel ) ) ) {
+					m_Frame.push_back( BufferedEdge { ticks, 0, action, true, false } );
+					m_Frame.push_back( BufferedEdge { ticks, 0, action, false, false } );
+				}
+			}
+		}
+		for ( const BufferedEdge& edge : m_Frame ) {
+			Push( device, edge );
+		}
+	}
+}
+
+void InputBuffer::Clear() {
+	std::fill( m_Heads.begin(), m_Heads.end(), 0 );
+	std::fill( m_Sizes.begin(), m_Sizes.end(), 0 );
+}
+
+bool InputBuffer::ActionPressedWithin( ActionIdentifier action, Uint32 milliseconds, INPUT_TYPE inputType ) const {
+	return Find( action, milliseconds, inputType, true ) != -1;
+}
+
+bool InputBuffer::ActionReleasedWithin( ActionIdentifier action, Uint32 milliseconds, INPUT_TYPE inputType ) const {
+	return Find( action, milliseconds, inputType, false ) != -1;
+}
+
+bool InputBuffer::ConsumeBuffered( ActionIdentifier action, Uint32 milliseconds, INPUT_TYPE inputType ) {
+	int slot = Find( action, milliseconds, inputType, true );
+	if ( slot == -1 ) {
+		return false;
+	}
+	m_Edges[slot].Consumed = true;
+	return true;
+}
+
+Uint32 InputBuffer::GetTicks() const {
+	return m_Ticks;
+}
+
+int InputBuffer::GetCapacity() const {
+	return m_Capacity;
+}
+
+void InputBuffer::Push( int device, const BufferedEdge& edge ) {
+	m_Edges[device * m_Capacity + m_Heads[device]] = edge;
+	m_Heads[device] = ( m_Heads[device] + 1 ) % m_Capacity;
+	m_Sizes[device] = std::min( m_Sizes[device] + 1, m_Capacity );
+}
+
+int InputBuffer::Find( ActionIdentifier action, Uint32 milliseconds, INPUT_TYPE inputType, bool press ) const {
+	if ( inputType != INPUT_TYPE_ANY ) {
+		int device = static_cast<int>( inputType ) + 1;
+		return device >= 0 && device < INPUT_BUFFER_NR_OF_DEVICES ? FindInDevice( device, action, milliseconds, press ) : -1;
+	}
+	// Newest match over all devices
+	int found = -1;
+	for ( int device = 0; device < INPUT_BUFFER_NR_OF_DEVICES; ++device ) {
+		int slot = FindInDevice( device, action, milliseconds, press );
+		if ( slot != -1 && ( found == -1 || static_cast<Sint32>( m_Edges[slot].Ticks - m_Edges[found].Ticks ) > 0 ) ) {
+			found = slot;
+		}
+	}
+	return found;
+}
+
+int InputBuffer::FindInDevice( int device, ActionIdentifier action, Uint32 milliseconds, bool press ) const {
+	for ( int i = 1; i <= m_Sizes[device]; ++i ) {
+		int					slot = device * m_Capacity + ( m_Heads[device] + m_Capacity - i ) % m_Capacity;
+		const BufferedEdge& edge = m_Edges[slot];
+		Sint32				age	 = static_cast<Sint32>( m_Ticks - edge.Ticks );
+		if ( age > static_cast<Sint32>( milliseconds ) ) {
+			return -1;
+		}
+		if ( edge.Action == action && edge.Press == press && !edge.Consumed ) {
+			return slot;
+		}
+	}
+	return -1;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include INPUT_ALLOCATION_HEADER
+#include "InputLibraryDefine.h"
+#include "Types.h"
+
+class InputContext;
+class KeyBindings;
+
+// Timestamped action edges of the last frames, one ring buffer per device (the keyboard with the mouse and every gamepad),
+// so an action pressed shortly before it could be acted upon still counts. Captured once per frame after
+// the frame's events are handled. Queries walk a device's ring from the newest edge and stop at the first
+// one outside the window, so they cost the number of edges in the window regardless of the number of actions.
+class InputBuffer {
+public:
+	// capacity is the number of edges kept per device; older edges are overwritten.
+	INPUT_API explicit InputBuffer( int capacity = 32 );
+
+	// Appends this frame's unconsumed key, mouse and gamepad button edges of the actions bound in the bind context,
+	// leaving out bindings the bind context stack hides. ticks is the time queries measure from.
+	INPUT_API void Capture ( const KeyBindings& keyBindings, BindContextHandle bindContextHandle, const InputContext& input, Uint32 ticks );
+	INPUT_API void Clear ();
+
+	// True if action was pressed (released) no longer than milliseconds before the last capture and the press was not consumed.
+	INPUT_API bool ActionPressedWithin ( ActionIdentifier action, Uint32 milliseconds, INPUT_TYPE inputType = INPUT_TYPE_ANY ) const;
+	INPUT_API bool ActionReleasedWithin ( ActionIdentifier action, Uint32 milliseconds, INPUT_TYPE inputType = INPUT_TYPE_ANY ) const;
+	// Marks the newest such press so it is not acted upon twice. Returns false if there was none.
+	INPUT_API bool ConsumeBuffered ( ActionIdentifier action, Uint32 milliseconds, INPUT_TYPE inputType = INPUT_TYPE_ANY );
+
+	INPUT_API Uint32 GetTicks () const;
+	INPUT_API int	 GetCapacity () const;
+
+private:
+	struct BufferedEdge {
+		Uint32			 Ticks;
+		Uint32			 Sequence;	// Of the input edge, orders edges of the same millisecond
+		ActionIdentifier Action;
+		bool			 Press;
+		bool			 Consumed;
+	};
+
+	void Push ( int device, const BufferedEdge& edge );
+	// Returns the slot of the newest unconsumed matching edge or -1.
+	int	 Find ( ActionIdentifier action, Uint32 milliseconds, INPUT_TYPE inputType, bool press ) const;
+	int	 FindInDevice ( int device, ActionIdentifier action, Uint32 milliseconds, bool press ) const;
+
+	int	   m_Capacity;
+	Uint32 m_Ticks = 0;
+
+	pVector<BufferedEdge> m_Edges;	// INPUT_MAX_NR_OF_GAMEPADS + 1 rings of m_Capacity, keyboard first
+	pVector<int>		  m_Heads;	// Slot the next edge of each device is written to
+	pVector<int>		  m_Sizes;
+	pVector<Uint32>		  m_NewestSequences;	// Newest input edge seen per device
+	pVector<Uint8>		  m_HasNewest;
+	pVector<BufferedEdge> m_Frame;	// Edges of the device being captured, sorted before they are pushed
+};
@@ -1,226 +1,244 @@
 #include "InputContext.h"
 #include "InputState.h"
+#include "InputBinding.h"
 #include <iostream>
 
+namespace {
+	// Whether an entry copied before a callback pass is still registered.
+	template<typename Entry, typename HandleType>
+	bool IsRegistered( const pVector<Entry>& entries, HandleType handle ) {
+		for ( const Entry& entry : entries ) {
+			if ( entry.Handle == handle ) {
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
 InputContext& InputContext::GetInstance() {
 	static InputContext inputContext;
 
 	return inputContext;
 }
 
+InputContext::InputContext()
+	: m_InputState( &g_InputState ) {
+}
+
+InputContext::InputContext( InputState& inputState )
+	: m_InputState( &inputState ) {
+}
+
+InputState& InputContext::GetInputState() {
+	return *m_InputState;
+}
+
+const InputState& InputContext::GetInputState() const {
+	return *m_InputState;
+}
+
 void InputContext::Initialize() {
-	m_InputEventCallbackHandle = g_InputState.RegisterEventInterest( std::bind( &InputContext::HandleEvent, this, std::placeholders::_1 ) );
+	m_InputEventCallbackHandle = m_InputState->RegisterEventInterest( std::bind( &InputContext::HandleEvent, this, std::placeholders::_1 ) );
 
-	m_GamepadContexts.resize( INPUT_MAX_NR_OF_GAMEPADS );
+	m_GamepadContexts.clear();
+	m_GamepadContexts.reserve( INPUT_MAX_NR_OF_GAMEPADS );
+	for ( int i = 0; i < INPUT_MAX_NR_OF_GAMEPADS; ++i ) {
+		m_GamepadContexts.emplace_back( *m_InputState );
+	}
 }
 
 void InputContext::Deinitialize() {
-	g_InputState.UnregisterEventInterest( m_InputEventCallbackHandle );
+	m_InputState->UnregisterEventInterest( m_InputEventCallbackHandle );
 }
 
 void InputContext::Update() {
-	m_KeyboardPressStack.clear();
-	m_KeyboardReleaseStack.clear();
-	m_MouseSingleClickPressStack.clear();
-	m_MouseSingleClickReleaseStack.clear();
-	m_MouseDoubleClickPressStack.clear();
-	m_MouseDoubleClickReleaseStack.clear();
-
-	m_MousePosDeltaX = g_InputState.GetMouseDeltaX( m_MousePosLastX );
-	m_MousePosDeltaY = g_InputState.GetMouseDeltaY( m_MousePosLastY );
-	m_MousePosLastX	 = g_InputState.GetMouseDeltaAccumulationX();
-	m_MousePosLastY	 = g_InputState.GetMouseDeltaAccumulationY();
-
-	m_MouseScrollDeltaX	  = g_InputState.GetMouseScrollDeltaX( m_MouseScrollLastPosX );
-	m_MouseScrollDeltaY	  = g_InputState.GetMouseScrollDeltaY( m_MouseScrollLastPosY );
-	m_MouseScrollLastPosX = g_InputState.GetMouseScrollAccumulationX();
-	m_MouseScrollLastPosY = g_InputState.GetMouseScrollAccumulationY();
+	if ( m_TickWindowUsed ) {
+		// Edges past the last simulated tick belong to the next frame's ticks
+		m_KeyboardPressStack.RetainFrom( m_TickWindowEnd );
+		m_KeyboardReleaseStack.RetainFrom( m_TickWindowEnd );
+		m_MouseSingleClickPressStack.RetainFrom( m_TickWindowEnd );
+		m_MouseSingleClickReleaseStack.RetainFrom( m_TickWindowEnd );
+		m_MouseDoubleClickPressStack.RetainFrom( m_TickWindowEnd );
+		m_MouseDoubleClickReleaseStack.RetainFrom( m_TickWindowEnd );
+	} else {
+		m_KeyboardPressStack.Clear();
+		m_KeyboardReleaseStack.Clear();
+		m_MouseSingleClickPressStack.Clear();
+		m_MouseSingleClickReleaseStack.Clear();
+		m_MouseDoubleClickPressStack.Clear();
+		m_MouseDoubleClickReleaseStack.Clear();
+	}
+	m_TickWindow	 = InputTickWindow();
+	m_TickWindowUsed = false;
+
+	m_LatencyTracker.BeginFrame();
+
+	m_MousePosDeltaX = m_InputState->GetMouseDeltaX( m_MousePosLastX );
+	m_MousePosDeltaY = m_InputState->GetMouseDeltaY( m_MousePosLastY );
+	m_MousePosLastX	 = m_InputState->GetMouseDeltaAccumulationX();
+	m_MousePosLastY	 = m_InputState->GetMouseDeltaAccumulationY();
+
+	m_MouseScrollDeltaX	  = m_InputState->GetMouseScrollDeltaX( m_MouseScrollLastPosX );
+	m_MouseScrollDeltaY	  = m_InputState->GetMouseScrollDeltaY( m_MouseScrollLastPosY );
+	m_MouseScrollLastPosX = m_InputState->GetMouseScrollAccumulationX();
+	m_MouseScrollLastPosY = m_InputState->GetMouseScrollAccumulationY();
+	m_MouseWheelConsumed  = 0;
 
 	for ( auto& gamepad : m_GamepadContexts ) {
 		gamepad.Update();
 	}
-}
 
-bool InputContext::KeyUpDown( SDL_Scancode scanCode ) const {
-	for ( auto& pressed : m_KeyboardPressStack ) {
-		if ( pressed == scanCode ) {
-			return true;
+	// Callbacks may register or unregister themselves and others. Those unregistered during the pass are skipped.
+	pVector<UpdateCallbackEntry> updateCallbacks = m_UpdateCallbacks;
+	for ( auto& callback : updateCallbacks ) {
+		if ( IsRegistered( m_UpdateCallbacks, callback.Handle ) ) {
+			callback.Function();
 		}
 	}
-	return false;
 }
 
-bool InputContext::KeyUpDownConsume( SDL_Scancode scanCode, INPUT_STATE state ) {
-	for ( pVector<SDL_Scancode>::iterator it = m_KeyboardPressStack.begin(); it != m_KeyboardPressStack.end(); ) {
-		if ( *it == scanCode ) {
-			it = m_KeyboardPressStack.erase( it );
-			if ( state != INPUT_STATE_IGNORE ) {
-				g_InputState.SetKeyState( scanCode, state );
-			}
-			return true;
-		} else {
-			++it;
-		}
+void InputContext::SetTickWindow( Uint32 beginTicks, Uint32 endTicks ) {
+	m_TickWindow.Active		= true;
+	m_TickWindow.BeginTicks = beginTicks;
+	m_TickWindow.EndTicks	= endTicks;
+	m_TickWindowUsed		= true;
+	m_TickWindowEnd			= endTicks;
+	for ( auto& gamepad : m_GamepadContexts ) {
+		gamepad.SetTickWindow( m_TickWindow );
 	}
-	return false;
 }
 
-int InputContext::KeyUpDownConsumeAll( SDL_Scancode scanCode, INPUT_STATE state ) {
-	int nrOfKeysConsumed = 0;
-
-	for ( pVector<SDL_Scancode>::iterator it = m_KeyboardPressStack.begin(); it != m_KeyboardPressStack.end(); ) {
-		if ( *it == scanCode ) {
-			it = m_KeyboardPressStack.erase( it );
-			++nrOfKeysConsumed;
-		} else {
-			++it;
-		}
-	}
-	if ( ( nrOfKeysConsumed > 0 ) && ( state != INPUT_STATE_IGNORE ) ) {
-		g_InputState.SetKeyState( scanCode, state );
+void InputContext::ClearTickWindow() {
+	m_TickWindow.Active = false;
+	m_TickWindowUsed	= false;	// The edges past the window are read now, so Update doesn't carry them over
+	for ( auto& gamepad : m_GamepadContexts ) {
+		gamepad.SetTickWindow( m_TickWindow );
 	}
-	return nrOfKeysConsumed;
+}
+
+const InputTickWindow& InputContext::GetTickWindow() const {
+	return m_TickWindow;
+}
+
+bool InputContext::KeyUpDown( SDL_Scancode scanCode ) const {
+	return m_KeyboardPressStack.Find( scanCode, m_TickWindow ) != -1;
+}
+
+bool InputContext::KeyUpDownConsume( SDL_Scancode scanCode, INPUT_STATE state ) {
+	return ConsumeKey( m_KeyboardPressStack, scanCode, false, state ) > 0;
+}
+
+int InputContext::KeyUpDownConsumeAll( SDL_Scancode scanCode, INPUT_STATE state ) {
+	return ConsumeKey( m_KeyboardPressStack, scanCode, true, state );
 }
 
 bool InputContext::KeyDownUp( SDL_Scancode scanCode ) const {
-	for ( auto& released : m_KeyboardReleaseStack ) {
-		if ( released == scanCode ) {
-			return true;
-		}
-	}
-	return false;
+	return m_KeyboardReleaseStack.Find( scanCode, m_TickWindow ) != -1;
 }
 
 bool InputContext::KeyDownUpConsume( SDL_Scancode scanCode, INPUT_STATE state ) {
-	for ( pVector<SDL_Scancode>::iterator it = m_KeyboardReleaseStack.begin(); it != m_KeyboardReleaseStack.end(); ) {
-		if ( *it == scanCode ) {
-			it = m_KeyboardReleaseStack.erase( it );
-			if ( state != INPUT_STATE_IGNORE ) {
-				g_InputState.SetKeyState( scanCode, state );
-			}
-			return true;
-		} else {
-			++it;
-		}
-	}
-	return false;
+	return ConsumeKey( m_KeyboardReleaseStack, scanCode, false, state ) > 0;
 }
 
 int InputContext::KeyDownUpConsumeAll( SDL_Scancode scanCode, INPUT_STATE state ) {
-	int nrOfKeysConsumed = 0;
-
-	for ( pVector<SDL_Scancode>::iterator it = m_KeyboardReleaseStack.begin(); it != m_KeyboardReleaseStack.end(); ) {
-		if ( *it == scanCode ) {
-			it = m_KeyboardReleaseStack.erase( it );
-			++nrOfKeysConsumed;
-		} else {
-			++it;
-		}
-	}
-	if ( ( nrOfKeysConsumed > 0 ) && ( state != INPUT_STATE_IGNORE ) ) {
-		g_InputState.SetKeyState( scanCode, state );
-	}
-	return nrOfKeysConsumed;
+	return ConsumeKey( m_KeyboardReleaseStack, scanCode, true, state );
 }
 
 bool InputContext::KeyDown( SDL_Scancode scanCode ) const {
-	return g_InputState.IsKeyDown( scanCode );
+	if ( m_TickWindow.Active ) {
+		INPUT_STATE stateAtBegin = InputEdgeStateAt( m_KeyboardPressStack, m_KeyboardReleaseStack, scanCode, m_TickWindow.BeginTicks );
+		if ( stateAtBegin != INPUT_STATE_IGNORE ) {
+			return stateAtBegin == INPUT_STATE_DOWN || KeyUpDown( scanCode );
+		}
+	}
+	return m_InputState->IsKeyDown( scanCode );
 }
 
 bool InputContext::KeyUp( SDL_Scancode scanCode ) const {
-	return g_InputState.IsKeyUp( scanCode );
+	if ( m_TickWindow.Active ) {
+		INPUT_STATE stateAtBegin = InputEdgeStateAt( m_KeyboardPressStack, m_KeyboardReleaseStack, scanCode, m_TickWindow.BeginTicks );
+		if ( stateAtBegin != INPUT_STATE_IGNORE ) {
+			return stateAtBegin == INPUT_STATE_UP || KeyDownUp( scanCode );
+		}
+	}
+	return m_InputState->IsKeyUp( scanCode );
 }
 
 const pVector<SDL_Scancode>& InputContext::GetKeyboardPressStack() const {
-	return m_KeyboardPressStack;
+	return m_KeyboardPressStack.GetUnconsumedCodes();
 }
 
 const pVector<SDL_Scancode>& InputContext::GetKeyboardReleaseStack() const {
-	return m_KeyboardReleaseStack;
+	return m_KeyboardReleaseStack.GetUnconsumedCodes();
+}
+
+const InputEdgeStack<SDL_Scancode>& InputContext::GetKeyboardEdgeStack( bool press ) const {
+	return press ? m_KeyboardPressStack : m_KeyboardReleaseStack;
 }
 
 bool InputContext::MouseButtonDown( MOUSE_BUTTON button ) const {
-	return g_InputState.IsMouseButtonDown( button );
+	return m_InputState->IsMouseButtonDown( button );
 }
 
 bool InputContext::MouseButtonUp( MOUSE_BUTTON button ) const {
-	return g_InputState.IsMouseButtonUp( button );
+	return m_InputState->IsMouseButtonUp( button );
 }
 
 bool InputContext::MouseButtonUpDown( MOUSE_BUTTON button ) const {
-	for ( auto& pressed : m_MouseSingleClickPressStack ) {
-		if ( pressed == button ) {
-			return true;
-		}
-	}
-	return false;
+	return m_MouseSingleClickPressStack.Find( button, m_TickWindow ) != -1;
 }
 
 bool InputContext::MouseButtonUpDownConsume( MOUSE_BUTTON button, INPUT_STATE state ) {
-	return ConsumeMouseButton( m_MouseSingleClickPressStack, button, state );
+	return ConsumeMouseButton( m_MouseSingleClickPressStack, button, false, state ) > 0;
 }
 
 int InputContext::MouseButtonUpDownConsumeAll( MOUSE_BUTTON button, INPUT_STATE state ) {
-	return ConsumeMouseButtonAll( m_MouseSingleClickPressStack, button, state );
+	return ConsumeMouseButton( m_MouseSingleClickPressStack, button, true, state );
 }
 
 bool InputContext::MouseButtonDownUp( MOUSE_BUTTON button ) const {
-	for ( auto& pressed : m_MouseSingleClickReleaseStack ) {
-		if ( pressed == button ) {
-			return true;
-		}
-	}
-	return false;
+	return m_MouseSingleClickReleaseStack.Find( button, m_TickWindow ) != -1;
 }
 
 bool InputContext::MouseButtonDownUpConsume( MOUSE_BUTTON button, INPUT_STATE state ) {
-	return ConsumeMouseButton( m_MouseSingleClickReleaseStack, button, state );
+	return ConsumeMouseButton( m_MouseSingleClickReleaseStack, button, false, state ) > 0;
 }
 
 int InputContext::MouseButtonDownUpConsumeAll( MOUSE_BUTTON button, INPUT_STATE state ) {
-	return ConsumeMouseButtonAll( m_MouseSingleClickReleaseStack, button, state );
+	return ConsumeMouseButton( m_MouseSingleClickReleaseStack, button, true, state );
 }
 
 bool InputContext::MouseButtonDoubleUpDown( MOUSE_BUTTON button ) const {
-	for ( auto& pressed : m_MouseDoubleClickPressStack ) {
-		if ( pressed == button ) {
-			return true;
-		}
-	}
-	return false;
+	return m_MouseDoubleClickPressStack.Find( button, m_TickWindow ) != -1;
 }
 
 bool InputContext::MouseButtonDoubleUpDownConsume( MOUSE_BUTTON button, INPUT_STATE state ) {
-	return ConsumeMouseButton( m_MouseDoubleClickPressStack, button, state );
+	return ConsumeMouseButton( m_MouseDoubleClickPressStack, button, false, state ) > 0;
 }
 
 int InputContext::MouseButtonDoubleUpDownConsumeAll( MOUSE_BUTTON button, INPUT_STATE state ) {
-	return ConsumeMouseButtonAll( m_MouseDoubleClickPressStack, button, state );
+	return ConsumeMouseButton( m_MouseDoubleClickPressStack, button, true, state );
 }
 
 bool InputContext::MouseButtonDoubleDownUp( MOUSE_BUTTON button ) const {
-	for ( auto& pressed : m_MouseDoubleClickReleaseStack ) {
-		if ( pressed == button ) {
-			return true;
-		}
-	}
-	return false;
+	return m_MouseDoubleClickReleaseStack.Find( button, m_TickWindow ) != -1;
 }
 
 bool InputContext::MouseButtonDoubleDownUpConsume( MOUSE_BUTTON button, INPUT_STATE stateToSet ) {
-	return ConsumeMouseButton( m_MouseDoubleClickReleaseStack, button, stateToSet );
+	return ConsumeMouseButton( m_MouseDoubleClickReleaseStack, button, false, stateToSet ) > 0;
 }
 
 int InputContext::MouseButtonDoubleDownUpConsumeAll( MOUSE_BUTTON button, INPUT_STATE stateToSet ) {
-	return ConsumeMouseButtonAll( m_MouseDoubleClickReleaseStack, button, stateToSet );
+	return ConsumeMouseButton( m_MouseDoubleClickReleaseStack, button, true, stateToSet );
 }
 
 int InputContext::GetMousePosX() const {
-	return g_InputState.GetMouseState().PositionX;
+	return m_InputState->GetMouseState().PositionX;
 }
 
 int InputContext::GetMousePosY() const {
-	return g_InputState.GetMouseState().PositionY;
+	return m_InputState->GetMouseState().PositionY;
 }
 
 int InputContext::GetMousePosDeltaX() const {
@@ -239,61 +257,190 @@ int InputContext::GetMouseScrollDeltaY() const {
 	return m_MouseScrollDeltaY;
 }
 
+bool InputContext::MouseWheelScrolled( MOUSE_WHEEL wheel ) const {
+	if ( ( m_MouseWheelConsumed & ( 1u << wheel ) ) != 0 ) {
+		return false;
+	}
+	switch ( wheel ) {
+		case MOUSE_WHEEL_UP:	return m_MouseScrollDeltaY > 0;
+		case MOUSE_WHEEL_DOWN:	return m_MouseScrollDeltaY < 0;
+		case MOUSE_WHEEL_LEFT:	return m_MouseScrollDeltaX < 0;
+		case MOUSE_WHEEL_RIGHT: return m_MouseScrollDeltaX > 0;
+	}
+	return false;
+}
+
+bool InputContext::MouseWheelScrolledConsume( MOUSE_WHEEL wheel ) {
+	if ( !MouseWheelScrolled( wheel ) ) {
+		return false;
+	}
+	m_MouseWheelConsumed |= 1u << wheel;
+	return true;
+}
+
 const pVector<MOUSE_BUTTON>& InputContext::GetMouseSingleClickPressStack() const {
-	return m_MouseSingleClickPressStack;
+	return m_MouseSingleClickPressStack.GetUnconsumedCodes();
 }
 
 const pVector<MOUSE_BUTTON>& InputContext::GetMouseSingleClickReleaseStack() const {
-	return m_MouseSingleClickReleaseStack;
+	return m_MouseSingleClickReleaseStack.GetUnconsumedCodes();
 }
 
 const pVector<MOUSE_BUTTON>& InputContext::GetMouseDoubleClickPressStack() const {
-	return m_MouseDoubleClickPressStack;
+	return m_MouseDoubleClickPressStack.GetUnconsumedCodes();
 }
 
 const pVector<MOUSE_BUTTON>& InputContext::GetMouseDoubleClickReleaseStack() const {
-	return m_MouseDoubleClickReleaseStack;
+	return m_MouseDoubleClickReleaseStack.GetUnconsumedCodes();
+}
+
+const InputEdgeStack<MOUSE_BUTTON>& InputContext::GetMouseEdgeStack( bool press ) const {
+	return press ? m_MouseSingleClickPressStack : m_MouseSingleClickReleaseStack;
+}
+
+const InputEdgeStack<MOUSE_BUTTON>& InputContext::GetMouseDoubleClickEdgeStack( bool press ) const {
+	return press ? m_MouseDoubleClickPressStack : m_MouseDoubleClickReleaseStack;
 }
 
 const GamepadContext& InputContext::GetGamepadContext( unsigned int gamepadIndex ) const {
 	return m_GamepadContexts.at( gamepadIndex );
 }
 
+bool InputContext::ButtonUpDownConsume( unsigned int gamepadIndex, SDL_GameControllerButton button ) {
+	return m_GamepadContexts.at( gamepadIndex ).ButtonUpDownConsume( button );
+}
+
+bool InputContext::ButtonDownUpConsume( unsigned int gamepadIndex, SDL_GameControllerButton button ) {
+	return m_GamepadContexts.at( gamepadIndex ).ButtonDownUpConsume( button );
+}
+
+InputLatencyTracker& InputContext::GetLatencyTracker() {
+	return m_LatencyTracker;
+}
+
+const InputLatencyTracker& InputContext::GetLatencyTracker() const {
+	return m_LatencyTracker;
+}
+
+void InputContext::ObserveKeyEdge( SDL_Scancode scanCode, bool press, ActionIdentifier action ) {
+	const InputEdgeStack<SDL_Scancode>& stack = press ? m_KeyboardPressStack : m_KeyboardReleaseStack;
+	int index = stack.Find( scanCode, m_TickWindow );
+	if ( index != -1 && stack.MarkObserved( index ) ) {
+		m_LatencyTracker.Record( action, INPUT_TYPE_KEYBOARD, stack.GetTime( index ) );
+	}
+}
+
+void InputContext::ObserveButtonEdge( unsigned int gamepadIndex, SDL_GameControllerButton button, bool press, ActionIdentifier action ) {
+	const InputEdgeStack<Uint8>& stack = m_GamepadContexts.at( gamepadIndex ).GetEdgeStack( press );
+	int index = stack.Find( static_cast<Uint8>( button ), m_TickWindow );
+	if ( index != -1 && stack.MarkObserved( index ) ) {
+		m_LatencyTracker.Record( action, static_cast<INPUT_TYPE>( gamepadIndex ), stack.GetTime( index ) );
+	}
+}
+
+void InputContext::ObserveMouseEdge( MOUSE_BUTTON button, bool press, ActionIdentifier action ) {
+	const InputEdgeStack<MOUSE_BUTTON>& stack = press ? m_MouseSingleClickPressStack : m_MouseSingleClickReleaseStack;
+	int index = stack.Find( button, m_TickWindow );
+	if ( index != -1 && stack.MarkObserved( index ) ) {
+		m_LatencyTracker.Record( action, INPUT_TYPE_KEYBOARD, stack.GetTime( index ) );
+	}
+}
+
+InputEdgeCallbackHandle InputContext::RegisterEdgeInterest( InputEdgeCallbackFunction callbackFunction ) {
+	InputEdgeCallbackHandle handle = static_cast<InputEdgeCallbackHandle>( m_NextEdgeHandle++ );
+	m_EdgeCallbacks.push_back( EdgeCallbackEntry { handle, callbackFunction } );
+	return handle;
+}
+
+void InputContext::UnregisterEdgeInterest( InputEdgeCallbackHandle callbackHandle ) {
+	for ( auto it = m_EdgeCallbacks.begin(); it != m_EdgeCallbacks.end(); ++it ) {
+		if ( it->Handle == callbackHandle ) {
+			m_EdgeCallbacks.erase( it );
+			return;
+		}
+	}
+}
+
+InputUpdateCallbackHandle InputContext::RegisterUpdateInterest( InputUpdateCallbackFunction callbackFunction ) {
+	InputUpdateCallbackHandle handle = static_cast<InputUpdateCallbackHandle>( m_NextUpdateHandle++ );
+	m_UpdateCallbacks.push_back( UpdateCallbackEntry { handle, callbackFunction } );
+	return handle;
+}
+
+void InputContext::UnregisterUpdateInterest( InputUpdateCallbackHandle callbackHandle ) {
+	for ( auto it = m_UpdateCallbacks.begin(); it != m_UpdateCallbacks.end(); ++it ) {
+		if ( it->Handle == callbackHandle ) {
+			m_UpdateCallbacks.erase( it );
+			return;
+		}
+	}
+}
+
+void InputContext::NotifyEdge( INPUT_TYPE inputType, int code, INPUT_EDGE edge ) {
+	// Callbacks may register or unregister interests. Those unregistered during the pass are skipped.
+	pVector<EdgeCallbackEntry> edgeCallbacks = m_EdgeCallbacks;
+	for ( auto& callback : edgeCallbacks ) {
+		if ( IsRegistered( m_EdgeCallbacks, callback.Handle ) ) {
+			callback.Function( inputType, code, edge );
+		}
+	}
+}
+
 bool InputContext::HandleEvent( const SDL_Event& event ) {
+	const InputEventTime& time = m_InputState->GetEventTime();
 	switch ( event.type ) {
 		case SDL_KEYUP: {
 			if ( event.key.repeat == 0 ) {
-				m_KeyboardReleaseStack.push_back( event.key.keysym.scancode );
+				m_KeyboardReleaseStack.Push( event.key.keysym.scancode, time, ++m_EdgeSequence );
+				NotifyEdge( INPUT_TYPE_KEYBOARD, event.key.keysym.scancode, INPUT_EDGE_RELEASE );
 			}
 		} break;
 		case SDL_KEYDOWN: {
 			if ( event.key.repeat == 0 ) {
-				m_KeyboardPressStack.push_back( event.key.keysym.scancode );
+				m_KeyboardPressStack.Push( event.key.keysym.scancode, time, ++m_EdgeSequence );
+				NotifyEdge( INPUT_TYPE_KEYBOARD, event.key.keysym.scancode, INPUT_EDGE_PRESS );
 			}
 		} break;
 		case SDL_CONTROLLERBUTTONDOWN: {
-			m_GamepadContexts.at( event.cbutton.which ).HandleEvent( event );
+			if ( m_GamepadContexts.at( event.cbutton.which ).HandleEvent( event ) ) {
+				NotifyEdge( static_cast<INPUT_TYPE>( event.cbutton.which ), event.cbutton.button, INPUT_EDGE_PRESS );
+			}
 		} break;
 		case SDL_CONTROLLERBUTTONUP: {
-			m_GamepadContexts.at( event.cbutton.which ).HandleEvent( event );
+			if ( m_GamepadContexts.at( event.cbutton.which ).HandleEvent( event ) ) {
+				NotifyEdge( static_cast<INPUT_TYPE>( event.cbutton.which ), event.cbutton.button, INPUT_EDGE_RELEASE );
+			}
 		} break;
 		case SDL_CONTROLLERDEVICEADDED: {
 			m_GamepadContexts.at( event.cdevice.which ).Initialize( event.cdevice.which );
 		} break;
+		case SDL_CONTROLLERDEVICEREMOVED: {
+			m_GamepadContexts.at( event.cdevice.which ).Deinitialize();
+			NotifyEdge( static_cast<INPUT_TYPE>( event.cdevice.which ), 0, INPUT_EDGE_DEVICE_REMOVED );
+		} break;
 		case SDL_MOUSEBUTTONDOWN: {
 			if ( event.button.clicks == 1 ) {
-				m_MouseSingleClickPressStack.push_back( static_cast<MOUSE_BUTTON>( event.button.button ) );
+				m_MouseSingleClickPressStack.Push( static_cast<MOUSE_BUTTON>( event.button.button ), time, ++m_EdgeSequence );
 			}
 			if ( event.button.clicks == 2 ) {
-				m_MouseDoubleClickPressStack.push_back( static_cast<MOUSE_BUTTON>( event.button.button ) );
+				m_MouseDoubleClickPressStack.Push( static_cast<MOUSE_BUTTON>( event.button.button ), time, ++m_EdgeSequence );
+			}
+			// Every click, so presses and releases pair up
+			int mouseIndex = InputBinding::Mouse( static_cast<MOUSE_BUTTON>( event.button.button ) ).GetMouseIndex();
+			if ( mouseIndex >= 0 ) {
+				NotifyEdge( INPUT_TYPE_KEYBOARD, INPUT_EDGE_MOUSE_CODE + mouseIndex, INPUT_EDGE_PRESS );
 			}
 		} break;
 		case SDL_MOUSEBUTTONUP: {
 			if ( event.button.clicks == 1 ) {
-				m_MouseSingleClickReleaseStack.push_back( static_cast<MOUSE_BUTTON>( event.button.button ) );
+				m_MouseSingleClickReleaseStack.Push( static_cast<MOUSE_BUTTON>( event.button.button ), time, ++m_EdgeSequence );
 			}
 			if ( event.button.clicks == 2 ) {
-				m_MouseDoubleClickReleaseStack.push_back( static_cast<MOUSE_BUTTON>( event.button.button ) );
+				m_MouseDoubleClickReleaseStack.Push( static_cast<MOUSE_BUTTON>( event.button.button ), time, ++m_EdgeSequence );
+			}
+			int mouseIndex = InputBinding::Mouse( static_cast<MOUSE_BUTTON>( event.button.button ) ).GetMouseIndex();
+			if ( mouseIndex >= 0 ) {
+				NotifyEdge( INPUT_TYPE_KEYBOARD, INPUT_EDGE_MOUSE_CODE + mouseIndex, INPUT_EDGE_RELEASE );
 			}
 		} break;
 	}
@@ -301,35 +448,34 @@ bool InputContext::HandleEvent( const SDL_Event& event ) {
 	return false;
 }
 
-bool InputContext::ConsumeMouseButton( pVector<MOUSE_BUTTON>& stack, MOUSE_BUTTON button, INPUT_STATE stateToSet ) {
-	for ( pVector<MOUSE_BUTTON>::iterator it = stack.begin(); it != stack.end(); ) {
-		if ( *it == button ) {
-			it = stack.erase( it );
-			if ( stateToSet != INPUT_STATE_IGNORE ) {
-				g_InputState.SetMouseButtonState( button, stateToSet );
-			}
-			return true;
-		} else {
-			++it;
+namespace {
+	// Consumes the first unconsumed edge for code in window, or all of them.
+	template<typename T>
+	int ConsumeEdges( InputEdgeStack<T>& stack, T code, const InputTickWindow& window, bool all ) {
+		if ( all ) {
+			return stack.ConsumeAll( code, window );
 		}
+		int index = stack.Find( code, window );
+		if ( index == -1 ) {
+			return 0;
+		}
+		stack.Consume( index );
+		return 1;
 	}
-	return false;
 }
 
-int InputContext::ConsumeMouseButtonAll( pVector<MOUSE_BUTTON>& stack, MOUSE_BUTTON button, INPUT_STATE stateToSet ) {
-	int nrOfConsumedButtons = 0;
-
-	for ( pVector<MOUSE_BUTTON>::iterator it = stack.begin(); it != stack.end(); ) {
-		if ( *it == button ) {
-			it = stack.erase( it );
-			++nrOfConsumedButtons;
-		} else {
-			++it;
-		}
+int InputContext::ConsumeKey( InputEdgeStack<SDL_Scancode>& stack, SDL_Scancode scanCode, bool all, INPUT_STATE stateToSet ) {
+	int nrOfKeysConsumed = ConsumeEdges( stack, scanCode, m_TickWindow, all );
+	if ( ( nrOfKeysConsumed > 0 ) && ( stateToSet != INPUT_STATE_IGNORE ) ) {
+		m_InputState->SetKeyState( scanCode, stateToSet );
 	}
-	if ( stateToSet != INPUT_STATE_IGNORE ) {
-		g_InputState.SetMouseButtonState( button, stateToSet );
+	return nrOfKeysConsumed;
+}
+
+int InputContext::ConsumeMouseButton( InputEdgeStack<MOUSE_BUTTON>& stack, MOUSE_BUTTON button, bool all, INPUT_STATE stateToSet ) {
+	int nrOfConsumedButtons = ConsumeEdges( stack, button, m_TickWindow, all );
+	if ( ( nrOfConsumedButtons > 0 ) && ( stateToSet != INPUT_STATE_IGNORE ) ) {
+		m_InputState->SetMouseButtonState( button, stateToSet );
 	}
 	return nrOfConsumedButtons;
 }
-
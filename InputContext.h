@@ -4,55 +4,98 @@
 #include "InputLibraryDefine.h"
 #include "InputStateTypes.h"
 #include "GamepadContext.h"
+#include "InputEdgeStack.h"
+#include "InputLatency.h"
 #include "Types.h"
 
 #define g_Input InputContext::GetInstance()
 
+class InputState;
+
+enum INPUT_EDGE {
+	INPUT_EDGE_PRESS,
+	INPUT_EDGE_RELEASE,
+	INPUT_EDGE_DEVICE_REMOVED,	// Code is unused
+};
+
+struct InputEdgeCallbackHandle_tag { };
+typedef Handle<InputEdgeCallbackHandle_tag, int, -1> InputEdgeCallbackHandle;
+// Mouse buttons are reported for INPUT_TYPE_KEYBOARD, which actions query them through, as INPUT_EDGE_MOUSE_CODE plus
+// their InputBinding::GetMouseIndex.
+#define INPUT_EDGE_MOUSE_CODE SDL_NUM_SCANCODES
+// Code is a SDL_Scancode or mouse code for INPUT_TYPE_KEYBOARD and a SDL_GameControllerButton for gamepads.
+typedef std::function<void ( INPUT_TYPE inputType, int code, INPUT_EDGE edge )> InputEdgeCallbackFunction;
+
+struct InputUpdateCallbackHandle_tag { };
+typedef Handle<InputUpdateCallbackHandle_tag, int, -1> InputUpdateCallbackHandle;
+typedef std::function<void ()> InputUpdateCallbackFunction;
+
 class InputContext {
 public:
+	// Default instance, bound to the default InputState.
 	INPUT_API static InputContext& GetInstance ();
 
+	INPUT_API InputContext ();
+	INPUT_API explicit InputContext ( InputState& inputState );
+
+	InputContext( const InputContext& rhs ) = delete;
+	InputContext& operator = ( const InputContext& rhs ) = delete;
+
+	INPUT_API InputState&		GetInputState ();
+	INPUT_API const InputState& GetInputState () const;
+
 	INPUT_API void Initialize ();
 	INPUT_API void Deinitialize ();
 	INPUT_API void Update ();
 
+	// Restricts key, mouse button and gamepad queries to edges stamped in [beginTicks, endTicks) (SDL_GetTicks base)
+	// so each fixed simulation tick only sees the input that happened during it. Key and button down/up queries
+	// answer whether the input was down/up at any point in the interval. Edges newer than the last declared
+	// interval are carried over to the next frame unless the window is cleared before Update, which also clears it.
+	INPUT_API void					 SetTickWindow ( Uint32 beginTicks, Uint32 endTicks );
+	INPUT_API void					 ClearTickWindow ();
+	INPUT_API const InputTickWindow& GetTickWindow () const;
+
 	INPUT_API bool KeyUpDown ( SDL_Scancode scanCode ) const;
-	// Checks if key was pressed. Consumes one entry for the key from the press stack if it was pressed.
+	// Checks if key was pressed. Marks the first press as consumed, hiding it from all later queries, if it was pressed.
 	INPUT_API bool KeyUpDownConsume ( SDL_Scancode scanCode, INPUT_STATE stateToSet = INPUT_STATE_IGNORE );
-	// Checks if key was pressed. Consumes all entries for the key from the press stack if it was pressed.
+	// Consumes every press of the key, returning how many were hidden.
 	INPUT_API int  KeyUpDownConsumeAll ( SDL_Scancode scanCode, INPUT_STATE stateToSet = INPUT_STATE_IGNORE );
 	INPUT_API bool KeyDownUp ( SDL_Scancode scanCode ) const;
-	// Checks if key was released. Consumes one entry for the key from the release stack if it was released.
+	// Checks if key was released. Marks the first release as consumed if it was released.
 	INPUT_API bool KeyDownUpConsume ( SDL_Scancode scanCode, INPUT_STATE stateToSet = INPUT_STATE_IGNORE );
-	// Checks if key was released. Consumes all entries for the key from the release stack if it was released.
+	// Consumes every release of the key, returning how many were hidden.
 	INPUT_API int  KeyDownUpConsumeAll ( SDL_Scancode scanCode, INPUT_STATE stateToSet = INPUT_STATE_IGNORE );
 	INPUT_API bool KeyDown ( SDL_Scancode scanCode ) const;
 	INPUT_API bool KeyUp ( SDL_Scancode scanCode ) const;
 
+	// Codes of this frame's edges that have not been consumed.
 	INPUT_API const pVector<SDL_Scancode>& GetKeyboardPressStack () const;
 	INPUT_API const pVector<SDL_Scancode>& GetKeyboardReleaseStack () const;
+	// The press or release stack with the time of every edge, consumed ones included. Check IsConsumed to skip them.
+	INPUT_API const InputEdgeStack<SDL_Scancode>& GetKeyboardEdgeStack ( bool press ) const;
 
 	INPUT_API bool MouseButtonDown                  ( MOUSE_BUTTON button ) const;
 	INPUT_API bool MouseButtonUp                    ( MOUSE_BUTTON button ) const;
 	INPUT_API bool MouseButtonUpDown                ( MOUSE_BUTTON button ) const;
-	// Checks if button was pressed. Consumes one entry for the button from the press stack if it was pressed.
+	// Checks if button was pressed. Marks its press as consumed for the rest of the frame if it was pressed.
 	INPUT_API bool MouseButtonUpDownConsume         ( MOUSE_BUTTON button, INPUT_STATE stateToSet = INPUT_STATE_IGNORE );
-	// Checks if button was pressed. Consumes all entries for the button from the press stack if it was pressed.
+	// As MouseButtonUpDownConsume, returning the number of press entries that were hidden.
 	INPUT_API int  MouseButtonUpDownConsumeAll      ( MOUSE_BUTTON button, INPUT_STATE stateToSet = INPUT_STATE_IGNORE );
 	INPUT_API bool MouseButtonDownUp                ( MOUSE_BUTTON button ) const;
-	// Checks if button was released. Consumes one entry for the button from the release stack if it was released.
+	// Checks if button was released. Marks its release as consumed for the rest of the frame if it was released.
 	INPUT_API bool MouseButtonDownUpConsume         ( MOUSE_BUTTON button, INPUT_STATE stateToSet = INPUT_STATE_IGNORE );
-	// Checks if button was released. Consumes all entries for the button from the release stack if it was released.
+	// As MouseButtonDownUpConsume, returning the number of release entries that were hidden.
 	INPUT_API int  MouseButtonDownUpConsumeAll      ( MOUSE_BUTTON button, INPUT_STATE stateToSet = INPUT_STATE_IGNORE );
 	INPUT_API bool MouseButtonDoubleUpDown          ( MOUSE_BUTTON button ) const;
-	// Checks if button was double pressed. Consumes one entry for the button from the release stack if it was released.
+	// Checks if button was double pressed. Marks the double press as consumed for the rest of the frame if it was.
 	INPUT_API bool MouseButtonDoubleUpDownConsume   ( MOUSE_BUTTON button, INPUT_STATE stateToSet = INPUT_STATE_IGNORE );
-	// Checks if button was double pressed. Consumes all entries for the button from the release stack if it was released.
+	// As MouseButtonDoubleUpDownConsume, returning the number of entries that were hidden.
 	INPUT_API int  MouseButtonDoubleUpDownConsumeAll ( MOUSE_BUTTON button, INPUT_STATE stateToSet = INPUT_STATE_IGNORE );
 	INPUT_API bool MouseButtonDoubleDownUp          ( MOUSE_BUTTON button ) const;
-	// Checks if button was double released. Consumes one entry for the button from the release stack if it was released.
+	// Checks if button was double released. Marks the double release as consumed for the rest of the frame if it was.
 	INPUT_API bool MouseButtonDoubleDownUpConsume   ( MOUSE_BUTTON button, INPUT_STATE stateToSet = INPUT_STATE_IGNORE );
-	// Checks if button was double released. Consumes all entries for the button from the release stack if it was released.
+	// As MouseButtonDoubleDownUpConsume, returning the number of entries that were hidden.
 	INPUT_API int MouseButtonDoubleDownUpConsumeAll ( MOUSE_BUTTON button, INPUT_STATE stateToSet = INPUT_STATE_IGNORE );
 	INPUT_API int GetMousePosX () const;
 	INPUT_API int GetMousePosY () const;
@@ -60,28 +103,75 @@ public:
 	INPUT_API int GetMousePosDeltaY () const;
 	INPUT_API int GetMouseScrollDeltaX () const;
 	INPUT_API int GetMouseScrollDeltaY () const;
+	// True if the wheel moved in the direction this frame and that wasn't consumed. A wheel binding is pressed and
+	// released within such a frame, as a single edge that its press and release queries share.
+	INPUT_API bool MouseWheelScrolled ( MOUSE_WHEEL wheel ) const;
+	// Checks if the wheel moved in the direction. Marks the movement as consumed for the rest of the frame if it did.
+	INPUT_API bool MouseWheelScrolledConsume ( MOUSE_WHEEL wheel );
 
+	// Buttons of this frame's edges that have not been consumed.
 	INPUT_API const pVector<MOUSE_BUTTON>& GetMouseSingleClickPressStack () const;
 	INPUT_API const pVector<MOUSE_BUTTON>& GetMouseSingleClickReleaseStack () const;
 	INPUT_API const pVector<MOUSE_BUTTON>& GetMouseDoubleClickPressStack () const;
 	INPUT_API const pVector<MOUSE_BUTTON>& GetMouseDoubleClickReleaseStack () const;
+	// The single click press or release stack with the time of every edge, see GetKeyboardEdgeStack.
+	INPUT_API const InputEdgeStack<MOUSE_BUTTON>& GetMouseEdgeStack ( bool press ) const;
+	INPUT_API const InputEdgeStack<MOUSE_BUTTON>& GetMouseDoubleClickEdgeStack ( bool press ) const;
 
 	INPUT_API const GamepadContext& GetGamepadContext ( unsigned int gamepadIndex ) const;
+	INPUT_API bool					ButtonUpDownConsume ( unsigned int gamepadIndex, SDL_GameControllerButton button );
+	INPUT_API bool					ButtonDownUpConsume ( unsigned int gamepadIndex, SDL_GameControllerButton button );
+
+	INPUT_API InputLatencyTracker&		 GetLatencyTracker ();
+	INPUT_API const InputLatencyTracker& GetLatencyTracker () const;
+	// Records latency for action the first time an action query sees the press (or release) edge.
+	INPUT_API void ObserveKeyEdge ( SDL_Scancode scanCode, bool press, ActionIdentifier action );
+	INPUT_API void ObserveButtonEdge ( unsigned int gamepadIndex, SDL_GameControllerButton button, bool press, ActionIdentifier action );
+	// Recorded for the keyboard, which the mouse is queried with.
+	INPUT_API void ObserveMouseEdge ( MOUSE_BUTTON button, bool press, ActionIdentifier action );
+
+	// Called for every key, mouse button and gamepad button edge as it happens, and when a gamepad is removed.
+	// Interests unregistered by an earlier callback for the same edge are skipped.
+	INPUT_API InputEdgeCallbackHandle RegisterEdgeInterest ( InputEdgeCallbackFunction callbackFunction );
+	INPUT_API void					  UnregisterEdgeInterest ( InputEdgeCallbackHandle callbackHandle );
+	// Called at the end of every Update. Interests unregistered by an earlier callback in the same pass are skipped.
+	INPUT_API InputUpdateCallbackHandle RegisterUpdateInterest ( InputUpdateCallbackFunction callbackFunction );
+	INPUT_API void						UnregisterUpdateInterest ( InputUpdateCallbackHandle callbackHandle );
 
 private:
+	struct EdgeCallbackEntry {
+		InputEdgeCallbackHandle	  Handle;
+		InputEdgeCallbackFunction Function;
+	};
+
+	struct UpdateCallbackEntry {
+		InputUpdateCallbackHandle	Handle;
+		InputUpdateCallbackFunction Function;
+	};
+
 	bool HandleEvent ( const SDL_Event& event );
-	bool ConsumeMouseButton ( pVector<MOUSE_BUTTON>& stack, MOUSE_BUTTON button, INPUT_STATE stateToSet );
-	int	 ConsumeMouseButtonAll ( pVector<MOUSE_BUTTON>& stack, MOUSE_BUTTON button, INPUT_STATE stateToSet );
+	void NotifyEdge ( INPUT_TYPE inputType, int code, INPUT_EDGE edge );
+	// Consumes the first edge for the code in the tick window, or all of them.
+	int	 ConsumeKey ( InputEdgeStack<SDL_Scancode>& stack, SDL_Scancode scanCode, bool all, INPUT_STATE stateToSet );
+	int	 ConsumeMouseButton ( InputEdgeStack<MOUSE_BUTTON>& stack, MOUSE_BUTTON button, bool all, INPUT_STATE stateToSet );
 
+	InputState*				 m_InputState;
 	InputEventCallbackHandle m_InputEventCallbackHandle;
 
-	pVector<SDL_Scancode> m_KeyboardPressStack;
-	pVector<SDL_Scancode> m_KeyboardReleaseStack;
+	InputEdgeStack<SDL_Scancode> m_KeyboardPressStack;
+	InputEdgeStack<SDL_Scancode> m_KeyboardReleaseStack;
+
+	InputEdgeStack<MOUSE_BUTTON> m_MouseSingleClickPressStack;
+	InputEdgeStack<MOUSE_BUTTON> m_MouseSingleClickReleaseStack;
+	InputEdgeStack<MOUSE_BUTTON> m_MouseDoubleClickPressStack;
+	InputEdgeStack<MOUSE_BUTTON> m_MouseDoubleClickReleaseStack;	// Does this even make sense?
+	Uint32						 m_EdgeSequence = 0;	// Shared by the keyboard and mouse edges
 
-	pVector<MOUSE_BUTTON> m_MouseSingleClickPressStack;
-	pVector<MOUSE_BUTTON> m_MouseSingleClickReleaseStack;
-	pVector<MOUSE_BUTTON> m_MouseDoubleClickPressStack;
-	pVector<MOUSE_BUTTON> m_MouseDoubleClickReleaseStack;	// Does this even make sense?
+	InputLatencyTracker m_LatencyTracker;
+
+	InputTickWindow m_TickWindow;
+	bool			m_TickWindowUsed  = false;
+	Uint32			m_TickWindowEnd	  = 0;
 
 	int m_MousePosDeltaX = 0;
 	int m_MousePosDeltaY = 0;
@@ -92,7 +182,14 @@ private:
 	int m_MouseScrollDeltaY	  = 0;
 	int m_MouseScrollLastPosX = 0;
 	int m_MouseScrollLastPosY = 0;
+	Uint8 m_MouseWheelConsumed = 0;	// Bit per MOUSE_WHEEL, cleared by Update
 
 	pVector<GamepadContext> m_GamepadContexts;
+
+	pVector<EdgeCallbackEntry> m_EdgeCallbacks;
+	int						   m_NextEdgeHandle = 0;
+
+	pVector<UpdateCallbackEntry> m_UpdateCallbacks;
+	int							 m_NextUpdateHandle = 0;
 };
 
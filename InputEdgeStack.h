@@ -0,0 +1,183 @@
+#pragma once
+
+#include INPUT_ALLOCATION_HEADER
+#include "InputStateTypes.h"
+
+// Press or release stack for one frame. Codes are kept contiguous so they can be
+// handed out as-is, with the time, sequence number and consumed flag of every edge stored alongside.
+template<typename T>
+class InputEdgeStack {
+public:
+	// sequence numbers the edges of the device in the order they happened, edges of the same tick included.
+	void Push( T code, const InputEventTime& time, Uint32 sequence ) {
+		m_Codes.push_back( code );
+		m_Edges.push_back( Edge { time, sequence, false, false } );
+		m_UnconsumedDirty = true;
+	}
+
+	void Clear() {
+		m_Codes.clear();
+		m_Edges.clear();
+		m_UnconsumedDirty = true;
+	}
+
+	// Returns the index of the first unconsumed entry for code inside window or -1 if there is none.
+	int Find( T code, const InputTickWindow& window = InputTickWindow() ) const {
+		for ( size_t i = 0; i < m_Codes.size(); ++i ) {
+			if ( m_Codes[i] == code && !m_Edges[i].Consumed && window.Contains( m_Edges[i].Time.GetTicks() ) ) {
+				return static_cast<int>( i );
+			}
+		}
+		return -1;
+	}
+
+	// Returns the number of unconsumed entries for code inside window.
+	int Count( T code, const InputTickWindow& window = InputTickWindow() ) const {
+		int count = 0;
+		for ( size_t i = 0; i < m_Codes.size(); ++i ) {
+			if ( m_Codes[i] == code && !m_Edges[i].Consumed && window.Contains( m_Edges[i].Time.GetTicks() ) ) {
+				++count;
+			}
+		}
+		return count;
+	}
+
+	// Hides the entry from Find and Count. The flag stays with the entry when it is retained into the next frame.
+	void Consume( int index ) {
+		m_Edges[index].Consumed = true;
+		m_UnconsumedDirty		= true;
+	}
+
+	// Consumes all unconsumed entries for code inside window and returns how many there were.
+	int ConsumeAll( T code, const InputTickWindow& window = InputTickWindow() ) {
+		int nrOfConsumed = 0;
+		for ( size_t i = 0; i < m_Codes.size(); ++i ) {
+			if ( m_Codes[i] == code && !m_Edges[i].Consumed && window.Contains( m_Edges[i].Time.GetTicks() ) ) {
+				m_Edges[i].Consumed = true;
+				++nrOfConsumed;
+			}
+		}
+		m_UnconsumedDirty = m_UnconsumedDirty || nrOfConsumed > 0;
+		return nrOfConsumed;
+	}
+
+	bool IsConsumed( int index ) const {
+		return m_Edges[index].Consumed;
+	}
+
+	void Erase( int index ) {
+		m_Codes.erase( m_Codes.begin() + index );
+		m_Edges.erase( m_Edges.begin() + index );
+		m_UnconsumedDirty = true;
+	}
+
+	// Removes all entries for code inside window and returns how many were removed.
+	int EraseAll( T code, const InputTickWindow& window = InputTickWindow() ) {
+		int nrOfErased = 0;
+		for ( int i = static_cast<int>( m_Codes.size() ) - 1; i >= 0; --i ) {
+			if ( m_Codes[i] == code && window.Contains( m_Edges[i].Time.GetTicks() ) ) {
+				Erase( i );
+				++nrOfErased;
+			}
+		}
+		return nrOfErased;
+	}
+
+	// Keeps only the entries stamped at or after ticks.
+	void RetainFrom( Uint32 ticks ) {
+		size_t kept = 0;
+		for ( size_t i = 0; i < m_Codes.size(); ++i ) {
+			if ( static_cast<Sint32>( m_Edges[i].Time.GetTicks() - ticks ) >= 0 ) {
+				m_Codes[kept] = m_Codes[i];
+				m_Edges[kept] = m_Edges[i];
+				++kept;
+			}
+		}
+		m_Codes.resize( kept );
+		m_Edges.resize( kept );
+		m_UnconsumedDirty = true;
+	}
+
+	// Flags the entry as seen by an action query. Returns true the first time only.
+	bool MarkObserved( int index ) const {
+		bool wasObserved = m_Edges[index].Observed;
+		m_Edges[index].Observed = true;
+		return !wasObserved;
+	}
+
+	const InputEventTime& GetTime( int index ) const {
+		return m_Edges[index].Time;
+	}
+
+	Uint32 GetSequence( int index ) const {
+		return m_Edges[index].Sequence;
+	}
+
+	// Codes of all entries, consumed ones included. Indices match GetTime and IsConsumed.
+	const pVector<T>& GetCodes() const {
+		return m_Codes;
+	}
+
+	// Codes of the unconsumed entries, rebuilt on the first call after the stack changed.
+	const pVector<T>& GetUnconsumedCodes() const {
+		if ( m_UnconsumedDirty ) {
+			m_UnconsumedCodes.clear();
+			for ( size_t i = 0; i < m_Codes.size(); ++i ) {
+				if ( !m_Edges[i].Consumed ) {
+					m_UnconsumedCodes.push_back( m_Codes[i] );
+				}
+			}
+			m_UnconsumedDirty = false;
+		}
+		return m_UnconsumedCodes;
+	}
+
+	size_t Size() const {
+		return m_Codes.size();
+	}
+
+private:
+	struct Edge {
+		InputEventTime Time;
+		Uint32		   Sequence;
+		bool		   Observed;
+		bool		   Consumed;
+	};
+
+	pVector<T>			  m_Codes;
+	mutable pVector<Edge> m_Edges;
+	mutable pVector<T>	  m_UnconsumedCodes;
+	mutable bool		  m_UnconsumedDirty = false;
+};
+
+// Reconstructs whether code was down at ticks from this frame's edges, consumed ones included.
+// Returns INPUT_STATE_IGNORE if there are no edges for code, in which case the current state applies.
+template<typename T>
+INPUT_STATE InputEdgeStateAt( const InputEdgeStack<T>& pressStack, const InputEdgeStack<T>& releaseStack, T code, Uint32 ticks ) {
+	bool   foundBefore = false, foundAfter = false;
+	Sint32 latestBefore = 0, earliestAfter = 0;
+	INPUT_STATE stateBefore = INPUT_STATE_IGNORE, stateAfter = INPUT_STATE_IGNORE;
+
+	auto visit = [&]( const InputEdgeStack<T>& stack, INPUT_STATE edgeState ) {
+		for ( size_t i = 0; i < stack.Size(); ++i ) {
+			if ( stack.GetCodes()[i] != code ) {
+				continue;
+			}
+			Sint32 offset = static_cast<Sint32>( stack.GetTime( static_cast<int>( i ) ).GetTicks() - ticks );
+			if ( offset < 0 ) {
+				if ( !foundBefore || offset >= latestBefore ) {
+					foundBefore	 = true;
+					latestBefore = offset;
+					stateBefore	 = edgeState;
+				}
+			} else if ( !foundAfter || offset < earliestAfter ) {
+				foundAfter	  = true;
+				earliestAfter = offset;
+				stateAfter	  = edgeState == INPUT_STATE_DOWN ? INPUT_STATE_UP : INPUT_STATE_DOWN;
+			}
+		}
+	};
+	visit( pressStack, INPUT_STATE_DOWN );
+	visit( releaseStack, INPUT_STATE_UP );
+	return foundBefore ? stateBefore : stateAfter;
+}
@@ -0,0 +1,142 @@
+#include "InputHistory.h"
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+#include "InputState.h"
+#include "InputContext.h"
+#include "KeyBindings.h"
+
+#define INPUT_HISTORY_SLOT_VALID		0x01
+#define INPUT_HISTORY_SLOT_CONFIRMED	0x02
+
+InputHistory::InputHistory( int nrOfPlayers, int rollbackWindow, int nrOfActions )
+	: m_NrOfPlayers( nrOfPlayers ), m_RollbackWindow( rollbackWindow ), m_NrOfActions( nrOfActions ) {
+	assert( nrOfPlayers > 0 && rollbackWindow > 0 );
+	m_NrOfActionWords = ( nrOfActions + 63 ) / 64;
+	size_t nrOfSlots  = static_cast<size_t>( nrOfPlayers ) * rollbackWindow;
+	m_SlotTicks.resize( nrOfSlots, 0 );
+	m_SlotFlags.resize( nrOfSlots, 0 );
+	m_ActionBits.resize( nrOfSlots * m_NrOfActionWords, 0 );
+	m_Axes.resize( nrOfSlots * SDL_CONTROLLER_AXIS_MAX, 0 );
+	m_NewestTick.resize( nrOfPlayers, 0 );
+}
+
+void InputHistory::Capture( int player, Uint32 tick, const KeyBindings& keyBindings, InputContext& input, BindContextHandle bindContext,
+							INPUT_TYPE inputType ) {
+	int slot = GetSlot( player, tick );
+	Uint64* bits = &m_ActionBits[slot * m_NrOfActionWords];
+	std::fill( bits, bits + m_NrOfActionWords, 0 );
+	for ( int action = 0; action < m_NrOfActions; ++action ) {
+		if ( keyBindings.ActionDown( input, bindContext, static_cast<ActionIdentifier>( action ), inputType ) ) {
+			bits[action >> 6] |= Uint64( 1 ) << ( action & 63 );
+		}
+	}
+
+	Sint16* axes = &m_Axes[slot * SDL_CONTROLLER_AXIS_MAX];
+	for ( int axis = 0; axis < SDL_CONTROLLER_AXIS_MAX; ++axis ) {
+		axes[axis] = InputTypeIsGamepad( inputType ) ? QuantizeAxis( input.GetInputState().GetStateBlock().GamepadAxis[inputType][axis] ) : 0;
+	}
+	m_SlotTicks[slot] = tick;
+	m_SlotFlags[slot] = INPUT_HISTORY_SLOT_VALID;
+	if ( static_cast<Sint32>( tick - m_NewestTick[player] ) > 0 ) {
+		m_NewestTick[player] = tick;
+	}
+}
+
+void InputHistory::Record( int player, Uint32 tick, const Uint64* actionBits, const Sint16* axes, bool confirmed ) {
+	int slot = GetSlot( player, tick );
+	memcpy( &m_ActionBits[slot * m_NrOfActionWords], actionBits, m_NrOfActionWords * sizeof( Uint64 ) );
+	memcpy( &m_Axes[slot * SDL_CONTROLLER_AXIS_MAX], axes, SDL_CONTROLLER_AXIS_MAX * sizeof( Sint16 ) );
+	m_SlotTicks[slot] = tick;
+	m_SlotFlags[slot] = INPUT_HISTORY_SLOT_VALID | ( confirmed ? INPUT_HISTORY_SLOT_CONFIRMED : 0 );
+	if ( static_cast<Sint32>( tick - m_NewestTick[player] ) > 0 ) {
+		m_NewestTick[player] = tick;
+	}
+}
+
+bool InputHistory::Confirm( int player, Uint32 tick, const Uint64* actionBits, const Sint16* axes ) {
+	bool mispredicted = true;
+	if ( ContainsTick( player, tick ) ) {
+		int slot	 = GetSlot( player, tick );
+		mispredicted = memcmp( &m_ActionBits[slot * m_NrOfActionWords], actionBits, m_NrOfActionWords * sizeof( Uint64 ) ) != 0 ||
+					   memcmp( &m_Axes[slot * SDL_CONTROLLER_AXIS_MAX], axes, SDL_CONTROLLER_AXIS_MAX * sizeof( Sint16 ) ) != 0;
+	}
+	Record( player, tick, actionBits, axes, true );
+	return mispredicted;
+}
+
+bool InputHistory::HasTick( int player, Uint32 tick ) const {
+	return ContainsTick( player, tick );
+}
+
+bool InputHistory::IsConfirmed( int player, Uint32 tick ) const {
+	return ContainsTick( player, tick ) && ( m_SlotFlags[GetSlot( player, tick )] & INPUT_HISTORY_SLOT_CONFIRMED ) != 0;
+}
+
+bool InputHistory::ActionDown( int player, Uint32 tick, ActionIdentifier action ) const {
+	const Uint64* bits = GetActionBits( player, tick );
+	int index = static_cast<int>( action );
+	return bits && index >= 0 && index < m_NrOfActions && ( ( bits[index >> 6] >> ( index & 63 ) ) & 1 ) != 0;
+}
+
+float InputHistory::GetAxis( int player, Uint32 tick, SDL_GameControllerAxis axis ) const {
+	const Sint16* axes = GetQuantizedAxes( player, tick );
+	return axes ? DequantizeAxis( axes[axis] ) : 0.0f;
+}
+
+const Uint64* InputHistory::GetActionBits( int player, Uint32 tick ) const {
+	if ( !ContainsTick( player, tick ) ) {
+		return nullptr;
+	}
+	return &m_ActionBits[GetSlot( player, tick ) * m_NrOfActionWords];
+}
+
+const Sint16* InputHistory::GetQuantizedAxes( int player, Uint32 tick ) const {
+	if ( !ContainsTick( player, tick ) ) {
+		return nullptr;
+	}
+	return &m_Axes[GetSlot( player, tick ) * SDL_CONTROLLER_AXIS_MAX];
+}
+
+bool InputHistory::GetChangedActionsSince( int player, Uint32 tick, Uint64* changedBits ) const {
+	std::fill( changedBits, changedBits + m_NrOfActionWords, 0 );
+	const Uint64* base = GetActionBits( player, tick );
+	if ( base == nullptr ) {
+		return false;
+	}
+	// Offsets from tick rather than absolute ticks so the range stays correct when the counter wraps
+	Sint32 newestOffset = static_cast<Sint32>( m_NewestTick[player] - tick );
+	Sint32 lastOffset	= std::min( newestOffset, m_RollbackWindow - 1 );
+	for ( Sint32 offset = 1; offset <= lastOffset; ++offset ) {
+		Uint32 later = tick + static_cast<Uint32>( offset );
+		const Uint64* bits = GetActionBits( player, later );
+		if ( bits ) {
+			for ( int word = 0; word < m_NrOfActionWords; ++word ) {
+				changedBits[word] |= bits[word] ^ base[word];
+			}
+		}
+	}
+	return true;
+}
+
+Uint32 InputHistory::GetNewestTick( int player ) const {
+	return m_NewestTick.at( player );
+}
+
+int InputHistory::GetNrOfActionWords() const {
+	return m_NrOfActionWords;
+}
+
+int InputHistory::GetRollbackWindow() const {
+	return m_RollbackWindow;
+}
+
+int InputHistory::GetSlot( int player, Uint32 tick ) const {
+	assert( player >= 0 && player < m_NrOfPlayers );
+	return player * m_RollbackWindow + static_cast<int>( tick % m_RollbackWindow );
+}
+
+bool InputHistory::ContainsTick( int player, Uint32 tick ) const {
+	int slot = GetSlot( player, tick );
+	return ( m_SlotFlags[slot] & INPUT_HISTORY_SLOT_VALID ) != 0 && m_SlotTicks[slot] == tick;
+}
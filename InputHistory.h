@@ -0,0 +1,63 @@
+#pragma once
+
+#include <SDL2/SDL_gamecontroller.h>
+#include INPUT_ALLOCATION_HEADER
+#include "InputLibraryDefine.h"
+#include "Types.h"
+
+class KeyBindings;
+class InputContext;
+
+// Ring buffer of per tick action bitsets and quantized gamepad axes for every local player.
+// Holds the last rollbackWindow ticks; older ticks are overwritten as new ones are recorded.
+class InputHistory {
+public:
+	INPUT_API InputHistory( int nrOfPlayers, int rollbackWindow, int nrOfActions );
+
+	// Samples KeyBindings::ActionDown for every action and the gamepad axes of inputType into tick as predicted input.
+	INPUT_API void Capture ( int player, Uint32 tick, const KeyBindings& keyBindings, InputContext& input,
+							 BindContextHandle bindContext, INPUT_TYPE inputType );
+	INPUT_API void Record ( int player, Uint32 tick, const Uint64* actionBits, const Sint16* axes, bool confirmed = false );
+	// Overwrites a predicted tick with authoritative input. Returns true if it differs from what was predicted.
+	INPUT_API bool Confirm ( int player, Uint32 tick, const Uint64* actionBits, const Sint16* axes );
+
+	INPUT_API bool			HasTick ( int player, Uint32 tick ) const;
+	INPUT_API bool			IsConfirmed ( int player, Uint32 tick ) const;
+	INPUT_API bool			ActionDown ( int player, Uint32 tick, ActionIdentifier action ) const;
+	INPUT_API float			GetAxis ( int player, Uint32 tick, SDL_GameControllerAxis axis ) const;
+	// Returns nullptr if tick is not in the buffer.
+	INPUT_API const Uint64* GetActionBits ( int player, Uint32 tick ) const;
+	INPUT_API const Sint16* GetQuantizedAxes ( int player, Uint32 tick ) const;
+	// Sets the bits of every action whose state differs from tick in any later recorded tick.
+	// Returns false if tick is no longer in the buffer.
+	INPUT_API bool			GetChangedActionsSince ( int player, Uint32 tick, Uint64* changedBits ) const;
+	INPUT_API Uint32		GetNewestTick ( int player ) const;
+
+	INPUT_API int GetNrOfActionWords () const;
+	INPUT_API int GetRollbackWindow () const;
+
+	static Sint16 QuantizeAxis ( float value ) {
+		float clamped = value < -1.0f ? -1.0f : ( value > 1.0f ? 1.0f : value );
+		return static_cast<Sint16>( clamped * 32767.0f + ( clamped < 0.0f ? -0.5f : 0.5f ) );
+	}
+
+	static float DequantizeAxis ( Sint16 value ) {
+		// -32768 has no positive counterpart
+		return value < -32767 ? -1.0f : value / 32767.0f;
+	}
+
+private:
+	int	 GetSlot ( int player, Uint32 tick ) const;
+	bool ContainsTick ( int player, Uint32 tick ) const;
+
+	int m_NrOfPlayers;
+	int m_RollbackWindow;
+	int m_NrOfActions;
+	int m_NrOfActionWords;
+
+	pVector<Uint32> m_SlotTicks;
+	pVector<Uint8>	m_SlotFlags;
+	pVector<Uint64> m_ActionBits;
+	pVector<Sint16> m_Axes;
+	pVector<Uint32> m_NewestTick;
+};
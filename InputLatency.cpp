@@ -0,0 +1,112 @@
+#include "InputLatency.h"
+#include <cassert>
+#include <algorithm>
+#include <SDL2/SDL_timer.h>
+
+void InputLatencyHistogram::Add( Uint32 microseconds ) {
+	int bucket = 0;
+	for ( Uint32 value = microseconds >> 1; value != 0 && bucket < INPUT_LATENCY_BUCKET_COUNT - 1; value >>= 1 ) {
+		++bucket;
+	}
+	++Buckets[bucket];
+	++Count;
+	TotalMicroseconds += microseconds;
+	MaxMicroseconds	   = std::max( MaxMicroseconds, microseconds );
+}
+
+void InputLatencyHistogram::Clear() {
+	*this = InputLatencyHistogram();
+}
+
+Uint32 InputLatencyHistogram::GetAverage() const {
+	return Count > 0 ? static_cast<Uint32>( TotalMicroseconds / Count ) : 0;
+}
+
+Uint32 InputLatencyHistogram::GetPercentile( float percentile ) const {
+	Uint32 target	  = static_cast<Uint32>( percentile * Count );
+	Uint32 accumulated = 0;
+	for ( int i = 0; i < INPUT_LATENCY_BUCKET_COUNT; ++i ) {
+		accumulated += Buckets[i];
+		if ( accumulated > 0 && accumulated >= target ) {
+			return std::min( MaxMicroseconds, ( 2u << i ) - 1 );
+		}
+	}
+	return MaxMicroseconds;
+}
+
+InputLatencyTracker::InputLatencyTracker() {
+}
+
+void InputLatencyTracker::SetEnabled( bool enabled ) {
+	m_Enabled = enabled;
+	if ( m_Enabled && m_CounterFrequency == 0 ) {
+		m_CounterFrequency = SDL_GetPerformanceFrequency();
+	}
+}
+
+bool InputLatencyTracker::IsEnabled() const {
+	return m_Enabled;
+}
+
+void InputLatencyTracker::Clear() {
+	m_ActionLatency.clear();
+	for ( auto& device : m_DeviceLatency ) {
+		device = InputLatencyStages();
+	}
+}
+
+void InputLatencyTracker::BeginFrame() {
+	m_FirstQueryCounter = 0;
+}
+
+void InputLatencyTracker::MarkQuery() {
+	if ( m_FirstQueryCounter == 0 ) {
+		m_FirstQueryCounter = SDL_GetPerformanceCounter();
+	}
+}
+
+void InputLatencyTracker::Record( ActionIdentifier action, INPUT_TYPE inputType, const InputEventTime& time ) {
+	assert( inputType == INPUT_TYPE_KEYBOARD || InputTypeIsGamepad( inputType ) );
+	Uint64 now		  = SDL_GetPerformanceCounter();
+	Uint64 firstQuery = std::max( m_FirstQueryCounter, time.ReceivedCounter );
+
+	// Injected events may lack an SDL timestamp
+	Uint32 queue	= time.EventTicks != 0 && time.ReceivedTicks >= time.EventTicks ? ( time.ReceivedTicks - time.EventTicks ) * 1000 : 0;
+	Uint32 frame	= CounterToMicroseconds( firstQuery - time.ReceivedCounter );
+	Uint32 consumer = CounterToMicroseconds( now - firstQuery );
+
+	int actionIndex = static_cast<int>( action );
+	if ( actionIndex >= static_cast<int>( m_ActionLatency.size() ) ) {
+		m_ActionLatency.resize( actionIndex + 1 );
+	}
+	InputLatencyStages* stages[] = {
+		&m_ActionLatency[actionIndex],
+		&m_DeviceLatency[static_cast<int>( inputType ) + 1]
+	};
+	for ( InputLatencyStages* stage : stages ) {
+		stage->Queue.Add( queue );
+		stage->Frame.Add( frame );
+		stage->Consumer.Add( consumer );
+		stage->Total.Add( queue + frame + consumer );
+	}
+}
+
+const InputLatencyStages* InputLatencyTracker::GetActionLatency( ActionIdentifier action ) const {
+	int actionIndex = static_cast<int>( action );
+	if ( actionIndex < 0 || actionIndex >= static_cast<int>( m_ActionLatency.size() ) ) {
+		return nullptr;
+	}
+	return &m_ActionLatency[actionIndex];
+}
+
+const InputLatencyStages& InputLatencyTracker::GetDeviceLatency( INPUT_TYPE inputType ) const {
+	assert( inputType == INPUT_TYPE_KEYBOARD || ( InputTypeIsGamepad( inputType ) && inputType < INPUT_MAX_NR_OF_GAMEPADS ) );
+	return m_DeviceLatency[static_cast<int>( inputType ) + 1];
+}
+
+Uint32 InputLatencyTracker::CounterToMicroseconds( Uint64 counter ) const {
+	if ( m_CounterFrequency == 0 ) {
+		return 0;
+	}
+	return static_cast<Uint32>( counter * 1000000 / m_CounterFrequency );
+}
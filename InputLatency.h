@@ -0,0 +1,57 @@
+#pragma once
+
+#include INPUT_ALLOCATION_HEADER
+#include "InputLibraryDefine.h"
+#include "InputStateTypes.h"
+#include "Types.h"
+
+#define INPUT_LATENCY_BUCKET_COUNT 24
+
+// Latencies in microseconds bucketed by power of two. Bucket i holds samples in [2^i, 2^(i+1)).
+struct InputLatencyHistogram {
+	Uint32 Buckets[INPUT_LATENCY_BUCKET_COUNT] = { };
+	Uint32 Count							   = 0;
+	Uint64 TotalMicroseconds				   = 0;
+	Uint32 MaxMicroseconds					   = 0;
+
+	INPUT_API void	 Add ( Uint32 microseconds );
+	INPUT_API void	 Clear ();
+	INPUT_API Uint32 GetAverage () const;
+	// Upper bound of the bucket containing the given percentile [0,1].
+	INPUT_API Uint32 GetPercentile ( float percentile ) const;
+};
+
+// Time from an edge being queued by SDL until an action query observed it, split up per stage.
+struct InputLatencyStages {
+	InputLatencyHistogram Queue;	// SDL event timestamp -> InputState::HandleEvent
+	InputLatencyHistogram Frame;	// InputState::HandleEvent -> first action query of the frame
+	InputLatencyHistogram Consumer;	// First action query of the frame -> query that observed the edge
+	InputLatencyHistogram Total;
+};
+
+class InputLatencyTracker {
+public:
+	INPUT_API InputLatencyTracker ();
+
+	INPUT_API void SetEnabled ( bool enabled );
+	INPUT_API bool IsEnabled () const;
+	INPUT_API void Clear ();
+
+	INPUT_API void BeginFrame ();
+	INPUT_API void MarkQuery ();
+	INPUT_API void Record ( ActionIdentifier action, INPUT_TYPE inputType, const InputEventTime& time );
+
+	// Returns nullptr if nothing has been recorded for the action.
+	INPUT_API const InputLatencyStages* GetActionLatency ( ActionIdentifier action ) const;
+	INPUT_API const InputLatencyStages& GetDeviceLatency ( INPUT_TYPE inputType ) const;
+
+private:
+	Uint32 CounterToMicroseconds ( Uint64 counter ) const;
+
+	bool   m_Enabled		   = false;
+	Uint64 m_CounterFrequency  = 0;
+	Uint64 m_FirstQueryCounter = 0;
+
+	pVector<InputLatencyStages> m_ActionLatency;
+	InputLatencyStages			m_DeviceLatency[INPUT_MAX_NR_OF_GAMEPADS + 1];
+};
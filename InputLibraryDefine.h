@@ -1,6 +1,6 @@
 #pragma once
 
-#ifdef _WIN32
+#if defined( _WIN32 ) && !defined( INPUT_STATIC )
 #ifdef INPUT_DLL_EXPORT
 #define INPUT_API __declspec(dllexport)
 #else
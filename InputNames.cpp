@@ -0,0 +1,296 @@
+#include "InputNames.h"
+#include <SDL2/SDL_version.h>
+
+namespace {
+	struct NameEntry {
+		int			Code;
+		const char* Name;
+	};
+
+	// Same names as SDL_GetScancodeName
+	constexpr NameEntry SCANCODE_NAMES[] = {
+		{ SDL_SCANCODE_A, "A" }, { SDL_SCANCODE_B, "B" }, { SDL_SCANCODE_C, "C" }, { SDL_SCANCODE_D, "D" }, { SDL_SCANCODE_E, "E" },
+		{ SDL_SCANCODE_F, "F" }, { SDL_SCANCODE_G, "G" }, { SDL_SCANCODE_H, "H" }, { SDL_SCANCODE_I, "I" }, { SDL_SCANCODE_J, "J" },
+		{ SDL_SCANCODE_K, "K" }, { SDL_SCANCODE_L, "L" }, { SDL_SCANCODE_M, "M" }, { SDL_SCANCODE_N, "N" }, { SDL_SCANCODE_O, "O" },
+		{ SDL_SCANCODE_P, "P" }, { SDL_SCANCODE_Q, "Q" }, { SDL_SCANCODE_R, "R" }, { SDL_SCANCODE_S, "S" }, { SDL_SCANCODE_T, "T" },
+		{ SDL_SCANCODE_U, "U" }, { SDL_SCANCODE_V, "V" }, { SDL_SCANCODE_W, "W" }, { SDL_SCANCODE_X, "X" }, { SDL_SCANCODE_Y, "Y" },
+		{ SDL_SCANCODE_Z, "Z" },
+		{ SDL_SCANCODE_1, "1" }, { SDL_SCANCODE_2, "2" }, { SDL_SCANCODE_3, "3" }, { SDL_SCANCODE_4, "4" }, { SDL_SCANCODE_5, "5" },
+		{ SDL_SCANCODE_6, "6" }, { SDL_SCANCODE_7, "7" }, { SDL_SCANCODE_8, "8" }, { SDL_SCANCODE_9, "9" }, { SDL_SCANCODE_0, "0" },
+		{ SDL_SCANCODE_RETURN, "Return" }, { SDL_SCANCODE_ESCAPE, "Escape" }, { SDL_SCANCODE_BACKSPACE, "Backspace" },
+		{ SDL_SCANCODE_TAB, "Tab" }, { SDL_SCANCODE_SPACE, "Space" },
+		{ SDL_SCANCODE_MINUS, "-" }, { SDL_SCANCODE_EQUALS, "=" }, { SDL_SCANCODE_LEFTBRACKET, "[" }, { SDL_SCANCODE_RIGHTBRACKET, "]" },
+		{ SDL_SCANCODE_BACKSLASH, "\\" }, { SDL_SCANCODE_NONUSHASH, "#" }, { SDL_SCANCODE_SEMICOLON, ";" }, { SDL_SCANCODE_APOSTROPHE, "'" },
+		{ SDL_SCANCODE_GRAVE, "`" }, { SDL_SCANCODE_COMMA, "," }, { SDL_SCANCODE_PERIOD, "." }, { SDL_SCANCODE_SLASH, "/" },
+		{ SDL_SCANCODE_CAPSLOCK, "CapsLock" },
+		{ SDL_SCANCODE_F1, "F1" }, { SDL_SCANCODE_F2, "F2" }, { SDL_SCANCODE_F3, "F3" }, { SDL_SCANCODE_F4, "F4" },
+		{ SDL_SCANCODE_F5, "F5" }, { SDL_SCANCODE_F6, "F6" }, { SDL_SCANCODE_F7, "F7" }, { SDL_SCANCODE_F8, "F8" },
+		{ SDL_SCANCODE_F9, "F9" }, { SDL_SCANCODE_F10, "F10" }, { SDL_SCANCODE_F11, "F11" }, { SDL_SCANCODE_F12, "F12" },
+		{ SDL_SCANCODE_PRINTSCREEN, "PrintScreen" }, { SDL_SCANCODE_SCROLLLOCK, "ScrollLock" }, { SDL_SCANCODE_PAUSE, "Pause" },
+		{ SDL_SCANCODE_INSERT, "Insert" }, { SDL_SCANCODE_HOME, "Home" }, { SDL_SCANCODE_PAGEUP, "PageUp" },
+		{ SDL_SCANCODE_DELETE, "Delete" }, { SDL_SCANCODE_END, "End" }, { SDL_SCANCODE_PAGEDOWN, "PageDown" },
+		{ SDL_SCANCODE_RIGHT, "Right" }, { SDL_SCANCODE_LEFT, "Left" }, { SDL_SCANCODE_DOWN, "Down" }, { SDL_SCANCODE_UP, "Up" },
+		{ SDL_SCANCODE_NUMLOCKCLEAR, "Numlock" },
+		{ SDL_SCANCODE_KP_DIVIDE, "Keypad /" }, { SDL_SCANCODE_KP_MULTIPLY, "Keypad *" }, { SDL_SCANCODE_KP_MINUS, "Keypad -" },
+		{ SDL_SCANCODE_KP_PLUS, "Keypad +" }, { SDL_SCANCODE_KP_ENTER, "Keypad Enter" },
+		{ SDL_SCANCODE_KP_1, "Keypad 1" }, { SDL_SCANCODE_KP_2, "Keypad 2" }, { SDL_SCANCODE_KP_3, "Keypad 3" },
+		{ SDL_SCANCODE_KP_4, "Keypad 4" }, { SDL_SCANCODE_KP_5, "Keypad 5" }, { SDL_SCANCODE_KP_6, "Keypad 6" },
+		{ SDL_SCANCODE_KP_7, "Keypad 7" }, { SDL_SCANCODE_KP_8, "Keypad 8" }, { SDL_SCANCODE_KP_9, "Keypad 9" },
+		{ SDL_SCANCODE_KP_0, "Keypad 0" }, { SDL_SCANCODE_KP_PERIOD, "Keypad ." },
+		{ SDL_SCANCODE_APPLICATION, "Application" }, { SDL_SCANCODE_POWER, "Power" }, { SDL_SCANCODE_KP_EQUALS, "Keypad =" },
+		{ SDL_SCANCODE_F13, "F13" }, { SDL_SCANCODE_F14, "F14" }, { SDL_SCANCODE_F15, "F15" }, { SDL_SCANCODE_F16, "F16" },
+		{ SDL_SCANCODE_F17, "F17" }, { SDL_SCANCODE_F18, "F18" }, { SDL_SCANCODE_F19, "F19" }, { SDL_SCANCODE_F20, "F20" },
+		{ SDL_SCANCODE_F21, "F21" }, { SDL_SCANCODE_F22, "F22" }, { SDL_SCANCODE_F23, "F23" }, { SDL_SCANCODE_F24, "F24" },
+		{ SDL_SCANCODE_EXECUTE, "Execute" }, { SDL_SCANCODE_HELP, "Help" }, { SDL_SCANCODE_MENU, "Menu" },
+		{ SDL_SCANCODE_SELECT, "Select" }, { SDL_SCANCODE_STOP, "Stop" }, { SDL_SCANCODE_AGAIN, "Again" },
+		{ SDL_SCANCODE_UNDO, "Undo" }, { SDL_SCANCODE_CUT, "Cut" }, { SDL_SCANCODE_COPY, "Copy" }, { SDL_SCANCODE_PASTE, "Paste" },
+		{ SDL_SCANCODE_FIND, "Find" }, { SDL_SCANCODE_MUTE, "Mute" }, { SDL_SCANCODE_VOLUMEUP, "VolumeUp" },
+		{ SDL_SCANCODE_VOLUMEDOWN, "VolumeDown" },
+		{ SDL_SCANCODE_KP_COMMA, "Keypad ," }, { SDL_SCANCODE_KP_EQUALSAS400, "Keypad = (AS400)" },
+		{ SDL_SCANCODE_ALTERASE, "AltErase" }, { SDL_SCANCODE_SYSREQ, "SysReq" }, { SDL_SCANCODE_CANCEL, "Cancel" },
+		{ SDL_SCANCODE_CLEAR, "Clear" }, { SDL_SCANCODE_PRIOR, "Prior" }, { SDL_SCANCODE_RETURN2, "Return" },
+		{ SDL_SCANCODE_SEPARATOR, "Separator" }, { SDL_SCANCODE_OUT, "Out" }, { SDL_SCANCODE_OPER, "Oper" },
+		{ SDL_SCANCODE_CLEARAGAIN, "Clear / Again" }, { SDL_SCANCODE_CRSEL, "CrSel" }, { SDL_SCANCODE_EXSEL, "ExSel" },
+		{ SDL_SCANCODE_KP_00, "Keypad 00" }, { SDL_SCANCODE_KP_000, "Keypad 000" },
+		{ SDL_SCANCODE_THOUSANDSSEPARATOR, "ThousandsSeparator" }, { SDL_SCANCODE_DECIMALSEPARATOR, "DecimalSeparator" },
+		{ SDL_SCANCODE_CURRENCYUNIT, "CurrencyUnit" }, { SDL_SCANCODE_CURRENCYSUBUNIT, "CurrencySubUnit" },
+		{ SDL_SCANCODE_KP_LEFTPAREN, "Keypad (" }, { SDL_SCANCODE_KP_RIGHTPAREN, "Keypad )" },
+		{ SDL_SCANCODE_KP_LEFTBRACE, "Keypad {" }, { SDL_SCANCODE_KP_RIGHTBRACE, "Keypad }" },
+		{ SDL_SCANCODE_KP_TAB, "Keypad Tab" }, { SDL_SCANCODE_KP_BACKSPACE, "Keypad Backspace" },
+		{ SDL_SCANCODE_KP_A, "Keypad A" }, { SDL_SCANCODE_KP_B, "Keypad B" }, { SDL_SCANCODE_KP_C, "Keypad C" },
+		{ SDL_SCANCODE_KP_D, "Keypad D" }, { SDL_SCANCODE_KP_E, "Keypad E" }, { SDL_SCANCODE_KP_F, "Keypad F" },
+		{ SDL_SCANCODE_KP_XOR, "Keypad XOR" }, { SDL_SCANCODE_KP_POWER, "Keypad ^" }, { SDL_SCANCODE_KP_PERCENT, "Keypad %" },
+		{ SDL_SCANCODE_KP_LESS, "Keypad <" }, { SDL_SCANCODE_KP_GREATER, "Keypad >" }, { SDL_SCANCODE_KP_AMPERSAND, "Keypad &" },
+		{ SDL_SCANCODE_KP_DBLAMPERSAND, "Keypad &&" }, { SDL_SCANCODE_KP_VERTICALBAR, "Keypad |" },
+		{ SDL_SCANCODE_KP_DBLVERTICALBAR, "Keypad ||" }, { SDL_SCANCODE_KP_COLON, "Keypad :" }, { SDL_SCANCODE_KP_HASH, "Keypad #" },
+		{ SDL_SCANCODE_KP_SPACE, "Keypad Space" }, { SDL_SCANCODE_KP_AT, "Keypad @" }, { SDL_SCANCODE_KP_EXCLAM, "Keypad !" },
+		{ SDL_SCANCODE_KP_MEMSTORE, "Keypad MemStore" }, { SDL_SCANCODE_KP_MEMRECALL, "Keypad MemRecall" },
+		{ SDL_SCANCODE_KP_MEMCLEAR, "Keypad MemClear" }, { SDL_SCANCODE_KP_MEMADD, "Keypad MemAdd" },
+		{ SDL_SCANCODE_KP_MEMSUBTRACT, "Keypad MemSubtract" }, { SDL_SCANCODE_KP_MEMMULTIPLY, "Keypad MemMultiply" },
+		{ SDL_SCANCODE_KP_MEMDIVIDE, "Keypad MemDivide" }, { SDL_SCANCODE_KP_PLUSMINUS, "Keypad +/-" },
+		{ SDL_SCANCODE_KP_CLEAR, "Keypad Clear" }, { SDL_SCANCODE_KP_CLEARENTRY, "Keypad ClearEntry" },
+		{ SDL_SCANCODE_KP_BINARY, "Keypad Binary" }, { SDL_SCANCODE_KP_OCTAL, "Keypad Octal" },
+		{ SDL_SCANCODE_KP_DECIMAL, "Keypad Decimal" }, { SDL_SCANCODE_KP_HEXADECIMAL, "Keypad Hexadecimal" },
+		{ SDL_SCANCODE_LCTRL, "Left Ctrl" }, { SDL_SCANCODE_LSHIFT, "Left Shift" }, { SDL_SCANCODE_LALT, "Left Alt" },
+		{ SDL_SCANCODE_LGUI, "Left GUI" }, { SDL_SCANCODE_RCTRL, "Right Ctrl" }, { SDL_SCANCODE_RSHIFT, "Right Shift" },
+		{ SDL_SCANCODE_RALT, "Right Alt" }, { SDL_SCANCODE_RGUI, "Right GUI" },
+		{ SDL_SCANCODE_MODE, "ModeSwitch" },
+		{ SDL_SCANCODE_AUDIONEXT, "AudioNext" }, { SDL_SCANCODE_AUDIOPREV, "AudioPrev" }, { SDL_SCANCODE_AUDIOSTOP, "AudioStop" },
+		{ SDL_SCANCODE_AUDIOPLAY, "AudioPlay" }, { SDL_SCANCODE_AUDIOMUTE, "AudioMute" }, { SDL_SCANCODE_MEDIASELECT, "MediaSelect" },
+		{ SDL_SCANCODE_WWW, "WWW" }, { SDL_SCANCODE_MAIL, "Mail" }, { SDL_SCANCODE_CALCULATOR, "Calculator" },
+		{ SDL_SCANCODE_COMPUTER, "Computer" }, { SDL_SCANCODE_AC_SEARCH, "AC Search" }, { SDL_SCANCODE_AC_HOME, "AC Home" },
+		{ SDL_SCANCODE_AC_BACK, "AC Back" }, { SDL_SCANCODE_AC_FORWARD, "AC Forward" }, { SDL_SCANCODE_AC_STOP, "AC Stop" },
+		{ SDL_SCANCODE_AC_REFRESH, "AC Refresh" }, { SDL_SCANCODE_AC_BOOKMARKS, "AC Bookmarks" },
+		{ SDL_SCANCODE_BRIGHTNESSDOWN, "BrightnessDown" }, { SDL_SCANCODE_BRIGHTNESSUP, "BrightnessUp" },
+		{ SDL_SCANCODE_DISPLAYSWITCH, "DisplaySwitch" }, { SDL_SCANCODE_KBDILLUMTOGGLE, "KBDIllumToggle" },
+		{ SDL_SCANCODE_KBDILLUMDOWN, "KBDIllumDown" }, { SDL_SCANCODE_KBDILLUMUP, "KBDIllumUp" },
+		{ SDL_SCANCODE_EJECT, "Eject" }, { SDL_SCANCODE_SLEEP, "Sleep" },
+		{ SDL_SCANCODE_APP1, "App1" }, { SDL_SCANCODE_APP2, "App2" },
+		{ SDL_SCANCODE_AUDIOREWIND, "AudioRewind" }, { SDL_SCANCODE_AUDIOFASTFORWARD, "AudioFastForward" },
+#if SDL_VERSION_ATLEAST( 2, 28, 0 )
+		{ SDL_SCANCODE_SOFTLEFT, "SoftLeft" }, { SDL_SCANCODE_SOFTRIGHT, "SoftRight" },
+		{ SDL_SCANCODE_CALL, "Call" }, { SDL_SCANCODE_ENDCALL, "EndCall" },
+#endif
+	};
+
+	// Same names as SDL_GameControllerGetStringForButton
+	constexpr NameEntry BUTTON_NAMES[] = {
+		{ SDL_CONTROLLER_BUTTON_A, "a" }, { SDL_CONTROLLER_BUTTON_B, "b" }, { SDL_CONTROLLER_BUTTON_X, "x" },
+		{ SDL_CONTROLLER_BUTTON_Y, "y" }, { SDL_CONTROLLER_BUTTON_BACK, "back" }, { SDL_CONTROLLER_BUTTON_GUIDE, "guide" },
+		{ SDL_CONTROLLER_BUTTON_START, "start" }, { SDL_CONTROLLER_BUTTON_LEFTSTICK, "leftstick" },
+		{ SDL_CONTROLLER_BUTTON_RIGHTSTICK, "rightstick" }, { SDL_CONTROLLER_BUTTON_LEFTSHOULDER, "leftshoulder" },
+		{ SDL_CONTROLLER_BUTTON_RIGHTSHOULDER, "rightshoulder" }, { SDL_CONTROLLER_BUTTON_DPAD_UP, "dpup" },
+		{ SDL_CONTROLLER_BUTTON_DPAD_DOWN, "dpdown" }, { SDL_CONTROLLER_BUTTON_DPAD_LEFT, "dpleft" },
+		{ SDL_CONTROLLER_BUTTON_DPAD_RIGHT, "dpright" },
+#if SDL_VERSION_ATLEAST( 2, 0, 14 )
+		{ SDL_CONTROLLER_BUTTON_MISC1, "misc1" }, { SDL_CONTROLLER_BUTTON_PADDLE1, "paddle1" },
+		{ SDL_CONTROLLER_BUTTON_PADDLE2, "paddle2" }, { SDL_CONTROLLER_BUTTON_PADDLE3, "paddle3" },
+		{ SDL_CONTROLLER_BUTTON_PADDLE4, "paddle4" }, { SDL_CONTROLLER_BUTTON_TOUCHPAD, "touchpad" },
+#endif
+	};
+
+	constexpr NameEntry MOUSE_BUTTON_NAMES[] = {
+		{ MOUSE_BUTTON_LEFT, "left" }, { MOUSE_BUTTON_MIDDLE, "middle" }, { MOUSE_BUTTON_RIGHT, "right" },
+		{ MOUSE_BUTTON_4, "x1" }, { MOUSE_BUTTON_5, "x2" },
+	};
+
+	constexpr NameEntry MOUSE_WHEEL_NAMES[] = {
+		{ MOUSE_WHEEL_UP, "wheelup" }, { MOUSE_WHEEL_DOWN, "wheeldown" }, { MOUSE_WHEEL_LEFT, "wheelleft" }, { MOUSE_WHEEL_RIGHT, "wheelright" },
+	};
+
+	constexpr char ToLower( char c ) {
+		return c >= 'A' && c <= 'Z' ? static_cast<char>( c - 'A' + 'a' ) : c;
+	}
+
+	// FNV-1a over the lower case name
+	constexpr Uint32 HashName( const char* name ) {
+		Uint32 hash = 2166136261u;
+		for ( ; *name != '\0'; ++name ) {
+			hash = ( hash ^ static_cast<Uint8>( ToLower( *name ) ) ) * 16777619u;
+		}
+		return hash;
+	}
+
+	// Derives independent hashes from the name hash, one per seed
+	constexpr Uint32 MixHash( Uint32 hash, Uint32 seed ) {
+		hash ^= seed * 0x9E3779B9u;
+		hash ^= hash >> 16;
+		hash *= 0x85EBCA6Bu;
+		hash ^= hash >> 13;
+		hash *= 0xC2B2AE35u;
+		hash ^= hash >> 16;
+		return hash;
+	}
+
+	constexpr bool NamesEqual( const char* lhs, const char* rhs ) {
+		for ( ; *lhs != '\0' && ToLower( *lhs ) == ToLower( *rhs ); ++lhs, ++rhs ) { }
+		return ToLower( *lhs ) == ToLower( *rhs );
+	}
+
+	// Hash and displace: names are split into buckets by their seed 0 hash. Each bucket stores the seed that
+	// places all of its names in free slots, so a lookup is two hashes and one compare.
+	template<size_t NrOfEntries, size_t NrOfSlots, size_t NrOfBuckets, size_t NrOfCodes>
+	struct NameTable {
+		static_assert( NrOfSlots >= NrOfEntries * 2 && ( NrOfSlots & ( NrOfSlots - 1 ) ) == 0, "Slots should be a power of two with room to spare" );
+
+		Uint16		Seeds[NrOfBuckets];
+		Sint16		Slots[NrOfSlots];	// Entry index, -1 if free
+		const char* Names[NrOfCodes];	// By code
+
+		int Find( const char* name, const NameEntry ( &entries )[NrOfEntries] ) const {
+			if ( name == nullptr ) {
+				return -1;
+			}
+			Uint32 hash	 = HashName( name );
+			Sint16 entry = Slots[MixHash( hash, Seeds[MixHash( hash, 0 ) % NrOfBuckets] ) % NrOfSlots];
+			return entry >= 0 && NamesEqual( entries[entry].Name, name ) ? entries[entry].Code : -1;
+		}
+	};
+
+	template<size_t NrOfSlots, size_t NrOfBuckets, size_t NrOfCodes, size_t NrOfEntries>
+	constexpr NameTable<NrOfEntries, NrOfSlots, NrOfBuckets, NrOfCodes> BuildNameTable( const NameEntry ( &entries )[NrOfEntries] ) {
+		NameTable<NrOfEntries, NrOfSlots, NrOfBuckets, NrOfCodes> table = { };
+		for ( size_t i = 0; i < NrOfCodes; ++i ) {
+			table.Names[i] = "";
+		}
+		for ( size_t i = 0; i < NrOfSlots; ++i ) {
+			table.Slots[i] = -1;
+		}
+
+		// Group entries by bucket
+		Uint32 hashes[NrOfEntries]		  = { };
+		size_t bucketOf[NrOfEntries]	  = { };
+		size_t bucketStart[NrOfBuckets + 1] = { };
+		size_t order[NrOfEntries]		  = { };
+		for ( size_t i = 0; i < NrOfEntries; ++i ) {
+			table.Names[entries[i].Code] = entries[i].Name;
+			hashes[i]					 = HashName( entries[i].Name );
+			bucketOf[i]					 = MixHash( hashes[i], 0 ) % NrOfBuckets;
+			++bucketStart[bucketOf[i] + 1];
+		}
+		size_t maxBucketSize = 0;
+		for ( size_t b = 0; b < NrOfBuckets; ++b ) {
+			maxBucketSize	   = bucketStart[b + 1] > maxBucketSize ? bucketStart[b + 1] : maxBucketSize;
+			bucketStart[b + 1] += bucketStart[b];
+		}
+		size_t fill[NrOfBuckets] = { };
+		for ( size_t i = 0; i < NrOfEntries; ++i ) {
+			order[bucketStart[bucketOf[i]] + fill[bucketOf[i]]++] = i;
+		}
+
+		// Largest buckets are placed first while there is the most room
+		for ( size_t size = maxBucketSize; size > 0; --size ) {
+			for ( size_t b = 0; b < NrOfBuckets; ++b ) {
+				if ( bucketStart[b + 1] - bucketStart[b] != size ) {
+					continue;
+				}
+				for ( Uint32 seed = 1;; ++seed ) {
+					size_t placed = 0;
+					bool   fits	  = true;
+					for ( size_t m = bucketStart[b]; m < bucketStart[b + 1] && fits; ++m ) {
+						size_t entry = order[m];
+						bool   duplicate = false;	// Later entries with the same name (RETURN2) only map code to name
+						for ( size_t earlier = bucketStart[b]; earlier < m; ++earlier ) {
+							duplicate |= hashes[order[earlier]] == hashes[entry] && NamesEqual( entries[order[earlier]].Name, entries[entry].Name );
+						}
+						if ( duplicate ) {
+							continue;
+						}
+						size_t slot = MixHash( hashes[entry], seed ) % NrOfSlots;
+						if ( table.Slots[slot] == -1 ) {
+							table.Slots[slot] = static_cast<Sint16>( entry );
+							++placed;
+						} else {
+							fits = false;
+						}
+					}
+					if ( fits ) {
+						table.Seeds[b] = static_cast<Uint16>( seed );
+						break;
+					}
+					// Take back what this seed placed
+					for ( size_t m = bucketStart[b]; m < bucketStart[b + 1] && placed > 0; ++m ) {
+						size_t slot = MixHash( hashes[order[m]], seed ) % NrOfSlots;
+						if ( table.Slots[slot] == static_cast<Sint16>( order[m] ) ) {
+							table.Slots[slot] = -1;
+							--placed;
+						}
+					}
+				}
+			}
+		}
+		return table;
+	}
+
+	constexpr auto SCANCODE_TABLE	  = BuildNameTable<512, 64, SDL_NUM_SCANCODES>( SCANCODE_NAMES );
+	constexpr auto BUTTON_TABLE		  = BuildNameTable<64, 8, SDL_CONTROLLER_BUTTON_MAX>( BUTTON_NAMES );
+	constexpr auto MOUSE_BUTTON_TABLE = BuildNameTable<16, 2, MOUSE_BUTTON_5 + 1>( MOUSE_BUTTON_NAMES );
+	constexpr auto MOUSE_WHEEL_TABLE  = BuildNameTable<16, 2, MOUSE_WHEEL_RIGHT + 1>( MOUSE_WHEEL_NAMES );
+}
+
+SDL_Scancode InputNames::GetScancodeFromName( const char* name ) {
+	int code = SCANCODE_TABLE.Find( name, SCANCODE_NAMES );
+	return code >= 0 ? static_cast<SDL_Scancode>( code ) : SDL_SCANCODE_UNKNOWN;
+}
+
+const char* InputNames::GetScancodeName( SDL_Scancode scancode ) {
+	return scancode >= 0 && scancode < SDL_NUM_SCANCODES ? SCANCODE_TABLE.Names[scancode] : "";
+}
+
+SDL_GameControllerButton InputNames::GetButtonFromName( const char* name ) {
+	int code = BUTTON_TABLE.Find( name, BUTTON_NAMES );
+	return code >= 0 ? static_cast<SDL_GameControllerButton>( code ) : SDL_CONTROLLER_BUTTON_INVALID;
+}
+
+const char* InputNames::GetButtonName( SDL_GameControllerButton button ) {
+	return button >= 0 && button < SDL_CONTROLLER_BUTTON_MAX ? BUTTON_TABLE.Names[button] : "";
+}
+
+bool InputNames::GetMouseButtonFromName( const char* name, MOUSE_BUTTON& button ) {
+	int code = MOUSE_BUTTON_TABLE.Find( name, MOUSE_BUTTON_NAMES );
+	if ( code < 0 ) {
+		return false;
+	}
+	button = static_cast<MOUSE_BUTTON>( code );
+	return true;
+}
+
+const char* InputNames::GetMouseButtonName( MOUSE_BUTTON button ) {
+	return button <= MOUSE_BUTTON_5 ? MOUSE_BUTTON_TABLE.Names[button] : "";
+}
+
+InputBinding InputNames::GetMouseBindingFromName( const char* name ) {
+	MOUSE_BUTTON button;
+	if ( GetMouseButtonFromName( name, button ) ) {
+		return InputBinding::Mouse( button );
+	}
+	int wheel = MOUSE_WHEEL_TABLE.Find( name, MOUSE_WHEEL_NAMES );
+	return wheel >= 0 ? InputBinding::Wheel( static_cast<MOUSE_WHEEL>( wheel ) ) : InputBinding();
+}
+
+const char* InputNames::GetMouseBindingName( InputBinding binding ) {
+	if ( binding.GetDevice() == InputDevice::MouseButton ) {
+		return GetMouseButtonName( binding.GetMouseButton() );
+	}
+	return binding.GetDevice() == InputDevice::MouseWheel && binding.GetMouseWheel() <= MOUSE_WHEEL_RIGHT ? MOUSE_WHEEL_TABLE.Names[binding.GetMouseWheel()] : "";
+}
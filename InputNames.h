@@ -0,0 +1,33 @@
+#pragma once
+
+#include <SDL2/SDL_scancode.h>
+#include <SDL2/SDL_gamecontroller.h>
+#include "InputLibraryDefine.h"
+#include "Types.h"
+#include "InputBinding.h"
+
+// Conversion between input codes and the names used in keybinding configs. Names are the ones SDL uses and
+// are matched case insensitively like SDL_GetScancodeFromName. Lookups go through perfect hash tables built
+// at compile time, so they are O(1), never allocate and don't call into SDL.
+class InputNames {
+public:
+	// SDL_SCANCODE_UNKNOWN if name is unknown.
+	INPUT_API static SDL_Scancode GetScancodeFromName ( const char* name );
+	// Empty string if the scancode has no name.
+	INPUT_API static const char* GetScancodeName ( SDL_Scancode scancode );
+
+	// SDL_CONTROLLER_BUTTON_INVALID if name is unknown.
+	INPUT_API static SDL_GameControllerButton GetButtonFromName ( const char* name );
+	// Empty string if the button has no name.
+	INPUT_API static const char* GetButtonName ( SDL_GameControllerButton button );
+
+	// Returns false if name is unknown.
+	INPUT_API static bool		 GetMouseButtonFromName ( const char* name, MOUSE_BUTTON& button );
+	// Empty string if the button has no name.
+	INPUT_API static const char* GetMouseButtonName ( MOUSE_BUTTON button );
+
+	// Mouse button names plus wheelup, wheeldown, wheelleft and wheelright. Empty binding if name is unknown.
+	INPUT_API static InputBinding GetMouseBindingFromName ( const char* name );
+	// Empty string for bindings that aren't mouse bindings.
+	INPUT_API static const char*  GetMouseBindingName ( InputBinding binding );
+};
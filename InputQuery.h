@@ -0,0 +1,74 @@
+#pragma once
+
+#include <SDL2/SDL_scancode.h>
+#include <SDL2/SDL_gamecontroller.h>
+#include "Types.h"
+
+#define INPUT_KEYBOARD_STATE_WORDS ( ( SDL_NUM_SCANCODES + 63 ) / 64 )
+
+// Plain snapshot of the device state published by InputState every update.
+// Layout is part of the header so queries can be inlined on the caller side.
+struct InputStateBlock {
+	Uint64 KeyboardState[INPUT_KEYBOARD_STATE_WORDS] = { };
+	bool   KeyboardStateTracking = true;
+
+	Uint32 MouseButtonState = 0;
+	int	   MousePositionX	= 0;
+	int	   MousePositionY	= 0;
+
+	Uint32 GamepadButtonState[INPUT_MAX_NR_OF_GAMEPADS] = { };
+	float  GamepadAxis[INPUT_MAX_NR_OF_GAMEPADS][SDL_CONTROLLER_AXIS_MAX] = { };
+};
+
+// Read-only header defined view of an InputStateBlock.
+// Use this instead of the exported InputState/InputContext queries in hot loops.
+class InputQuery {
+public:
+	explicit InputQuery( const InputStateBlock& block )
+		: m_Block( &block ) { }
+
+	bool KeyDown ( SDL_Scancode scanCode ) const {
+		return m_Block->KeyboardStateTracking &&
+			   ( ( m_Block->KeyboardState[scanCode >> 6] >> ( scanCode & 63 ) ) & 1 ) != 0;
+	}
+
+	bool KeyUp ( SDL_Scancode scanCode ) const {
+		return m_Block->KeyboardStateTracking &&
+			   ( ( m_Block->KeyboardState[scanCode >> 6] >> ( scanCode & 63 ) ) & 1 ) == 0;
+	}
+
+	bool MouseButtonDown ( MOUSE_BUTTON button ) const {
+		return ( m_Block->MouseButtonState & SDL_BUTTON( button ) ) != 0;
+	}
+
+	bool MouseButtonUp ( MOUSE_BUTTON button ) const {
+		return ( m_Block->MouseButtonState & SDL_BUTTON( button ) ) == 0;
+	}
+
+	int GetMousePosX () const {
+		return m_Block->MousePositionX;
+	}
+
+	int GetMousePosY () const {
+		return m_Block->MousePositionY;
+	}
+
+	bool ButtonDown ( unsigned int gamepadIndex, SDL_GameControllerButton button ) const {
+		return ( m_Block->GamepadButtonState[gamepadIndex] & ( 1 << button ) ) != 0;
+	}
+
+	bool ButtonUp ( unsigned int gamepadIndex, SDL_GameControllerButton button ) const {
+		return ( m_Block->GamepadButtonState[gamepadIndex] & ( 1 << button ) ) == 0;
+	}
+
+	float GetAxis ( unsigned int gamepadIndex, SDL_GameControllerAxis axis ) const {
+		return m_Block->GamepadAxis[gamepadIndex][axis];
+	}
+
+	const InputStateBlock& GetStateBlock () const {
+		return *m_Block;
+	}
+
+private:
+	const InputStateBlock* m_Block;
+};
@@ -13,10 +13,33 @@ InputState& InputState::GetInstance() {
 	return inputState;
 }
 
-void InputState::Initialize() {
-	if ( SDL_InitSubSystem( SDL_INIT_JOYSTICK | SDL_INIT_HAPTIC | SDL_INIT_GAMECONTROLLER ) != 0 ) {
-		LogInput( "Failed to initialize SDL input subsystem", "SDL", LogSeverity::ERROR_MSG );
-		assert( false );
+InputState::InputState() {
+}
+
+InputState::~InputState() {
+	if ( m_KeyboardState ) {
+		pDeleteArray( m_KeyboardState );
+	}
+	for ( auto& gamepad : m_Gamepads ) {
+		if ( gamepad ) {
+			pDelete( gamepad );
+		}
+	}
+}
+
+void InputState::Initialize( bool initializeSDL ) {
+	if ( initializeSDL ) {
+		if ( SDL_InitSubSystem( SDL_INIT_JOYSTICK | SDL_INIT_HAPTIC | SDL_INIT_GAMECONTROLLER ) != 0 ) {
+			INPUT_LOG( LogSeverity::ERROR_MSG, "SDL", "Failed to initialize SDL input subsystem" );
+			assert( false );
+		}
+		m_SDLInitialized = true;
+	}
+
+	if ( m_KeyboardState == nullptr ) {
+		m_KeyboardStateSize = SDL_NUM_SCANCODES;
+		m_KeyboardState		= pNewArray( Uint8, m_KeyboardStateSize );
+		memset( m_KeyboardState, 0, m_KeyboardStateSize );
 	}
 
 	m_Gamepads.resize( INPUT_MAX_NR_OF_GAMEPADS );
@@ -24,26 +47,44 @@ void InputState::Initialize() {
 }
 
 void InputState::Deinitialize() {
-	SDL_QuitSubSystem( SDL_INIT_JOYSTICK | SDL_INIT_HAPTIC | SDL_INIT_GAMECONTROLLER );
+	if ( m_SDLInitialized ) {
+		SDL_QuitSubSystem( SDL_INIT_JOYSTICK | SDL_INIT_HAPTIC | SDL_INIT_GAMECONTROLLER );
+		m_SDLInitialized = false;
+	}
 	if ( m_Callbacks.size() > 0 ) {
 		rStringStream ss;
 		for ( auto& callback : m_Callbacks ) {
 			ss << static_cast<int>( callback.Handle ) << ", ";
 		}
-		LogInput( "Input state was destructed while still having callbacks registered to it. Callback values: " + ss.str(), "InputState", LogSeverity::WARNING_MSG );
+		INPUT_LOG( LogSeverity::WARNING_MSG, "InputState", "Input state was destructed while still having callbacks registered to it. Callback values: " + ss.str() );
 	}
 	if ( m_KeyboardState ) {
-		pDelete( m_KeyboardState );
+		pDeleteArray( m_KeyboardState );
 		m_KeyboardState = nullptr;
 	}
 	for ( auto& gamepad : m_Gamepads ) {
 		if ( gamepad ) {
 			pDelete( gamepad );
+			gamepad = nullptr;
 		}
 	}
 }
 
 void InputState::Update() {
+	// Headless instances keep the state they were fed instead of polling the process wide SDL state
+	if ( m_SDLInitialized ) {
+		PollSDLState();
+	}
+
+	for ( auto gamepad : m_Gamepads ) {
+		if ( gamepad ) {
+			gamepad->Update();
+		}
+	}
+	PublishGamepadState();
+}
+
+void InputState::PollSDLState() {
 	SDL_PumpEvents();
 
 	if ( m_KeyboardStateTracking ) {
@@ -51,54 +92,85 @@ void InputState::Update() {
 		const Uint8* keyboardState = SDL_GetKeyboardState( &size );
 		if ( m_KeyboardState == nullptr ) {
 			m_KeyboardState = pNewArray( Uint8, size );
+			m_KeyboardStateSize = size;
 		}
-		memcpy( m_KeyboardState, keyboardState, size );
+		memcpy( m_KeyboardState, keyboardState, std::min( size, m_KeyboardStateSize ) );
+		PublishKeyboardState();
 	}
 
 	m_MouseState.ButtonState = SDL_GetMouseState( &m_MouseState.PositionX, &m_MouseState.PositionY );
+	m_StateBlock.MouseButtonState = m_MouseState.ButtonState;
+	m_StateBlock.MousePositionX	  = m_MouseState.PositionX;
+	m_StateBlock.MousePositionY	  = m_MouseState.PositionY;
 	m_MouseInsideWindow		 = SDL_GetMouseFocus() != nullptr;
 	int mouseMoveX, mouseMoveY;
 	SDL_GetRelativeMouseState( &mouseMoveX, &mouseMoveY );
 	m_MouseMoveAccumulationX += mouseMoveX;
 	m_MouseMoveAccumulationY += mouseMoveY;
-
-	for ( auto gamepad : m_Gamepads ) {
-		if ( gamepad ) {
-			gamepad->Update();
-		}
-	}
 }
 
 void InputState::HandleEvent( const SDL_Event &event ) {
+	m_EventTime.EventTicks		= event.common.timestamp;
+	m_EventTime.ReceivedTicks	= SDL_GetTicks();
+	m_EventTime.ReceivedCounter = SDL_GetPerformanceCounter();
+
 	// Process event for this class
 	switch ( event.type ) {
 		case SDL_MOUSEWHEEL: {
 			m_MouseScrollAccumulationX += event.wheel.x;
 			m_MouseScrollAccumulationY += event.wheel.y;
 		} break;
+		case SDL_KEYDOWN:
+		case SDL_KEYUP: {
+			// Headless instances have no SDL keyboard state to poll, so the events are the state
+			if ( !m_SDLInitialized && event.key.keysym.scancode > SDL_SCANCODE_UNKNOWN && event.key.keysym.scancode < m_KeyboardStateSize ) {
+				SetKeyState( event.key.keysym.scancode, event.type == SDL_KEYDOWN ? INPUT_STATE_DOWN : INPUT_STATE_UP );
+			}
+		} break;
+		case SDL_MOUSEBUTTONDOWN:
+		case SDL_MOUSEBUTTONUP: {
+			// As for keys, the events are the only mouse button state a headless instance has
+			if ( !m_SDLInitialized && event.button.button >= MOUSE_BUTTON_LEFT && event.button.button <= MOUSE_BUTTON_5 ) {
+				Uint32 mask = SDL_BUTTON( event.button.button );
+				m_MouseState.ButtonState	  = event.type == SDL_MOUSEBUTTONDOWN ? m_MouseState.ButtonState | mask : m_MouseState.ButtonState & ~mask;
+				m_StateBlock.MouseButtonState = m_MouseState.ButtonState;
+			}
+		} break;
 		case SDL_CONTROLLERDEVICEADDED: {
+			if ( !m_SDLInitialized ) {
+				break;
+			}
+			// A real device takes the slot over from a virtual gamepad
+			GamepadState* previous = m_Gamepads.at( event.cdevice.which );
+			if ( previous != nullptr && previous->IsVirtual() ) {
+				INPUT_LOG( LogSeverity::WARNING_MSG, "GamepadState", "Gamepad " + rToString( event.cdevice.which ) + " replaces the virtual gamepad in its slot" );
+				DetachVirtualGamepad( event.cdevice.which );
+			}
 			SDL_GameController* controller = nullptr;
 			// Open controller so we can use it
 			controller = SDL_GameControllerOpen( event.cdevice.which );
 			if ( controller ) {
 				m_Gamepads.at( event.cdevice.which ) = pNew( GamepadState, controller );
-				LogInput( pString( SDL_GameControllerName( controller ) ) + " " + rToString( event.cdevice.which ) + " added",
-					"GamepadState", LogSeverity::INFO_MSG );
+				INPUT_LOG( LogSeverity::INFO_MSG, "GamepadState", pString( SDL_GameControllerName( controller ) ) + " " + rToString( event.cdevice.which ) + " added" );
 			} else {
-				LogInput( "Could not open gamecontroller " + rToString( event.cdevice.which ) + ": " + SDL_GetError(), "GamepadState",
-					LogSeverity::ERROR_MSG );
+				INPUT_LOG( LogSeverity::ERROR_MSG, "GamepadState", "Could not open gamecontroller " + rToString( event.cdevice.which ) + ": " + SDL_GetError() );
 			}
 		} break;
 		case SDL_CONTROLLERDEVICEREMOVED: {
 			GamepadState* gp = m_Gamepads.at( event.cdevice.which );
 			if ( gp != nullptr ) {
-				LogInput( gp->GetName() + " " + std::to_string( event.cdevice.which ) + " removed", "GamepadState", LogSeverity::INFO_MSG );
+				INPUT_LOG( LogSeverity::INFO_MSG, "GamepadState", gp->GetName() + " " + std::to_string( event.cdevice.which ) + " removed" );
 				m_Gamepads.at( event.cdevice.which ) = nullptr;
 				pDelete( gp );
+				PublishGamepadState();
 			}
 		} break;
 	}
 	// Relay event to callbacks
+	RelayEvent( event );
+}
+
+void InputState::RelayEvent( const SDL_Event& event ) {
 	switch ( event.type ) {
 		case SDL_MOUSEWHEEL: { }
 		case SDL_KEYUP:
@@ -116,7 +188,8 @@ void InputState::HandleEvent( const SDL_Event &event ) {
 		case SDL_FINGERUP:
 		case SDL_FINGERMOTION:	// If you know what i mean ;)
 		case SDL_TEXTEDITING:
-		case SDL_TEXTINPUT: {
+		case SDL_TEXTINPUT:
+		case SDL_WINDOWEVENT: {	// E.g. for the pointer leaving the window
 			for ( auto& callback : m_Callbacks ) {
 				// Will return true if it wants to consume the event
 				if ( callback.Function( event ) ) {
@@ -145,12 +218,16 @@ void InputState::UnregisterEventInterest( InputEventCallbackHandle callbackHandl
 		}
 	}
 	if ( it == m_Callbacks.end() ) {
-		LogInput( "Tried to unregister invalid input event callback handle: " + rToString( static_cast<int>( callbackHandle ) ), "InputState", LogSeverity::WARNING_MSG );
+		INPUT_LOG( LogSeverity::WARNING_MSG, "InputState", "Tried to unregister invalid input event callback handle: " + rToString( static_cast<int>( callbackHandle ) ) );
 	} else {
 		m_Callbacks.erase( it );
 	}
 }
 
+const InputEventTime& InputState::GetEventTime() const {
+	return m_EventTime;
+}
+
 const MouseState& InputState::GetMouseState() const {
 	return m_MouseState;
 }
@@ -163,6 +240,11 @@ int InputState::GetMouseDeltaY( int previousValue ) const {
 	return m_MouseMoveAccumulationY - previousValue;
 }
 
+void InputState::AddMouseMotion( int deltaX, int deltaY ) {
+	m_MouseMoveAccumulationX += deltaX;
+	m_MouseMoveAccumulationY += deltaY;
+}
+
 int InputState::GetMouseDeltaAccumulationX() const {
 	return m_MouseMoveAccumulationX;
 }
@@ -198,22 +280,25 @@ bool InputState::IsMouseButtonUp( MOUSE_BUTTON mouseButton ) const {
 void InputState::SetMouseButtonState( MOUSE_BUTTON mouseButton, INPUT_STATE state ) {
 	// Set the corresponding bit
 	m_MouseState.ButtonState ^= ( -state ^ m_MouseState.ButtonState ) & ( 1 << mouseButton );
+	m_StateBlock.MouseButtonState = m_MouseState.ButtonState;
 }
 
 bool InputState::IsKeyDown( SDL_Scancode scanCode ) const {
-	return m_KeyboardState[scanCode] && m_KeyboardStateTracking;
+	return m_KeyboardState && m_KeyboardState[scanCode] && m_KeyboardStateTracking;
 }
 
 bool InputState::IsKeyUp( SDL_Scancode scanCode ) const {
-	return !m_KeyboardState[scanCode] && m_KeyboardStateTracking;
+	return m_KeyboardState && !m_KeyboardState[scanCode] && m_KeyboardStateTracking;
 }
 
 void InputState::ActivateKeyboardStateTracking() {
 	m_KeyboardStateTracking = true;
+	m_StateBlock.KeyboardStateTracking = true;
 }
 
 void InputState::DeactivateKeyboardStateTracking() {
 	m_KeyboardStateTracking = false;
+	m_StateBlock.KeyboardStateTracking = false;
 }
 
 bool InputState::IsKeyboardStateTrackingActivated() const {
@@ -221,8 +306,14 @@ bool InputState::IsKeyboardStateTrackingActivated() const {
 }
 
 void InputState::SetKeyState( SDL_Scancode scanCode, INPUT_STATE state ) {
-	if ( state != INPUT_STATE_IGNORE ) {
+	if ( state != INPUT_STATE_IGNORE && m_KeyboardState ) {
 		m_KeyboardState[scanCode] = static_cast<int>( state );
+		Uint64 bit = Uint64( 1 ) << ( scanCode & 63 );
+		if ( state == INPUT_STATE_DOWN ) {
+			m_StateBlock.KeyboardState[scanCode >> 6] |= bit;
+		} else {
+			m_StateBlock.KeyboardState[scanCode >> 6] &= ~bit;
+		}
 	}
 }
 
@@ -237,3 +328,97 @@ size_t InputState::GetNrOfGamepads() const {
 	return m_Gamepads.size();
 }
 
+bool InputState::AttachVirtualGamepad( unsigned int gamepadIndex ) {
+	if ( gamepadIndex >= m_Gamepads.size() || m_Gamepads[gamepadIndex] != nullptr ) {
+		INPUT_LOG( LogSeverity::WARNING_MSG, "GamepadState", "Can't attach virtual gamepad to occupied or invalid slot " + rToString( gamepadIndex ) );
+		return false;
+	}
+	m_Gamepads[gamepadIndex] = pNew( GamepadState, nullptr );
+
+	SDL_Event event		= { };
+	event.cdevice.type	= SDL_CONTROLLERDEVICEADDED;
+	event.cdevice.which = gamepadIndex;
+	m_EventTime.EventTicks		= 0;
+	m_EventTime.ReceivedTicks	= SDL_GetTicks();
+	m_EventTime.ReceivedCounter = SDL_GetPerformanceCounter();
+	RelayEvent( event );
+	return true;
+}
+
+void InputState::DetachVirtualGamepad( unsigned int gamepadIndex ) {
+	if ( gamepadIndex >= m_Gamepads.size() ) {
+		return;
+	}
+	GamepadState* gamepad = m_Gamepads[gamepadIndex];
+	if ( gamepad && gamepad->IsVirtual() ) {
+		m_Gamepads[gamepadIndex] = nullptr;
+		pDelete( gamepad );
+		PublishGamepadState();
+
+		SDL_Event event		= { };
+		event.cdevice.type	= SDL_CONTROLLERDEVICEREMOVED;
+		event.cdevice.which = gamepadIndex;
+		RelayEvent( event );
+	}
+}
+
+void InputState::SetVirtualGamepadState( unsigned int gamepadIndex, Uint32 buttonsMask, const float* axes ) {
+	if ( GetGamepadState( gamepadIndex ) == nullptr && !AttachVirtualGamepad( gamepadIndex ) ) {
+		return;
+	}
+	GamepadState* gamepad = m_Gamepads[gamepadIndex];
+	if ( !gamepad->IsVirtual() ) {
+		return;
+	}
+	Uint32 previousMask = gamepad->GetButtonMask();
+	gamepad->SetState( buttonsMask, axes );
+	// Only what the state took, nothing while tracking is deactivated
+	buttonsMask	   = gamepad->GetButtonMask();
+	Uint32 changed = previousMask ^ buttonsMask;
+
+	Uint32 now = SDL_GetTicks();
+	for ( int button = 0; button < SDL_CONTROLLER_BUTTON_MAX; ++button ) {
+		if ( ( changed >> button ) & 1 ) {
+			SDL_Event event		   = { };
+			bool	  down		   = ( ( buttonsMask >> button ) & 1 ) != 0;
+			event.cbutton.type	   = down ? SDL_CONTROLLERBUTTONDOWN : SDL_CONTROLLERBUTTONUP;
+			event.cbutton.timestamp = now;
+			event.cbutton.which	   = gamepadIndex;
+			event.cbutton.button   = static_cast<Uint8>( button );
+			event.cbutton.state	   = down ? SDL_PRESSED : SDL_RELEASED;
+			HandleEvent( event );
+		}
+	}
+	PublishGamepadState();
+}
+
+const InputStateBlock& InputState::GetStateBlock() const {
+	return m_StateBlock;
+}
+
+void InputState::PublishKeyboardState() {
+	std::fill( std::begin( m_StateBlock.KeyboardState ), std::end( m_StateBlock.KeyboardState ), 0 );
+	int size = std::min( m_KeyboardStateSize, static_cast<int>( SDL_NUM_SCANCODES ) );
+	for ( int i = 0; i < size; ++i ) {
+		m_StateBlock.KeyboardState[i >> 6] |= static_cast<Uint64>( m_KeyboardState[i] != 0 ) << ( i & 63 );
+	}
+}
+
+void InputState::PublishGamepadState() {
+	for ( int i = 0; i < INPUT_MAX_NR_OF_GAMEPADS; ++i ) {
+		const GamepadState* gamepad = i < static_cast<int>( m_Gamepads.size() ) ? m_Gamepads[i] : nullptr;
+		float* axis = m_StateBlock.GamepadAxis[i];
+		if ( gamepad ) {
+			m_StateBlock.GamepadButtonState[i]	 = gamepad->GetButtonMask();
+			axis[SDL_CONTROLLER_AXIS_LEFTX]		 = gamepad->GetLeftStickX();
+			axis[SDL_CONTROLLER_AXIS_LEFTY]		 = gamepad->GetLeftStickY();
+			axis[SDL_CONTROLLER_AXIS_RIGHTX]	 = gamepad->GetRightStickX();
+			axis[SDL_CONTROLLER_AXIS_RIGHTY]	 = gamepad->GetRightStickY();
+			axis[SDL_CONTROLLER_AXIS_TRIGGERLEFT]  = gamepad->GetLeftTrigger();
+			axis[SDL_CONTROLLER_AXIS_TRIGGERRIGHT] = gamepad->GetRightTrigger();
+		} else {
+			m_StateBlock.GamepadButtonState[i] = 0;
+			std::fill( axis, axis + SDL_CONTROLLER_AXIS_MAX, 0.0f );
+		}
+	}
+}
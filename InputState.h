@@ -4,6 +4,7 @@
 #include "InputStateTypes.h"
 #include INPUT_ALLOCATION_HEADER
 #include "Types.h"
+#include "InputQuery.h"
 
 #define g_InputState InputState::GetInstance()
 
@@ -11,15 +12,25 @@ class GamepadState;
 
 class InputState {
 public:
+	// Default instance. Create more InputStates to run several independent input pipelines in one process.
 	INPUT_API static InputState& GetInstance ();
 
-	INPUT_API void Initialize ();
+	INPUT_API InputState();
+	INPUT_API ~InputState();
+
+	InputState( const InputState& rhs ) = delete;
+	InputState& operator = ( const InputState& rhs ) = delete;
+
+	// Headless instances skip SDL and are only fed through HandleEvent, SetKeyState and virtual gamepads.
+	INPUT_API void Initialize ( bool initializeSDL = true );
 	INPUT_API void Deinitialize ();
 
 	INPUT_API void					   Update ();
 	INPUT_API void					   HandleEvent ( const SDL_Event& event );
 	INPUT_API InputEventCallbackHandle RegisterEventInterest ( InputEventCallbackFunction callbackFunction, int priority = 0 );
 	INPUT_API void					   UnregisterEventInterest ( InputEventCallbackHandle callbackHandle );
+	// Time of the event currently being relayed by HandleEvent.
+	INPUT_API const InputEventTime&	   GetEventTime () const;
 
 
 	INPUT_API const MouseState& GetMouseState () const;
@@ -34,6 +45,8 @@ public:
 	INPUT_API bool				IsMouseButtonDown ( MOUSE_BUTTON mouseButton ) const;
 	INPUT_API bool				IsMouseButtonUp ( MOUSE_BUTTON mouseButton ) const;
 	INPUT_API void 				SetMouseButtonState( MOUSE_BUTTON mouseButton, INPUT_STATE state );
+	// Relative motion that did not come from SDL, e.g. replayed or remote input.
+	INPUT_API void				AddMouseMotion ( int deltaX, int deltaY );
 
 	INPUT_API bool IsKeyDown ( SDL_Scancode scanCode ) const;
 	INPUT_API bool IsKeyUp ( SDL_Scancode scanCode ) const;
@@ -45,13 +58,20 @@ public:
 	INPUT_API const GamepadState* GetGamepadState ( unsigned int gamepadIndex ) const;
 	INPUT_API size_t			  GetNrOfGamepads () const;
 
-private:
-	InputState() { }
+	// Virtual gamepads have no SDL device behind them and are driven by SetVirtualGamepadState, e.g. for remote players.
+	INPUT_API bool AttachVirtualGamepad ( unsigned int gamepadIndex );
+	INPUT_API void DetachVirtualGamepad ( unsigned int gamepadIndex );
+	// Attaches the gamepad if needed. Button changes are relayed as controller button events.
+	INPUT_API void SetVirtualGamepadState ( unsigned int gamepadIndex, Uint32 buttonsMask, const float* axes );
 
-	~InputState() { }
+	// State block republished every Update. Wrap it in an InputQuery for inlined queries.
+	INPUT_API const InputStateBlock& GetStateBlock () const;
 
-	InputState( const InputState& rhs );
-	InputState& operator = ( const InputState& rhs );
+private:
+	void PollSDLState ();
+	void RelayEvent ( const SDL_Event& event );
+	void PublishKeyboardState ();
+	void PublishGamepadState ();
 
 	struct CallbackEntry {
 		int Priority;
@@ -59,10 +79,14 @@ private:
 		InputEventCallbackFunction Function;
 	};
 
+	bool m_SDLInitialized = false;
+
 	pVector<CallbackEntry> m_Callbacks;
 	int m_NextHandle = 0;
+	InputEventTime m_EventTime;
 
 	Uint8* m_KeyboardState		   = nullptr;
+	int	   m_KeyboardStateSize	   = 0;
 	bool   m_KeyboardStateTracking = true;
 
 	MouseState m_MouseState;
@@ -73,5 +97,7 @@ private:
 	int		   m_MouseScrollAccumulationY = 0;
 
 	rVector<GamepadState*> m_Gamepads;
+
+	InputStateBlock m_StateBlock;
 };
 
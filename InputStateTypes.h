@@ -25,3 +25,26 @@ enum INPUT_STATE {
 typedef const Uint8* KeyboardState;
 
 typedef Uint32 GamepadButtonState;
+
+// When an event happened and when InputState::HandleEvent received it.
+struct InputEventTime {
+	Uint32 EventTicks	   = 0;	// SDL event timestamp (SDL_GetTicks base)
+	Uint32 ReceivedTicks   = 0;	// SDL_GetTicks at HandleEvent
+	Uint64 ReceivedCounter = 0;	// SDL_GetPerformanceCounter at HandleEvent
+
+	// Injected events may not carry an SDL timestamp
+	Uint32 GetTicks() const {
+		return EventTicks != 0 ? EventTicks : ReceivedTicks;
+	}
+};
+
+// Interval [BeginTicks, EndTicks) in SDL ticks that edge queries are restricted to while active.
+struct InputTickWindow {
+	bool   Active	  = false;
+	Uint32 BeginTicks = 0;
+	Uint32 EndTicks	  = 0;
+
+	bool Contains( Uint32 ticks ) const {
+		return !Active || ( ticks - BeginTicks < EndTicks - BeginTicks );
+	}
+};
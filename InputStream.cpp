@@ -0,0 +1,255 @@
+#include "InputStream.h"
+#include <cassert>
+#include <algorithm>
+#include "InputHistory.h"
+#include "InputState.h"
+#include "InputContext.h"
+#include "KeyBindings.h"
+
+#define INPUT_STREAM_BASELINE_BITS		6
+#define INPUT_STREAM_SPARSE_MAX_BITS	8
+
+InputBitWriter::InputBitWriter( pVector<Uint8>& buffer )
+	: m_Buffer( buffer ), m_BitPosition( buffer.size() * 8 ) {
+}
+
+void InputBitWriter::WriteBits( Uint64 value, int nrOfBits ) {
+	for ( int i = 0; i < nrOfBits; ++i ) {
+		if ( ( m_BitPosition & 7 ) == 0 ) {
+			m_Buffer.push_back( 0 );
+		}
+		m_Buffer.back() |= static_cast<Uint8>( ( ( value >> i ) & 1 ) << ( m_BitPosition & 7 ) );
+		++m_BitPosition;
+	}
+}
+
+void InputBitWriter::WriteBool( bool value ) {
+	WriteBits( value ? 1 : 0, 1 );
+}
+
+void InputBitWriter::WriteVarInt( Sint32 value ) {
+	Uint32 zigzag = ( static_cast<Uint32>( value ) << 1 ) ^ static_cast<Uint32>( value >> 31 );
+	do {
+		WriteBits( zigzag & 7, 3 );
+		zigzag >>= 3;
+		WriteBool( zigzag != 0 );
+	} while ( zigzag != 0 );
+}
+
+InputBitReader::InputBitReader( const Uint8* data, size_t size )
+	: m_Data( data ), m_Size( size ) {
+}
+
+Uint64 InputBitReader::ReadBits( int nrOfBits ) {
+	Uint64 value = 0;
+	for ( int i = 0; i < nrOfBits; ++i ) {
+		if ( ( m_BitPosition >> 3 ) >= m_Size ) {
+			m_Overflowed = true;
+			return 0;
+		}
+		value |= static_cast<Uint64>( ( m_Data[m_BitPosition >> 3] >> ( m_BitPosition & 7 ) ) & 1 ) << i;
+		++m_BitPosition;
+	}
+	return value;
+}
+
+bool InputBitReader::ReadBool() {
+	return ReadBits( 1 ) != 0;
+}
+
+Sint32 InputBitReader::ReadVarInt() {
+	Uint32 zigzag = 0;
+	int	   shift  = 0;
+	do {
+		zigzag |= static_cast<Uint32>( ReadBits( 3 ) ) << shift;
+		shift  += 3;
+	} while ( ReadBool() && shift < 33 && !m_Overflowed );
+	return static_cast<Sint32>( ( zigzag >> 1 ) ^ ( ~( zigzag & 1 ) + 1 ) );
+}
+
+bool InputBitReader::HasOverflowed() const {
+	return m_Overflowed;
+}
+
+namespace {
+	Sint16 QuantizeStreamAxis( Sint16 value, int axisBits ) {
+		int shift = 16 - axisBits;
+		return static_cast<Sint16>( ( value >> shift ) * ( 1 << shift ) );
+	}
+
+	void WriteActionWord( InputBitWriter& writer, Uint64 changed ) {
+		int nrOfChanged = 0;
+		for ( Uint64 bits = changed; bits != 0; bits &= bits - 1 ) {
+			++nrOfChanged;
+		}
+		// Few toggled actions are cheaper to send as indices
+		if ( nrOfChanged <= INPUT_STREAM_SPARSE_MAX_BITS ) {
+			writer.WriteBool( false );
+			writer.WriteBits( nrOfChanged - 1, 3 );
+			for ( int bit = 0; bit < 64; ++bit ) {
+				if ( ( changed >> bit ) & 1 ) {
+					writer.WriteBits( bit, 6 );
+				}
+			}
+		} else {
+			writer.WriteBool( true );
+			writer.WriteBits( changed, 64 );
+		}
+	}
+
+	Uint64 ReadActionWord( InputBitReader& reader ) {
+		if ( reader.ReadBool() ) {
+			return reader.ReadBits( 64 );
+		}
+		Uint64 changed	   = 0;
+		int	   nrOfChanged = static_cast<int>( reader.ReadBits( 3 ) ) + 1;
+		for ( int i = 0; i < nrOfChanged; ++i ) {
+			changed |= Uint64( 1 ) << reader.ReadBits( 6 );
+		}
+		return changed;
+	}
+}
+
+InputStreamEncoder::InputStreamEncoder( int axisBits )
+	: m_AxisBits( axisBits ) {
+	assert( axisBits > 0 && axisBits <= 16 );
+}
+
+void InputStreamEncoder::Capture( InputStreamFrame& frame, const KeyBindings& keyBindings, InputContext& input, BindContextHandle bindContext,
+								  INPUT_TYPE inputType, int nrOfActions ) {
+	assert( nrOfActions <= INPUT_STREAM_MAX_ACTION_WORDS * 64 );
+	std::fill( std::begin( frame.ActionBits ), std::end( frame.ActionBits ), 0 );
+	for ( int action = 0; action < nrOfActions; ++action ) {
+		if ( keyBindings.ActionDown( input, bindContext, static_cast<ActionIdentifier>( action ), inputType ) ) {
+			frame.ActionBits[action >> 6] |= Uint64( 1 ) << ( action & 63 );
+		}
+	}
+	const InputStateBlock& block = input.GetInputState().GetStateBlock();
+	frame.GamepadButtons = InputTypeIsGamepad( inputType ) ? block.GamepadButtonState[inputType] : 0;
+	for ( int axis = 0; axis < SDL_CONTROLLER_AXIS_MAX; ++axis ) {
+		frame.GamepadAxes[axis] = InputTypeIsGamepad( inputType ) ? InputHistory::QuantizeAxis( block.GamepadAxis[inputType][axis] ) : 0;
+	}
+	frame.MouseDeltaX = static_cast<Sint16>( std::max( -32768, std::min( 32767, input.GetMousePosDeltaX() ) ) );
+	frame.MouseDeltaY = static_cast<Sint16>( std::max( -32768, std::min( 32767, input.GetMousePosDeltaY() ) ) );
+}
+
+void InputStreamEncoder::Encode( const InputStreamFrame& frame, pVector<Uint8>& packet ) {
+	// Keep what the receiver will reconstruct so later deltas are taken against the same values
+	InputStreamFrame sent = frame;
+	for ( auto& axis : sent.GamepadAxes ) {
+		axis = QuantizeStreamAxis( axis, m_AxisBits );
+	}
+
+	static const InputStreamFrame emptyFrame;
+	const InputStreamFrame* baseline = &emptyFrame;
+	Uint32 baselineOffset = frame.Sequence - m_AcknowledgedSequence;
+	const InputStreamFrame& acknowledged = m_Sent[m_AcknowledgedSequence % INPUT_STREAM_HISTORY_SIZE];
+	bool hasBaseline = m_HasAcknowledged && baselineOffset > 0 && baselineOffset < INPUT_STREAM_HISTORY_SIZE &&
+					   acknowledged.Sequence == m_AcknowledgedSequence;
+	if ( hasBaseline ) {
+		baseline = &acknowledged;
+	}
+
+	InputBitWriter writer( packet );
+	writer.WriteBits( frame.Sequence, 32 );
+	writer.WriteBool( hasBaseline );
+	if ( hasBaseline ) {
+		writer.WriteBits( baselineOffset, INPUT_STREAM_BASELINE_BITS );
+	}
+	for ( int word = 0; word < INPUT_STREAM_MAX_ACTION_WORDS; ++word ) {
+		Uint64 changed = sent.ActionBits[word] ^ baseline->ActionBits[word];
+		writer.WriteBool( changed != 0 );
+		if ( changed != 0 ) {
+			WriteActionWord( writer, changed );
+		}
+	}
+	Uint32 changedButtons = sent.GamepadButtons ^ baseline->GamepadButtons;
+	writer.WriteBool( changedButtons != 0 );
+	if ( changedButtons != 0 ) {
+		writer.WriteBits( changedButtons, SDL_CONTROLLER_BUTTON_MAX );
+	}
+	for ( int axis = 0; axis < SDL_CONTROLLER_AXIS_MAX; ++axis ) {
+		bool changed = sent.GamepadAxes[axis] != baseline->GamepadAxes[axis];
+		writer.WriteBool( changed );
+		if ( changed ) {
+			writer.WriteBits( static_cast<Uint16>( sent.GamepadAxes[axis] ) >> ( 16 - m_AxisBits ), m_AxisBits );
+		}
+	}
+	writer.WriteVarInt( sent.MouseDeltaX );
+	writer.WriteVarInt( sent.MouseDeltaY );
+
+	m_Sent[frame.Sequence % INPUT_STREAM_HISTORY_SIZE] = sent;
+}
+
+void InputStreamEncoder::Acknowledge( Uint32 sequence ) {
+	if ( !m_HasAcknowledged || static_cast<Sint32>( sequence - m_AcknowledgedSequence ) > 0 ) {
+		m_AcknowledgedSequence = sequence;
+		m_HasAcknowledged	   = true;
+	}
+}
+
+InputStreamDecoder::InputStreamDecoder( int axisBits )
+	: m_AxisBits( axisBits ) {
+	assert( axisBits > 0 && axisBits <= 16 );
+}
+
+bool InputStreamDecoder::Decode( const Uint8* data, size_t size, InputStreamFrame& frame ) {
+	InputBitReader reader( data, size );
+	InputStreamFrame decoded;
+	decoded.Sequence = static_cast<Uint32>( reader.ReadBits( 32 ) );
+	if ( reader.ReadBool() ) {
+		Uint32 baselineSequence = decoded.Sequence - static_cast<Uint32>( reader.ReadBits( INPUT_STREAM_BASELINE_BITS ) );
+		int	   baselineSlot		= baselineSequence % INPUT_STREAM_HISTORY_SIZE;
+		if ( !m_ReceivedValid[baselineSlot] || m_Received[baselineSlot].Sequence != baselineSequence ) {
+			return false;
+		}
+		Uint32 sequence = decoded.Sequence;
+		decoded			 = m_Received[baselineSlot];
+		decoded.Sequence = sequence;
+	}
+	for ( int word = 0; word < INPUT_STREAM_MAX_ACTION_WORDS; ++word ) {
+		if ( reader.ReadBool() ) {
+			decoded.ActionBits[word] ^= ReadActionWord( reader );
+		}
+	}
+	if ( reader.ReadBool() ) {
+		decoded.GamepadButtons ^= static_cast<Uint32>( reader.ReadBits( SDL_CONTROLLER_BUTTON_MAX ) );
+	}
+	for ( int axis = 0; axis < SDL_CONTROLLER_AXIS_MAX; ++axis ) {
+		if ( reader.ReadBool() ) {
+			Uint16 quantized = static_cast<Uint16>( reader.ReadBits( m_AxisBits ) << ( 16 - m_AxisBits ) );
+			decoded.GamepadAxes[axis] = static_cast<Sint16>( quantized );
+		}
+	}
+	decoded.MouseDeltaX = static_cast<Sint16>( reader.ReadVarInt() );
+	decoded.MouseDeltaY = static_cast<Sint16>( reader.ReadVarInt() );
+	if ( reader.HasOverflowed() ) {
+		return false;
+	}
+
+	int slot = decoded.Sequence % INPUT_STREAM_HISTORY_SIZE;
+	m_Received[slot]	  = decoded;
+	m_ReceivedValid[slot] = true;
+	if ( !m_HasDecoded || static_cast<Sint32>( decoded.Sequence - m_LatestSequence ) > 0 ) {
+		m_LatestSequence = decoded.Sequence;
+		m_HasDecoded	 = true;
+	}
+	frame = decoded;
+	return true;
+}
+
+Uint32 InputStreamDecoder::GetLatestSequence() const {
+	return m_LatestSequence;
+}
+
+void InputStreamDecoder::ApplyToGamepad( InputState& inputState, unsigned int gamepadIndex, const InputStreamFrame& frame ) const {
+	float axes[SDL_CONTROLLER_AXIS_MAX];
+	for ( int axis = 0; axis < SDL_CONTROLLER_AXIS_MAX; ++axis ) {
+		axes[axis] = InputHistory::DequantizeAxis( frame.GamepadAxes[axis] );
+	}
+	inputState.SetVirtualGamepadState( gamepadIndex, frame.GamepadButtons, axes );
+}
+
+void InputStreamDecoder::ApplyToMouse( InputState& inputState, const InputStreamFrame& frame ) const {
+	inputState.AddMouseMotion( frame.MouseDeltaX, frame.MouseDeltaY );
+}
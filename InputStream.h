@@ -0,0 +1,97 @@
+#pragma once
+
+#include <SDL2/SDL_gamecontroller.h>
+#include INPUT_ALLOCATION_HEADER
+#include "InputLibraryDefine.h"
+#include "Types.h"
+
+class KeyBindings;
+class InputContext;
+class InputState;
+
+// Enough for the 200 actions a binding collection can hold
+#define INPUT_STREAM_MAX_ACTION_WORDS	4
+// Number of sent/received frames remembered for use as delta baselines
+#define INPUT_STREAM_HISTORY_SIZE		64
+
+// One frame of input as sent from a client.
+struct InputStreamFrame {
+	Uint32 Sequence										= 0;
+	Uint64 ActionBits[INPUT_STREAM_MAX_ACTION_WORDS]	= { };
+	Uint32 GamepadButtons								= 0;
+	Sint16 GamepadAxes[SDL_CONTROLLER_AXIS_MAX]			= { };	// See InputHistory::QuantizeAxis
+	Sint16 MouseDeltaX									= 0;
+	Sint16 MouseDeltaY									= 0;
+};
+
+class InputBitWriter {
+public:
+	INPUT_API InputBitWriter( pVector<Uint8>& buffer );
+
+	INPUT_API void WriteBits ( Uint64 value, int nrOfBits );
+	INPUT_API void WriteBool ( bool value );
+	// Zigzag encoded in groups of three bits, each followed by a continuation bit.
+	INPUT_API void WriteVarInt ( Sint32 value );
+
+private:
+	pVector<Uint8>& m_Buffer;
+	size_t			m_BitPosition;
+};
+
+class InputBitReader {
+public:
+	INPUT_API InputBitReader( const Uint8* data, size_t size );
+
+	INPUT_API Uint64 ReadBits ( int nrOfBits );
+	INPUT_API bool	 ReadBool ();
+	INPUT_API Sint32 ReadVarInt ();
+	// True if a read went past the end of the data.
+	INPUT_API bool	 HasOverflowed () const;
+
+private:
+	const Uint8* m_Data;
+	size_t		 m_Size;
+	size_t		 m_BitPosition = 0;
+	bool		 m_Overflowed  = false;
+};
+
+// Encodes frames as bit packed deltas against the newest frame the receiver acknowledged.
+class InputStreamEncoder {
+public:
+	INPUT_API InputStreamEncoder( int axisBits = 8 );
+
+	// Samples actions, gamepad and mouse motion of inputType into frame. Sequence is left untouched.
+	INPUT_API static void Capture ( InputStreamFrame& frame, const KeyBindings& keyBindings, InputContext& input, BindContextHandle bindContext,
+									INPUT_TYPE inputType, int nrOfActions );
+
+	// Appends the encoded frame to packet.
+	INPUT_API void Encode ( const InputStreamFrame& frame, pVector<Uint8>& packet );
+	INPUT_API void Acknowledge ( Uint32 sequence );
+
+private:
+	int				 m_AxisBits;
+	bool			 m_HasAcknowledged	  = false;
+	Uint32			 m_AcknowledgedSequence = 0;
+	InputStreamFrame m_Sent[INPUT_STREAM_HISTORY_SIZE];
+};
+
+class InputStreamDecoder {
+public:
+	INPUT_API InputStreamDecoder( int axisBits = 8 );
+
+	// Returns false if the packet is malformed or its baseline is no longer known.
+	INPUT_API bool	 Decode ( const Uint8* data, size_t size, InputStreamFrame& frame );
+	// Newest decoded sequence, to be sent back to the encoder as acknowledgement.
+	INPUT_API Uint32 GetLatestSequence () const;
+	// Feeds gamepad buttons and axes into a virtual gamepad so KeyBindings queries for that INPUT_TYPE see the remote input.
+	INPUT_API void	 ApplyToGamepad ( InputState& inputState, unsigned int gamepadIndex, const InputStreamFrame& frame ) const;
+	// Adds the mouse motion of frame so InputContext mouse deltas see the remote input on their next Update.
+	INPUT_API void	 ApplyToMouse ( InputState& inputState, const InputStreamFrame& frame ) const;
+
+private:
+	int				 m_AxisBits;
+	bool			 m_HasDecoded	  = false;
+	Uint32			 m_LatestSequence = 0;
+	InputStreamFrame m_Received[INPUT_STREAM_HISTORY_SIZE];
+	bool			 m_ReceivedValid[INPUT_STREAM_HISTORY_SIZE] = { };
+};
@@ -0,0 +1,189 @@
+#include "KeyBindingCache.h"
+#include <cstring>
+#include <fstream>
+#include "BindContext.h"
+#include "LogInput.h"
+
+#define KEY_BINDING_CACHE_MAGIC		0x4342424Bu	// "KBBC"
+#define KEY_BINDING_CACHE_VERSION	4u
+
+namespace {
+	const Uint64 FNV_OFFSET_BASIS = 14695981039346656037ull;
+	const Uint64 FNV_PRIME		  = 1099511628211ull;
+
+	void HashBytes( Uint64& hash, const void* data, size_t size ) {
+		const Uint8* bytes = static_cast<const Uint8*>( data );
+		for ( size_t i = 0; i < size; ++i ) {
+			hash = ( hash ^ bytes[i] ) * FNV_PRIME;
+		}
+	}
+
+	void HashInt( Uint64& hash, Sint32 value ) {
+		HashBytes( hash, &value, sizeof( value ) );
+	}
+
+	void HashString( Uint64& hash, const char* value, size_t length ) {
+		HashInt( hash, static_cast<Sint32>( length ) );
+		HashBytes( hash, value, length );
+	}
+
+	void HashString( Uint64& hash, const rString& value ) {
+		HashString( hash, value.data(), value.size() );
+	}
+
+	struct CacheHeader {
+		Uint32 Magic;
+		Uint32 Version;
+		Uint64 Hash;
+		Uint32 NrOfContexts;
+		Uint32 NrOfRecords;
+	};
+
+	// One per action and context, then one per player button
+	struct CacheRecord {
+		Uint32 Context;
+		Sint32 Action;
+		Sint16 Primary;
+		Sint16 Secondary;
+		Sint16 Button;
+		Uint16 Mouse;	// InputBinding value
+		Sint32 Player;	// -1 for the shared bindings, else only Button is used
+	};
+}
+
+Uint64 KeyBindingCache::ComputeHash( const rString& configContents, const pVector<BindContext*>& contexts ) {
+	Uint64 hash = FNV_OFFSET_BASIS;
+	HashInt( hash, KEY_BINDING_CACHE_VERSION );
+	HashString( hash, configContents );
+	for ( const BindContext* context : contexts ) {
+		if ( context == nullptr ) {
+			HashInt( hash, -1 );
+			continue;
+		}
+		HashString( hash, context->GetName() );
+		HashInt( hash, static_cast<Sint32>( context->GetActions().size() ) );
+		for ( const auto& action : context->GetActions() ) {
+			HashString( hash, context->GetStrings().Get( action.Name ), context->GetStrings().GetLength( action.Name ) );
+			HashInt( hash, static_cast<int>( action.Action ) );
+			HashInt( hash, action.DefaultScancode );
+			HashInt( hash, action.DefaultButton );
+		}
+	}
+	return hash;
+}
+
+bool KeyBindingCache::Load( const rString& cachePath, Uint64 hash, pVector<BindContext*>& contexts ) {
+	rString data;
+	if ( !ReadFile( cachePath, data ) || data.size() < sizeof( CacheHeader ) ) {
+		return false;
+	}
+	CacheHeader header;
+	memcpy( &header, data.data(), sizeof( header ) );
+	if ( header.Magic != KEY_BINDING_CACHE_MAGIC || header.Version != KEY_BINDING_CACHE_VERSION || header.Hash != hash ||
+		 header.NrOfContexts != contexts.size() || data.size() != sizeof( CacheHeader ) + header.NrOfRecords * sizeof( CacheRecord ) ) {
+		return false;
+	}
+
+	const char* records = data.data() + sizeof( CacheHeader );
+	for ( Uint32 i = 0; i < header.NrOfRecords; ++i ) {
+		CacheRecord record;
+		memcpy( &record, records + i * sizeof( CacheRecord ), sizeof( record ) );
+		if ( record.Context >= contexts.size() || contexts[record.Context] == nullptr || record.Player >= INPUT_MAX_NR_OF_GAMEPADS ) {
+			return false;
+		}
+	}
+	// The cached player buttons replace the current ones, as loading the config does
+	for ( BindContext* context : contexts ) {
+		if ( context ) {
+			for ( int player = 0; player < INPUT_MAX_NR_OF_GAMEPADS; ++player ) {
+				context->ResetPlayerBindings( static_cast<INPUT_TYPE>( player ) );
+			}
+		}
+	}
+	for ( Uint32 i = 0; i < header.NrOfRecords; ++i ) {
+		CacheRecord record;
+		memcpy( &record, records + i * sizeof( CacheRecord ), sizeof( record ) );
+		BindContext*	 context = contexts[record.Context];
+		ActionIdentifier action = static_cast<ActionIdentifier>( record.Action );
+		if ( record.Player >= 0 ) {
+			context->SetPlayerButton( static_cast<INPUT_TYPE>( record.Player ), action, static_cast<SDL_GameControllerButton>( record.Button ), true );
+			continue;
+		}
+		if ( record.Primary != SDL_SCANCODE_UNKNOWN ) {
+			context->GetEditableKeyBindCollection().BindAction( action, static_cast<SDL_Scancode>( record.Primary ), KeyBindingType::Primary, true );
+		}
+		if ( record.Secondary != SDL_SCANCODE_UNKNOWN ) {
+			context->GetEditableKeyBindCollection().BindAction( action, static_cast<SDL_Scancode>( record.Secondary ), KeyBindingType::Secondary, true );
+		}
+		if ( record.Mouse != 0 ) {
+			context->GetEditableKeyBindCollection().BindMouse( action, InputBinding::FromValue( record.Mouse ), true );
+		}
+		if ( record.Button != SDL_CONTROLLER_BUTTON_INVALID ) {
+			context->GetEditableGamepadBindCollection().BindAction( action, static_cast<SDL_GameControllerButton>( record.Button ), true );
+		}
+	}
+	return true;
+}
+
+bool KeyBindingCache::Save( const rString& cachePath, Uint64 hash, const pVector<BindContext*>& contexts ) {
+	pVector<CacheRecord> records;
+	for ( size_t i = 0; i < contexts.size(); ++i ) {
+		if ( contexts[i] == nullptr ) {
+			continue;
+		}
+		const KeyBindingCollection&		keys	= contexts[i]->GetKeyBindCollection();
+		const GamepadBindingCollection& buttons = contexts[i]->GetGamepadBindCollection();
+		for ( const auto& mapping : contexts[i]->GetActions() ) {
+			ActionIdentifier action = mapping.Action;
+			int				 index	= static_cast<int>( action );
+			CacheRecord		 record = { };
+			record.Context	 = static_cast<Uint32>( i );
+			record.Action	 = index;
+			record.Primary	 = static_cast<Sint16>( index < static_cast<int>( keys.GetPrimaryBindings().size() ) ? keys.GetPrimaryBindings()[index] : SDL_SCANCODE_UNKNOWN );
+			record.Secondary = static_cast<Sint16>( index < static_cast<int>( keys.GetSecondaryBindings().size() ) ? keys.GetSecondaryBindings()[index] : SDL_SCANCODE_UNKNOWN );
+			record.Button	 = static_cast<Sint16>( buttons.GetButtonFromAction( action ) );
+			record.Mouse	 = keys.GetMouseBindingFromAction( action ).GetValue();
+			record.Player	 = -1;
+			records.push_back( record );
+		}
+		for ( const BindContext::PlayerButton& entry : contexts[i]->GetPlayerButtons() ) {
+			CacheRecord record = { };
+			record.Context	   = static_cast<Uint32>( i );
+			record.Action	   = static_cast<int>( entry.Action );
+			record.Button	   = static_cast<Sint16>( entry.Button );
+			record.Player	   = entry.Player;
+			records.push_back( record );
+		}
+	}
+
+	CacheHeader header = { KEY_BINDING_CACHE_MAGIC, KEY_BINDING_CACHE_VERSION, hash, static_cast<Uint32>( contexts.size() ),
+						   static_cast<Uint32>( records.size() ) };
+	std::ofstream file( cachePath, std::ios::binary | std::ios::trunc );
+	if ( !file ) {
+		INPUT_LOG( LogSeverity::WARNING_MSG, "KeyBindings", "Failed to write keybinding cache " + cachePath );
+		return false;
+	}
+	file.write( reinterpret_cast<const char*>( &header ), sizeof( header ) );
+	file.write( reinterpret_cast<const char*>( records.data() ), records.size() * sizeof( CacheRecord ) );
+	return static_cast<bool>( file );
+}
+
+Uint64 KeyBindingCache::HashContents( const rString& contents ) {
+	Uint64 hash = FNV_OFFSET_BASIS;
+	HashBytes( hash, contents.data(), contents.size() );
+	return hash;
+}
+
+bool KeyBindingCache::ReadFile( const rString& path, rString& contents ) {
+	std::ifstream file( path, std::ios::binary | std::ios::ate );
+	if ( !file ) {
+		return false;
+	}
+	std::streamoff size = file.tellg();
+	if ( size < 0 ) {
+		return false;
+	}
+	contents.resize( static_cast<size_t>( size ) );
+	file.seekg( 0 );
+	return static_cast<bool>( file.read( &contents[0], size ) ) || size == 0;
+}
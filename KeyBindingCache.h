@@ -0,0 +1,26 @@
+#pragma once
+
+#include INPUT_ALLOCATION_HEADER
+#include "Types.h"
+
+class BindContext;
+
+// Binary cache of the bindings resolved from a text keybinding config, stored next to it as <configPath>.bin.
+// The cache is keyed by a hash of the config file and the registered actions, so it is only used while neither
+// changed. It is checked before the config is parsed, a hit loads the bindings without parsing the text at all.
+class KeyBindingCache {
+public:
+	// Hash of the config file's contents and every context's name, actions and defaults.
+	static Uint64 ComputeHash ( const rString& configContents, const pVector<BindContext*>& contexts );
+
+	// Applies the cached bindings and player buttons to contexts. Returns false, leaving contexts untouched, if the
+	// cache is missing or stale.
+	static bool Load ( const rString& cachePath, Uint64 hash, pVector<BindContext*>& contexts );
+	static bool Save ( const rString& cachePath, Uint64 hash, const pVector<BindContext*>& contexts );
+
+	// Hash of a whole file's contents.
+	static Uint64 HashContents ( const rString& contents );
+
+	// Reads a whole file with a single read. Returns false if it can't be opened.
+	static bool ReadFile ( const rString& path, rString& contents );
+};
@@ -1,23 +1,130 @@
 #include "KeyBindingCollection.h"
+#include <algorithm>
 #include <cassert>
-#include <SDL2/SDL_keyboard.h>
+#include "InputNames.h"
 #include "LogInput.h"
 #include "KeyBindings.h"
+#include "BindingIndex.h"
 
-KeyBindingCollection::KeyBindingCollection() {
+KeyBindingCollection::KeyBindingCollection( const KeyBindings* owner )
+	: m_Owner( owner ) {
 	m_ScancodeToAction.clear();
 }
 
+KeyBindingCollection::KeyBindingCollection( const KeyBindingCollection& other )
+	: m_Owner( other.m_Owner ), m_ScancodeToAction( other.m_ScancodeToAction ), m_ActionToScancodePrimary( other.m_ActionToScancodePrimary ),
+	  m_ActionToScancodeSecondary( other.m_ActionToScancodeSecondary ), m_ActionToMouse( other.m_ActionToMouse ), m_Revision( other.m_Revision ) {
+	std::copy( other.m_MouseToAction, other.m_MouseToAction + INPUT_NR_OF_MOUSE_BINDINGS, m_MouseToAction );
+}
+
 KeyBindingCollection::~KeyBindingCollection() {
+	IndexBindings( false );
+}
+
+KeyBindingCollection& KeyBindingCollection::operator = ( const KeyBindingCollection& other ) {
+	if ( this != &other ) {
+		IndexBindings( false );
+		m_Owner						= other.m_Owner;
+		m_ScancodeToAction			= other.m_ScancodeToAction;
+		m_ActionToScancodePrimary	= other.m_ActionToScancodePrimary;
+		m_ActionToScancodeSecondary = other.m_ActionToScancodeSecondary;
+		m_ActionToMouse				= other.m_ActionToMouse;
+		std::copy( other.m_MouseToAction, other.m_MouseToAction + INPUT_NR_OF_MOUSE_BINDINGS, m_MouseToAction );
+		++m_Revision;
+		IndexBindings( true );
+	}
+	return *this;
+}
+
+void KeyBindingCollection::SetOwner( const KeyBindings* owner ) {
+	m_Owner = owner;
+}
+
+void KeyBindingCollection::SetIndex( BindingIndex* index, BindContextHandle context ) {
+	IndexBindings( false );
+	m_Index		   = index;
+	m_IndexContext = context;
+	IndexBindings( true );
+}
+
+void KeyBindingCollection::Swap( KeyBindingCollection& other ) {
+	IndexBindings( false );
+	other.IndexBindings( false );
+	m_ScancodeToAction.swap( other.m_ScancodeToAction );
+	m_ActionToScancodePrimary.swap( other.m_ActionToScancodePrimary );
+	m_ActionToScancodeSecondary.swap( other.m_ActionToScancodeSecondary );
+	m_ActionToMouse.swap( other.m_ActionToMouse );
+	std::swap_ranges( m_MouseToAction, m_MouseToAction + INPUT_NR_OF_MOUSE_BINDINGS, other.m_MouseToAction );
+	++m_Revision;
+	++other.m_Revision;
+	IndexBindings( true );
+	other.IndexBindings( true );
+}
+
+void KeyBindingCollection::IndexBindings( bool add ) {
+	if ( m_Index == nullptr ) {
+		return;
+	}
+	for ( size_t i = 0; i < m_ActionToScancodePrimary.size(); ++i ) {
+		ActionIdentifier action = static_cast<ActionIdentifier>( static_cast<int>( i ) );
+		for ( KeyBindingType slot : { KeyBindingType::Primary, KeyBindingType::Secondary } ) {
+			SDL_Scancode scancode = ( slot == KeyBindingType::Primary ? m_ActionToScancodePrimary : m_ActionToScancodeSecondary )[i];
+			if ( add ) {
+				m_Index->AddScancodeUse( scancode, BindingUse { m_IndexContext, action, slot } );
+			} else {
+				m_Index->RemoveScancodeUse( scancode, BindingUse { m_IndexContext, action, slot } );
+			}
+		}
+	}
+	for ( size_t i = 0; i < m_ActionToMouse.size(); ++i ) {
+		BindingUse use { m_IndexContext, static_cast<ActionIdentifier>( static_cast<int>( i ) ), KeyBindingType::Primary };
+		if ( add ) {
+			m_Index->AddMouseUse( m_ActionToMouse[i], use );
+		} else {
+			m_Index->RemoveMouseUse( m_ActionToMouse[i], use );
+		}
+	}
+}
+
+void KeyBindingCollection::Assign( const rVector<SDL_Scancode>& primary, const rVector<SDL_Scancode>& secondary, const rVector<InputBinding>& mouse ) {
+	IndexBindings( false );
+	m_ActionToScancodePrimary	= primary;
+	m_ActionToScancodeSecondary = secondary;
+	m_ActionToMouse				= mouse;
+	size_t nrOfActions = std::max( { primary.size(), secondary.size(), mouse.size() } );
+	m_ActionToScancodePrimary.resize( nrOfActions, SDL_SCANCODE_UNKNOWN );
+	m_ActionToScancodeSecondary.resize( nrOfActions, SDL_SCANCODE_UNKNOWN );
+	m_ActionToMouse.resize( nrOfActions );
+	m_ScancodeToAction.clear();
+	std::fill( m_MouseToAction, m_MouseToAction + INPUT_NR_OF_MOUSE_BINDINGS, ActionIdentifier() );
+	for ( size_t action = 0; action < nrOfActions; ++action ) {
+		if ( m_ActionToMouse[action].GetMouseIndex() >= 0 ) {
+			m_MouseToAction[m_ActionToMouse[action].GetMouseIndex()] = static_cast<ActionIdentifier>( static_cast<int>( action ) );
+		}
+		if ( m_ActionToScancodePrimary[action] != SDL_SCANCODE_UNKNOWN ) {
+			m_ScancodeToAction[m_ActionToScancodePrimary[action]] = static_cast<ActionIdentifier>( static_cast<int>( action ) );
+		}
+		if ( m_ActionToScancodeSecondary[action] != SDL_SCANCODE_UNKNOWN ) {
+			m_ScancodeToAction[m_ActionToScancodeSecondary[action]] = static_cast<ActionIdentifier>( static_cast<int>( action ) );
+		}
+	}
+	++m_Revision;
+	IndexBindings( true );
+}
+
+const char* KeyBindingCollection::GetDescription( ActionIdentifier action ) const {
+	// Collections made outside a bind context have no owner and describe their actions through the default instance
+	const KeyBindings& owner = m_Owner ? *m_Owner : g_KeyBindings;
+	return static_cast<int>( action ) >= 0 && static_cast<int>( action ) < owner.GetNrOfActions() ? owner.GetDescription( action ) : "";
 }
 
 bool KeyBindingCollection::AddMappingWithName( const rString& keyName, ActionIdentifier action, KeyBindingType keyBindType, bool overwrite,
 											   bool clearConflicting, rString* errorString ) {
-	SDL_Scancode scanCode = SDL_GetScancodeFromName( keyName.c_str() );
+	SDL_Scancode scanCode = InputNames::GetScancodeFromName( keyName.c_str() );
 	if ( scanCode != SDL_SCANCODE_UNKNOWN ) {
 		return AddMappingWithScancode( scanCode, action, keyBindType, overwrite, clearConflicting, errorString );
 	} else {
-		LogInput( "Failed to get scancode from name: " + keyName, "KeyBindings", LogSeverity::WARNING_MSG );
+		INPUT_LOG( LogSeverity::WARNING_MSG, "KeyBindings", "Failed to get scancode from name: " + keyName );
 		if ( errorString != nullptr ) {
 			*errorString = "Failed to get scancode from name: " + keyName;
 		}
@@ -31,32 +138,29 @@ bool KeyBindingCollection::AddMappingWithScancode( SDL_Scancode scancode, Action
 	auto keyIt = m_ScancodeToAction.find( scancode );
 	// Warn about overwriting duplicate keybindings
 	if ( keyIt != m_ScancodeToAction.end() && !clearConflicting ) {
-		LogInput( "Can't bind key: \"" + rString( SDL_GetScancodeName( scancode ) ) + "\" to action " + g_KeyBindings.GetDescription( action ) +
-				  " because it is already bound to action \"" + g_KeyBindings.GetDescription( keyIt->second ) + "\"",
-				  "KeyBindings", LogSeverity::WARNING_MSG );
+		INPUT_LOG( LogSeverity::WARNING_MSG, "KeyBindings", "Can't bind key: \"" + rString( InputNames::GetScancodeName( scancode ) ) + "\" to action " + GetDescription( action ) +
+				  " because it is already bound to action \"" + GetDescription( keyIt->second ) + "\"" );
 		if ( errorString != nullptr ) {
-			*errorString = "Can't bind key: \"" + rString( SDL_GetScancodeName( scancode ) ) + "\" to action " +
-						   g_KeyBindings.GetDescription( action ) + " because it is already bound to action \"" +
-						   g_KeyBindings.GetDescription( keyIt->second ) + "\"";
+			*errorString = "Can't bind key: \"" + rString( InputNames::GetScancodeName( scancode ) ) + "\" to action " +
+						   GetDescription( action ) + " because it is already bound to action \"" +
+						   GetDescription( keyIt->second ) + "\"";
 		}
 		return false;
 	} else {
 		// Try to key to action
 		if ( BindAction( action, scancode, keyBindType, overwrite ) ) {
-			LogInput( "Bound key \"" + rString( SDL_GetScancodeName( scancode ) ) + "\" to action \"" + g_KeyBindings.GetDescription( action ) + "\"",
-					  "KeyBindings", LogSeverity::DEBUG_MSG );
+			INPUT_LOG( LogSeverity::DEBUG_MSG, "KeyBindings", "Bound key \"" + rString( InputNames::GetScancodeName( scancode ) ) + "\" to action \"" + GetDescription( action ) + "\"" );
 			if ( errorString != nullptr ) {
 				*errorString =
-				"Bound key \"" + rString( SDL_GetScancodeName( scancode ) ) + "\" to action \"" + g_KeyBindings.GetDescription( action ) + "\"";
+				"Bound key \"" + rString( InputNames::GetScancodeName( scancode ) ) + "\" to action \"" + GetDescription( action ) + "\"";
 			}
 			return true;
 		} else {
-			LogInput( "Can't bind key: \"" + rString( SDL_GetScancodeName( scancode ) ) + "\" to action \"" +
-					  g_KeyBindings.GetDescription( action ) + "\" because no free bind slots are avaliable",
-					  "KeyBindings", LogSeverity::WARNING_MSG );
+			INPUT_LOG( LogSeverity::WARNING_MSG, "KeyBindings", "Can't bind key: \"" + rString( InputNames::GetScancodeName( scancode ) ) + "\" to action \"" +
+					  GetDescription( action ) + "\" because no free bind slots are avaliable" );
 			if ( errorString != nullptr ) {
-				*errorString = "Can't bind key: \"" + rString( SDL_GetScancodeName( scancode ) ) + "\" to action \"" +
-							   g_KeyBindings.GetDescription( action ) + "\" because no free bind slots are avaliable";
+				*errorString = "Can't bind key: \"" + rString( InputNames::GetScancodeName( scancode ) ) + "\" to action \"" +
+							   GetDescription( action ) + "\" because no free bind slots are avaliable";
 			}
 			return false;
 		}
@@ -72,6 +176,9 @@ bool KeyBindingCollection::BindAction( ActionIdentifier action, SDL_Scancode sca
 	auto freePrevious = [this, action, scancode]( bool primary ) {
 		SDL_Scancode previousCode = ( primary ? m_ActionToScancodePrimary : m_ActionToScancodeSecondary )[static_cast<int>( action )];
 		if ( previousCode != SDL_SCANCODE_UNKNOWN ) {
+			if ( m_Index ) {
+				m_Index->RemoveScancodeUse( previousCode, BindingUse { m_IndexContext, action, primary ? KeyBindingType::Primary : KeyBindingType::Secondary } );
+			}
 			auto it = m_ScancodeToAction.find( previousCode );
 			if ( it != m_ScancodeToAction.end() ) {
 				m_ScancodeToAction.erase( it );
@@ -82,11 +189,19 @@ bool KeyBindingCollection::BindAction( ActionIdentifier action, SDL_Scancode sca
 		freePrevious( true );
 		m_ActionToScancodePrimary[static_cast<int>( action )] = scancode;
 		m_ScancodeToAction[scancode] = action;
+		if ( m_Index ) {
+			m_Index->AddScancodeUse( scancode, BindingUse { m_IndexContext, action, KeyBindingType::Primary } );
+		}
+		++m_Revision;
 	};
 	auto addSecondaryBinding = [this, action, scancode, &freePrevious]() {
 		freePrevious( false );
 		m_ActionToScancodeSecondary[static_cast<int>( action )] = scancode;
 		m_ScancodeToAction[scancode] = action;
+		if ( m_Index ) {
+			m_Index->AddScancodeUse( scancode, BindingUse { m_IndexContext, action, KeyBindingType::Secondary } );
+		}
+		++m_Revision;
 	};
 
 	if ( overwrite ) {
@@ -129,6 +244,68 @@ bool KeyBindingCollection::BindAction( ActionIdentifier action, SDL_Scancode sca
 	}
 }
 
+bool KeyBindingCollection::BindMouse( ActionIdentifier action, InputBinding binding, bool overwrite ) {
+	if ( binding.IsValid() && binding.GetMouseIndex() < 0 ) {
+		return false;
+	}
+	FillTheVoid( action );
+	InputBinding& slot = m_ActionToMouse[static_cast<int>( action )];
+	if ( slot.IsValid() && !overwrite ) {
+		return false;
+	}
+	if ( slot.IsValid() && m_MouseToAction[slot.GetMouseIndex()] == action ) {
+		m_MouseToAction[slot.GetMouseIndex()] = ActionIdentifier();
+	}
+	if ( m_Index ) {
+		m_Index->RemoveMouseUse( slot, BindingUse { m_IndexContext, action, KeyBindingType::Primary } );
+	}
+	slot = binding;
+	if ( binding.IsValid() ) {
+		// Unlike keys, a mouse input is taken from the action that had it
+		ActionIdentifier& owner = m_MouseToAction[binding.GetMouseIndex()];
+		if ( owner != ActionIdentifier() && owner != action ) {
+			m_ActionToMouse[static_cast<int>( owner )] = InputBinding();
+			if ( m_Index ) {
+				m_Index->RemoveMouseUse( binding, BindingUse { m_IndexContext, owner, KeyBindingType::Primary } );
+			}
+		}
+		owner = action;
+		if ( m_Index ) {
+			m_Index->AddMouseUse( binding, BindingUse { m_IndexContext, action, KeyBindingType::Primary } );
+		}
+	}
+	++m_Revision;
+	return true;
+}
+
+bool KeyBindingCollection::Bind( ActionIdentifier action, InputBinding binding, KeyBindingType keyBindType, bool overwrite ) {
+	if ( binding.GetDevice() == InputDevice::Key ) {
+		return BindAction( action, binding.GetScancode(), keyBindType, overwrite );
+	}
+	if ( binding.IsMouse() ) {
+		return BindMouse( action, binding, overwrite );
+	}
+	return false;
+}
+
+InputBinding KeyBindingCollection::GetMouseBindingFromAction( ActionIdentifier action ) const {
+	int index = static_cast<int>( action );
+	return index >= 0 && index < static_cast<int>( m_ActionToMouse.size() ) ? m_ActionToMouse[index] : InputBinding();
+}
+
+ActionIdentifier KeyBindingCollection::GetActionFromMouseBinding( InputBinding binding ) const {
+	int index = binding.GetMouseIndex();
+	return index >= 0 ? m_MouseToAction[index] : ActionIdentifier();
+}
+
+const rVector<InputBinding>& KeyBindingCollection::GetMouseBindings() const {
+	return m_ActionToMouse;
+}
+
+Uint32 KeyBindingCollection::GetRevision() const {
+	return m_Revision;
+}
+
 const rVector<SDL_Scancode>& KeyBindingCollection::GetPrimaryBindings() const {
 	return m_ActionToScancodePrimary;
 }
@@ -146,7 +323,7 @@ ActionIdentifier KeyBindingCollection::GetGetActionFromScancode( SDL_Scancode sc
 }
 
 const rString KeyBindingCollection::GetScancodeNameForAction( ActionIdentifier action, KeyBindingType bindType ) const {
-	return rString( SDL_GetScancodeName(
+	return rString( InputNames::GetScancodeName(
 	( bindType == KeyBindingType::Primary ? m_ActionToScancodePrimary : m_ActionToScancodeSecondary ).at( static_cast<int>( action ) ) ) );
 }
 
@@ -171,4 +348,7 @@ void KeyBindingCollection::FillTheVoid( ActionIdentifier action ) {
 	};
 	fillVoid( action, m_ActionToScancodePrimary );
 	fillVoid( action, m_ActionToScancodeSecondary );
+	if ( static_cast<int>( action ) >= m_ActionToMouse.size() ) {
+		m_ActionToMouse.resize( static_cast<int>( action ) + 1 );
+	}
 }
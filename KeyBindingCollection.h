@@ -2,11 +2,19 @@
 #include <SDL2/SDL_scancode.h>
 #include "InputLibraryDefine.h"
 #include "Types.h"
+#include "InputBinding.h"
+
+class KeyBindings;
+class BindingIndex;
 
 class KeyBindingCollection {
 public:
-	INPUT_API KeyBindingCollection();
+	// Action descriptions used in log messages are looked up in owner, or in the default KeyBindings if null.
+	INPUT_API KeyBindingCollection( const KeyBindings* owner = nullptr );
+	// Copies are not registered with the index of the original.
+	INPUT_API KeyBindingCollection( const KeyBindingCollection& other );
 	INPUT_API ~KeyBindingCollection();
+	INPUT_API KeyBindingCollection& operator = ( const KeyBindingCollection& other );
 
 	INPUT_API bool AddMappingWithName( const rString& keyName, ActionIdentifier action,
 			KeyBindingType keyBindType = KeyBindingType::Any, bool overwrite = false,
@@ -25,13 +33,40 @@ public:
 	INPUT_API SDL_Scancode						GetSecondaryScancodeFromAction( ActionIdentifier action ) const;
 
 	INPUT_API bool BindAction( ActionIdentifier action, SDL_Scancode scancode, KeyBindingType keyBindType, bool overwrite );
+	// Each action has one mouse slot, for a mouse button or wheel direction. An empty binding with overwrite unbinds it.
+	// Binding a mouse input unbinds it from the action that had it.
+	INPUT_API bool BindMouse( ActionIdentifier action, InputBinding binding, bool overwrite );
+	// Binds keys to the key slots given by keyBindType and mouse inputs to the mouse slot.
+	INPUT_API bool Bind( ActionIdentifier action, InputBinding binding, KeyBindingType keyBindType = KeyBindingType::Any, bool overwrite = false );
+	INPUT_API InputBinding					GetMouseBindingFromAction( ActionIdentifier action ) const;
+	INPUT_API ActionIdentifier				GetActionFromMouseBinding( InputBinding binding ) const;
+	INPUT_API const rVector<InputBinding>&	GetMouseBindings( ) const;
+	// Incremented whenever a binding changes.
+	INPUT_API Uint32 GetRevision() const;
+
+	INPUT_API void SetOwner( const KeyBindings* owner );
+	// Keeps index up to date with the bindings of this collection as those of context. Null to stop.
+	INPUT_API void SetIndex( BindingIndex* index, BindContextHandle context );
+	// Exchanges bindings with other without copying. Owners are kept.
+	INPUT_API void Swap( KeyBindingCollection& other );
+	// Replaces all bindings with the given per action scancodes and mouse inputs. Neither may repeat.
+	INPUT_API void Assign( const rVector<SDL_Scancode>& primary, const rVector<SDL_Scancode>& secondary, const rVector<InputBinding>& mouse );
 
 private:
-	void FillTheVoid( ActionIdentifier action );
+	void		   FillTheVoid( ActionIdentifier action );
+	const char*	   GetDescription( ActionIdentifier action ) const;
+	void		   IndexBindings( bool add );
+
+	const KeyBindings* m_Owner;
+	BindingIndex*	   m_Index = nullptr;
+	BindContextHandle  m_IndexContext;
 
 	rMap<SDL_Scancode, ActionIdentifier> m_ScancodeToAction;
 	rVector<SDL_Scancode> m_ActionToScancodePrimary;
 	rVector<SDL_Scancode> m_ActionToScancodeSecondary;
+	rVector<InputBinding> m_ActionToMouse;
+	ActionIdentifier	  m_MouseToAction[INPUT_NR_OF_MOUSE_BINDINGS];
+	Uint32 m_Revision = 0;
 
 	static const size_t mc_OverflowLimit = 200;
 };
@@ -0,0 +1,272 @@
+#include "KeyBindingReloader.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sys/stat.h>
+#include <utility/Config.h>
+#include "KeyBindingCache.h"
+#include "KeyBindings.h"
+#include "LogInput.h"
+
+#ifdef __linux__
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif
+
+namespace {
+	// How long the watcher thread sleeps between checks of the stop flag
+	const int WATCH_INTERVAL_MS = 100;
+}
+
+KeyBindingReloader::ActionSnapshot::~ActionSnapshot() {
+	for ( BindContext* context : Contexts ) {
+		pDelete( context );
+	}
+}
+
+KeyBindingReloader::ParsedBindings::~ParsedBindings() {
+	for ( BindContext* context : Contexts ) {
+		pDelete( context );
+	}
+}
+
+KeyBindingReloader::KeyBindingReloader( KeyBindings& keyBindings, InputContext& input )
+	: m_KeyBindings( keyBindings ), m_Input( input ) {
+}
+
+KeyBindingReloader::~KeyBindingReloader() {
+	Stop();
+}
+
+bool KeyBindingReloader::Start( const rString& configPath ) {
+	if ( IsRunning() ) {
+		INPUT_LOG( LogSeverity::WARNING_MSG, "KeyBindings", "Keybinding reloader is already watching " + m_ConfigPath );
+		return false;
+	}
+	m_ConfigPath = configPath == "" ? m_KeyBindings.GetConfigPath() : configPath;
+	TakeSnapshot();
+
+	m_StopRequested	  = false;
+	m_ReloadRequested = false;
+	m_Thread		  = std::thread( &KeyBindingReloader::WatchLoop, this );
+	m_UpdateCallbackHandle = m_Input.RegisterUpdateInterest( [this]() { Apply(); } );
+	return true;
+}
+
+void KeyBindingReloader::Stop() {
+	if ( !IsRunning() ) {
+		return;
+	}
+	m_Input.UnregisterUpdateInterest( m_UpdateCallbackHandle );
+	m_UpdateCallbackHandle = InputUpdateCallbackHandle::invalid();
+
+	m_StopRequested = true;
+	m_Thread.join();
+
+	ParsedBindings* pending = m_Pending.exchange( nullptr );
+	if ( pending ) {
+		pDelete( pending );
+	}
+}
+
+bool KeyBindingReloader::IsRunning() const {
+	return m_Thread.joinable();
+}
+
+void KeyBindingReloader::RequestReload() {
+	m_ReloadRequested = true;
+}
+
+int KeyBindingReloader::GetNrOfReloads() const {
+	return m_NrOfReloads;
+}
+
+void KeyBindingReloader::TakeSnapshot() {
+	std::shared_ptr<ActionSnapshot> snapshot = std::make_shared<ActionSnapshot>();
+	snapshot->ActionRevision = m_KeyBindings.GetActionRevision();
+	snapshot->Descriptions.reserve( m_KeyBindings.GetNrOfActions() );
+	for ( int i = 0; i < m_KeyBindings.GetNrOfActions(); ++i ) {
+		snapshot->Descriptions.push_back( m_KeyBindings.GetDescription( static_cast<ActionIdentifier>( i ) ) );
+	}
+	snapshot->Contexts.resize( m_KeyBindings.GetNrOfBindContexts(), nullptr );
+	for ( int i = 0; i < m_KeyBindings.GetNrOfBindContexts(); ++i ) {
+		const BindContext* context = m_KeyBindings.GetBindContext( static_cast<BindContextHandle>( i ) );
+		if ( context ) {
+			snapshot->Contexts[i] = pNew( BindContext, context->GetName() );
+			snapshot->Contexts[i]->CopyActions( *context );
+		}
+	}
+	m_SnapshotRevision = snapshot->ActionRevision;
+
+	std::lock_guard<std::mutex> lock( m_SnapshotLock );
+	m_Snapshot = snapshot;
+}
+
+void KeyBindingReloader::Apply() {
+	pVector<pString> warnings;
+	{
+		std::lock_guard<std::mutex> lock( m_WarningLock );
+		warnings.swap( m_Warnings );
+	}
+	for ( const pString& warning : warnings ) {
+		INPUT_LOG( LogSeverity::WARNING_MSG, "KeyBindings", warning );
+	}
+
+	if ( m_KeyBindings.GetActionRevision() != m_SnapshotRevision ) {
+		TakeSnapshot();
+	}
+
+	ParsedBindings* parsed = m_Pending.exchange( nullptr );
+	if ( !parsed ) {
+		return;
+	}
+	if ( !parsed->Requested && m_KeyBindings.IsOwnConfigWrite( m_ConfigPath, parsed->ContentHash ) ) {
+		// Our own save, applying it would undo rebinds made since SaveConfig
+		pDelete( parsed );
+		return;
+	}
+	if ( parsed->ActionRevision != m_SnapshotRevision ) {
+		// Actions changed while parsing, parse again against the new snapshot
+		pDelete( parsed );
+		m_ReloadRequested = true;
+		return;
+	}
+
+	for ( const pString& warning : parsed->Warnings ) {
+		INPUT_LOG( LogSeverity::WARNING_MSG, "KeyBindings", warning );
+	}
+	for ( size_t i = 0; i < parsed->Contexts.size(); ++i ) {
+		BindContext* context = m_KeyBindings.GetBindContext( static_cast<BindContextHandle>( static_cast<int>( i ) ) );
+		if ( context && parsed->Contexts[i] ) {
+			context->SwapBindings( *parsed->Contexts[i] );
+		}
+	}
+	++m_NrOfReloads;
+	INPUT_LOG( LogSeverity::DEBUG_MSG, "KeyBindings", "Reloaded keybindings from " + m_ConfigPath );
+	pDelete( parsed );	// Holds the previous bindings after the swap
+}
+
+void KeyBindingReloader::WatchLoop() {
+#ifdef __linux__
+	// Watch the directory rather than the file since editors often save by replacing the file
+	size_t	separator = m_ConfigPath.find_last_of( '/' );
+	pString directory = separator == pString::npos ? "." : m_ConfigPath.substr( 0, separator + 1 );
+	pString fileName  = separator == pString::npos ? m_ConfigPath : m_ConfigPath.substr( separator + 1 );
+
+	int fd = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+	if ( fd < 0 || inotify_add_watch( fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE ) < 0 ) {
+		if ( fd >= 0 ) {
+			close( fd );
+		}
+		fd = -1;
+	}
+
+	if ( fd >= 0 ) {
+		alignas( inotify_event ) char buffer[4096];
+		while ( !m_StopRequested ) {
+			pollfd pollDescriptor = { fd, POLLIN, 0 };
+			bool   changed		  = false;
+			if ( poll( &pollDescriptor, 1, WATCH_INTERVAL_MS ) > 0 ) {
+				ssize_t length;
+				while ( ( length = read( fd, buffer, sizeof( buffer ) ) ) > 0 ) {
+					for ( char* it = buffer; it < buffer + length; ) {
+						const inotify_event* event = reinterpret_cast<const inotify_event*>( it );
+						if ( event->len > 0 && fileName == event->name ) {
+							changed = true;
+						}
+						it += sizeof( inotify_event ) + event->len;
+					}
+				}
+			}
+			bool requested = m_ReloadRequested.exchange( false );
+			if ( changed || requested ) {
+				Parse( requested );
+			}
+		}
+		close( fd );
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock( m_WarningLock );
+		m_Warnings.push_back( "Failed to watch " + directory + " with inotify, polling instead" );
+	}
+#endif
+
+	auto modificationTime = [this]() -> time_t {
+		struct stat status;
+		return stat( m_ConfigPath.c_str(), &status ) == 0 ? status.st_mtime : 0;
+	};
+	time_t lastModified = modificationTime();
+	while ( !m_StopRequested ) {
+		std::this_thread::sleep_for( std::chrono::milliseconds( WATCH_INTERVAL_MS ) );
+		time_t modified = modificationTime();
+		bool   changed	= modified != 0 && modified != lastModified;
+		lastModified	= modified;
+		bool requested = m_ReloadRequested.exchange( false );
+		if ( changed || requested ) {
+			Parse( requested );
+		}
+	}
+}
+
+void KeyBindingReloader::Parse( bool requested ) {
+	std::shared_ptr<const ActionSnapshot> snapshot;
+	{
+		std::lock_guard<std::mutex> lock( m_SnapshotLock );
+		snapshot = m_Snapshot;
+	}
+
+	// The file is read once and the config parses a private copy of those bytes, so the hash is of what was parsed
+	rString contents;
+	if ( !KeyBindingCache::ReadFile( m_ConfigPath, contents ) ) {
+		// Probably caught while being replaced, the next change event parses it again
+		return;
+	}
+	pString copyPath = m_ConfigPath + ".reload";
+	{
+		std::ofstream copy( copyPath, std::ios::binary | std::ios::trunc );
+		copy.write( contents.data(), contents.size() );
+		if ( !copy ) {
+			std::lock_guard<std::mutex> lock( m_WarningLock );
+			m_Warnings.push_back( "Failed to copy " + m_ConfigPath + " to " + copyPath + " for parsing" );
+			return;
+		}
+	}
+	Config cfg;
+	bool   read = cfg.ReadFile( copyPath );
+	std::remove( copyPath.c_str() );
+	if ( !read ) {
+		return;
+	}
+
+	// Warnings are logged on the main thread when the result is applied
+	ParsedBindings* parsed = pNew( ParsedBindings );
+	parsed->ActionRevision = snapshot->ActionRevision;
+	parsed->ContentHash	   = KeyBindingCache::HashContents( contents );
+	parsed->Requested	   = requested;
+	parsed->Contexts.resize( snapshot->Contexts.size(), nullptr );
+	BindContext::DescriptionFunction description = [&snapshot]( ActionIdentifier action ) {
+		int index = static_cast<int>( action );
+		return index >= 0 && index < static_cast<int>( snapshot->Descriptions.size() ) ? snapshot->Descriptions[index].c_str() : "";
+	};
+	pVector<pString> values;
+	for ( size_t i = 0; i < snapshot->Contexts.size(); ++i ) {
+		const BindContext* context = snapshot->Contexts[i];
+		if ( context == nullptr ) {
+			continue;
+		}
+		BindContext* result = pNew( BindContext, context->GetName() );
+		result->CopyActions( *context );
+		values.clear();
+		result->ReadConfigValues( cfg, description, values );
+		result->LoadFromConfigValues( values.data(), description, &parsed->Warnings );
+		parsed->Contexts[i] = result;
+	}
+
+	// An unapplied earlier result is superseded by this one
+	ParsedBindings* previous = m_Pending.exchange( parsed );
+	if ( previous ) {
+		pDelete( previous );
+	}
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include INPUT_ALLOCATION_HEADER
+#include "InputLibraryDefine.h"
+#include "InputContext.h"
+#include "BindContext.h"
+#include "Types.h"
+
+class KeyBindings;
+
+// Reloads a keybinding config when the file changes on disk. The file is loaded into detached copies of the bind
+// contexts on a background thread, with the same rules as KeyBindings::ReadConfig, and handed over through an
+// atomic pointer. The next InputContext::Update swaps the bindings of every bind context at once, so queries
+// always see either the old or the new bindings.
+// Watches with inotify on Linux and by polling the modification time elsewhere. Changes made by
+// KeyBindings::SaveConfig are recognized by their content hash and not reloaded.
+class KeyBindingReloader {
+public:
+	INPUT_API KeyBindingReloader( KeyBindings& keyBindings, InputContext& input );
+	INPUT_API ~KeyBindingReloader();
+
+	KeyBindingReloader( const KeyBindingReloader& rhs ) = delete;
+	KeyBindingReloader& operator = ( const KeyBindingReloader& rhs ) = delete;
+
+	// Starts watching configPath, or the config path of the key bindings if empty.
+	INPUT_API bool Start ( const rString& configPath = "" );
+	INPUT_API void Stop ();
+	INPUT_API bool IsRunning () const;
+	// Parses the file again without waiting for a change.
+	INPUT_API void RequestReload ();
+	// Number of reloads applied so far.
+	INPUT_API int  GetNrOfReloads () const;
+
+private:
+	// Actions as they were on the main thread, read by the watcher thread while parsing
+	struct ActionSnapshot {
+		~ActionSnapshot();
+
+		Uint32				  ActionRevision = 0;
+		pVector<pString>	  Descriptions;
+		pVector<BindContext*> Contexts;	// Detached, with the actions but no bindings. Null for free handles
+	};
+
+	struct ParsedBindings {
+		~ParsedBindings();
+
+		Uint32				  ActionRevision = 0;
+		Uint64				  ContentHash	 = 0;	// Of the bytes that were parsed
+		bool				  Requested		 = false;	// Through RequestReload, applied even if the file is our own
+		pVector<BindContext*> Contexts;	// Detached, swapped with the bind contexts when applied
+		pVector<pString>	  Warnings;
+	};
+
+	void TakeSnapshot ();
+	void Apply ();
+	void WatchLoop ();
+	void Parse ( bool requested );
+
+	KeyBindings&			  m_KeyBindings;
+	InputContext&			  m_Input;
+	InputUpdateCallbackHandle m_UpdateCallbackHandle;
+	pString					  m_ConfigPath;
+
+	std::thread					  m_Thread;
+	std::atomic<bool>			  m_StopRequested { false };
+	std::atomic<bool>			  m_ReloadRequested { false };
+	std::atomic<ParsedBindings*>  m_Pending { nullptr };
+	std::mutex					  m_SnapshotLock;
+	std::shared_ptr<const ActionSnapshot> m_Snapshot;
+	std::mutex					  m_WarningLock;
+	pVector<pString>			  m_Warnings;	// From the watcher thread, logged by Apply
+	Uint32						  m_SnapshotRevision = 0;
+	int							  m_NrOfReloads		 = 0;
+};
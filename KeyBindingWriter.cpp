@@ -0,0 +1,164 @@
+#include "KeyBindingWriter.h"
+#include <cstdio>
+#include <utility/Config.h>
+#include "KeyBindingCache.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+	// Flushes the file's contents to the disk.
+	bool SyncFile( const pString& path ) {
+#ifdef _WIN32
+		HANDLE file = CreateFileA( path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+		if ( file == INVALID_HANDLE_VALUE ) {
+			return false;
+		}
+		bool synced = FlushFileBuffers( file ) != 0;
+		CloseHandle( file );
+		return synced;
+#else
+		int fd = open( path.c_str(), O_RDONLY );
+		if ( fd < 0 ) {
+			return false;
+		}
+		bool synced = fsync( fd ) == 0;
+		close( fd );
+		return synced;
+#endif
+	}
+
+	bool ReplaceFile( const pString& from, const pString& to ) {
+#ifdef _WIN32
+		return MoveFileExA( from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH ) != 0;
+#else
+		if ( std::rename( from.c_str(), to.c_str() ) != 0 ) {
+			return false;
+		}
+		// The rename itself is only durable once the directory is synced
+		size_t separator = to.find_last_of( '/' );
+		int	   fd		 = open( separator == pString::npos ? "." : to.substr( 0, separator + 1 ).c_str(), O_RDONLY );
+		if ( fd >= 0 ) {
+			fsync( fd );
+			close( fd );
+		}
+		return true;
+#endif
+	}
+}
+
+KeyBindingWriter::KeyBindingWriter() {
+	m_Thread = std::thread( &KeyBindingWriter::WriteLoop, this );
+}
+
+KeyBindingWriter::~KeyBindingWriter() {
+	{
+		std::lock_guard<std::mutex> lock( m_Lock );
+		m_StopRequested = true;
+	}
+	m_Wake.notify_one();
+	m_Thread.join();
+}
+
+Uint32 KeyBindingWriter::Enqueue( const rString& configPath, pVector<BindContext::ConfigEntry>& entries ) {
+	Uint32 ticket;
+	{
+		std::lock_guard<std::mutex> lock( m_Lock );
+		ticket = m_NextTicket++;
+		if ( !m_Queue.empty() && m_Queue.back().ConfigPath == configPath ) {
+			pVector<BindContext::ConfigEntry>& queued = m_Queue.back().Entries;
+			queued.insert( queued.end(), entries.begin(), entries.end() );
+			entries.clear();
+		} else {
+			m_Queue.push_back( Job { configPath, pVector<BindContext::ConfigEntry>(), pVector<Uint32>() } );
+			m_Queue.back().Entries.swap( entries );
+		}
+		m_Queue.back().Tickets.push_back( ticket );
+	}
+	m_Wake.notify_one();
+	return ticket;
+}
+
+void KeyBindingWriter::Flush() {
+	std::unique_lock<std::mutex> lock( m_Lock );
+	m_Idle.wait( lock, [this]() { return m_Queue.empty() && !m_Writing; } );
+}
+
+bool KeyBindingWriter::WroteContents( const rString& configPath, Uint64 contentHash ) {
+	std::lock_guard<std::mutex> lock( m_Lock );
+	auto it = m_WrittenHashes.find( configPath );
+	return it != m_WrittenHashes.end() && it->second == contentHash;
+}
+
+void KeyBindingWriter::TakeResults( pVector<Result>& results ) {
+	std::lock_guard<std::mutex> lock( m_Lock );
+	results.insert( results.end(), m_Results.begin(), m_Results.end() );
+	m_Results.clear();
+}
+
+void KeyBindingWriter::WriteLoop() {
+	pVector<Job>	jobs;
+	pVector<Result> results;
+	std::unique_lock<std::mutex> lock( m_Lock );
+	for ( ;; ) {
+		m_Wake.wait( lock, [this]() { return m_StopRequested || !m_Queue.empty(); } );
+		if ( m_Queue.empty() ) {
+			return;	// Stop requested and nothing left to write
+		}
+		jobs.swap( m_Queue );
+		m_Writing = true;
+		lock.unlock();
+
+		for ( const Job& job : jobs ) {
+			pString error;
+			bool	written = Write( job.ConfigPath, job.Entries, error );
+			// A merged write fails once, so the error goes with its first ticket only
+			for ( size_t i = 0; i < job.Tickets.size(); ++i ) {
+				results.push_back( Result { job.Tickets[i], written, i == 0 ? error : pString() } );
+			}
+		}
+		jobs.clear();
+
+		lock.lock();
+		m_Results.insert( m_Results.end(), results.begin(), results.end() );
+		results.clear();
+		m_Writing = false;
+		m_Idle.notify_all();
+	}
+}
+
+bool KeyBindingWriter::Write( const pString& configPath, const pVector<BindContext::ConfigEntry>& entries, pString& error ) {
+	// Entries of clean contexts are kept as they are in the file
+	Config config;
+	config.ReadFile( configPath );
+	for ( const BindContext::ConfigEntry& entry : entries ) {
+		config.SetString( entry.Key, entry.Value );
+	}
+
+	pString tempPath = configPath + ".tmp";
+	if ( !config.SaveFile( tempPath ) || !SyncFile( tempPath ) ) {
+		error = "Failed to write keybinding config " + tempPath;
+		std::remove( tempPath.c_str() );
+		return false;
+	}
+	// Recorded before the rename so a watcher seeing the new file can already tell it apart from an outside edit
+	rString contents;
+	KeyBindingCache::ReadFile( tempPath, contents );
+	{
+		std::lock_guard<std::mutex> lock( m_Lock );
+		m_WrittenHashes[configPath] = KeyBindingCache::HashContents( contents );
+	}
+	if ( !ReplaceFile( tempPath, configPath ) ) {
+		error = "Failed to replace keybinding config " + configPath;
+		std::remove( tempPath.c_str() );
+		std::lock_guard<std::mutex> lock( m_Lock );
+		m_WrittenHashes.erase( configPath );
+		return false;
+	}
+	return true;
+}
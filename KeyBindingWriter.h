@@ -0,0 +1,59 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include INPUT_ALLOCATION_HEADER
+#include "BindContext.h"
+#include "Types.h"
+
+// Writes keybinding config entries on a background thread. The file is read again for every write, so only
+// the changed entries have to be handed over and outside edits to the other entries are kept. Files are
+// written to a temporary file, synced to disk and then renamed over the old one, so a crash during the write
+// never leaves a truncated config behind.
+class KeyBindingWriter {
+public:
+	KeyBindingWriter();
+	~KeyBindingWriter();	// Finishes queued writes
+
+	KeyBindingWriter( const KeyBindingWriter& rhs ) = delete;
+	KeyBindingWriter& operator = ( const KeyBindingWriter& rhs ) = delete;
+
+	struct Result {
+		Uint32	Ticket;
+		bool	Written;
+		pString Error;	// Why the write failed, to be logged on the main thread. Empty if it succeeded
+	};
+
+	// Takes the entries and returns a ticket for the write. Consecutive writes to the same file are merged.
+	Uint32 Enqueue ( const rString& configPath, pVector<BindContext::ConfigEntry>& entries );
+	// Blocks until all queued writes are on disk.
+	void Flush ();
+	// True if the last file written to configPath had contents with this KeyBindingCache::HashContents hash.
+	bool WroteContents ( const rString& configPath, Uint64 contentHash );
+	// Appends the outcome of every write finished since the last call.
+	void TakeResults ( pVector<Result>& results );
+
+private:
+	struct Job {
+		pString							 ConfigPath;
+		pVector<BindContext::ConfigEntry> Entries;
+		pVector<Uint32>					 Tickets;	// Of every Enqueue merged into the job
+	};
+
+	void WriteLoop ();
+	// Never logs, since it runs on the writer thread. Failures are described in error instead.
+	bool Write ( const pString& configPath, const pVector<BindContext::ConfigEntry>& entries, pString& error );
+
+	std::thread				m_Thread;
+	std::mutex				m_Lock;
+	std::condition_variable m_Wake;
+	std::condition_variable m_Idle;
+	pVector<Job>			m_Queue;
+	pVector<Result>			m_Results;
+	Uint32					m_NextTicket	= 0;
+	bool					m_Writing		= false;
+	bool					m_StopRequested = false;
+
+	pMap<pString, Uint64> m_WrittenHashes;	// Guarded by m_Lock
+};
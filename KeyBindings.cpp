@@ -1,4 +1,5 @@
 #include "KeyBindings.h"
+#include <algorithm>
 #include <cassert>
 #include <SDL2/SDL_keyboard.h>
 #include <utility/ConfigManager.h>
@@ -6,6 +7,41 @@
 #include "InputContext.h"
 #include "GamepadContext.h"
 #include "BindContext.h"
+#include "VirtualDevicePool.h"
+#include "ActionInteractions.h"
+#include "InputBuffer.h"
+#include "KeyBindingCache.h"
+#include "KeyBindingWriter.h"
+
+namespace {
+	enum class MouseQuery { UpDown, DownUp, UpDownConsume, DownUpConsume, Up, Down };
+
+	bool QueryMouseBinding( InputContext& input, InputBinding binding, MouseQuery query ) {
+		if ( binding.GetMouseIndex() < 0 ) {
+			return false;
+		}
+		if ( binding.GetDevice() == InputDevice::MouseWheel ) {
+			// A wheel step is one edge, so consuming it through either query hides it from both
+			MOUSE_WHEEL wheel = binding.GetMouseWheel();
+			switch ( query ) {
+				case MouseQuery::UpDownConsume:
+				case MouseQuery::DownUpConsume: return input.MouseWheelScrolledConsume( wheel );
+				case MouseQuery::Up:			return !input.MouseWheelScrolled( wheel );
+				default:						return input.MouseWheelScrolled( wheel );
+			}
+		}
+		MOUSE_BUTTON button = binding.GetMouseButton();
+		switch ( query ) {
+			case MouseQuery::UpDown:		return input.MouseButtonUpDown( button );
+			case MouseQuery::DownUp:		return input.MouseButtonDownUp( button );
+			case MouseQuery::UpDownConsume: return input.MouseButtonUpDownConsume( button );
+			case MouseQuery::DownUpConsume: return input.MouseButtonDownUpConsume( button );
+			case MouseQuery::Up:			return input.MouseButtonUp( button );
+			case MouseQuery::Down:			return input.MouseButtonDown( button );
+		}
+		return false;
+	}
+}
 
 KeyBindings& KeyBindings::GetInstance() {
 	static KeyBindings keybindings;
@@ -13,7 +49,15 @@ KeyBindings& KeyBindings::GetInstance() {
 	return keybindings;
 }
 
+KeyBindings::KeyBindings() {
+}
+
 KeyBindings::~KeyBindings() {
+	if ( m_Writer ) {
+		// Logs the failures of the writes still queued
+		FlushConfigWrites();
+		pDelete( m_Writer );
+	}
 	for ( auto& context : m_BindContexts ) {
 		if ( context ) {
 			pDelete( context );
@@ -23,30 +67,63 @@ KeyBindings::~KeyBindings() {
 
 BindContextHandle KeyBindings::AllocateBindContext( const pString& name ) {
 	BindContextHandle handle;
+	++m_ActionRevision;
 	for ( size_t i = 0; i < m_BindContexts.size(); ++i ) { // Reuse empty slot
 		if ( m_BindContexts[i] == nullptr ) {
 			handle = static_cast<BindContextHandle>( static_cast<int>( i ) );
-			m_BindContexts[i] = pNew( BindContext, name );
+			m_BindContexts[i] = pNew( BindContext, name, this );
+			m_BindingIndex.ClearSharingPolicies( handle );
+			m_BindContexts[i]->SetBindingIndex( &m_BindingIndex, handle );
 			return handle;
 		}
 	}
-	m_BindContexts.push_back( pNew( BindContext, name ) );
-	return static_cast<BindContextHandle>( static_cast<int>( m_BindContexts.size() - 1 ) );
+	handle = static_cast<BindContextHandle>( static_cast<int>( m_BindContexts.size() ) );
+	m_BindContexts.push_back( pNew( BindContext, name, this ) );
+	m_BindContexts.back()->SetBindingIndex( &m_BindingIndex, handle );
+	return handle;
 }
 
 void KeyBindings::ReadConfig( const rString& configPath ) {
-	pString			toRead = configPath == "" ? m_KeybindingsConfigPath : configPath;
-	CallbackConfig* cfg	   = g_ConfigManager.GetConfig( toRead );
+	pString toRead = configPath == "" ? m_KeybindingsConfigPath : configPath;
+	// Saves still in flight would be marked clean against bindings they no longer match
+	FlushConfigWrites();
+	LoadConfig( toRead, m_BindContexts );
 
 	for ( auto& context : m_BindContexts ) {
 		if ( context ) {
-			context->LoadFromConfig( *cfg, m_ActionDescriptions );
+			context->MarkClean();
+		}
+	}
+	m_CleanConfigPath = toRead;
+}
+
+void KeyBindings::LoadConfig( const pString& configPath, pVector<BindContext*>& contexts ) {
+	// The cache is checked against the file and the registered actions before anything is parsed. The text
+	// config is only registered and parsed when either changed since the cache was written.
+	rString contents;
+	bool	readable  = KeyBindingCache::ReadFile( configPath, contents );
+	Uint64	hash	  = KeyBindingCache::ComputeHash( contents, contexts );
+	pString cachePath = configPath + ".bin";
+	if ( !readable || !KeyBindingCache::Load( cachePath, hash, contexts ) ) {
+		CallbackConfig* cfg = g_ConfigManager.GetConfig( configPath );
+		for ( auto& context : contexts ) {
+			if ( context ) {
+				context->LoadFromConfig( *cfg, *this );
+			}
+		}
+		// The config manager reads the file again, the cache is only written if that read saw the hashed contents
+		rString parsed;
+		if ( readable && KeyBindingCache::ReadFile( configPath, parsed ) && parsed == contents ) {
+			KeyBindingCache::Save( cachePath, hash, contexts );
 		}
 	}
 }
 
 void KeyBindings::ClearActions() {
 	m_ActionDescriptions.clear();
+	m_ActionNames.clear();
+	m_Strings.Clear();
+	++m_ActionRevision;
 	for ( auto& context : m_BindContexts ) {
 		if ( context ) {
 			context->ClearActions();
@@ -55,32 +132,114 @@ void KeyBindings::ClearActions() {
 }
 
 void KeyBindings::ReloadConfig() {
-	for ( auto& context : m_BindContexts ) {
-		if ( context ) {
-			context->ClearBindings();
+	FlushConfigWrites();
+	// Loaded into detached contexts and swapped in, so queries never see a context without bindings
+	pVector<BindContext*> loaded( m_BindContexts.size(), nullptr );
+	for ( size_t i = 0; i < m_BindContexts.size(); ++i ) {
+		if ( m_BindContexts[i] ) {
+			loaded[i] = pNew( BindContext, m_BindContexts[i]->GetName(), this );
+			loaded[i]->CopyActions( *m_BindContexts[i] );
+		}
+	}
+	LoadConfig( m_KeybindingsConfigPath, loaded );
+
+	for ( size_t i = 0; i < m_BindContexts.size(); ++i ) {
+		if ( loaded[i] ) {
+			m_BindContexts[i]->SwapBindings( *loaded[i] );
+			m_BindContexts[i]->MarkClean();
+			pDelete( loaded[i] );	// Holds the previous bindings after the swap
 		}
 	}
-	ReadConfig();
+	m_CleanConfigPath = m_KeybindingsConfigPath;
 }
 
 void KeyBindings::SaveConfig( const rString& configPath ) {
-	rString			toSave = configPath == "" ? m_KeybindingsConfigPath : configPath;
-	CallbackConfig* cfg	   = g_ConfigManager.GetConfig( toSave );
+	ApplyFinishedWrites();
+	rString toSave	 = configPath == "" ? m_KeybindingsConfigPath : configPath;
+	bool	saveAll = toSave != m_CleanConfigPath;	// A different file doesn't have the clean contexts yet
 
-	for ( const auto& context : m_BindContexts ) {
-		if ( context ) {
-			context->SaveToConfig( *cfg );
+	pVector<BindContext::ConfigEntry> entries;
+	PendingSave						  pending { 0, toSave, pVector<SavedContext>() };
+	for ( size_t i = 0; i < m_BindContexts.size(); ++i ) {
+		const BindContext* context = m_BindContexts[i];
+		if ( context && ( saveAll || context->IsDirty() ) ) {
+			context->GetConfigEntries( entries );
+			BindContext::Revisions revisions = context->GetRevisions();
+			pending.Contexts.push_back( SavedContext { static_cast<BindContextHandle>( static_cast<int>( i ) ), revisions.Context, revisions.Keys, revisions.Buttons } );
 		}
 	}
-	cfg->SaveFile();
+	if ( entries.empty() ) {
+		// Nothing to write, the file already matches
+		for ( const SavedContext& saved : pending.Contexts ) {
+			m_BindContexts[static_cast<int>( saved.BindContext )]->MarkClean( BindContext::Revisions { saved.ContextRevision, saved.KeyRevision, saved.ButtonRevision } );
+		}
+		m_CleanConfigPath = toSave;
+		return;
+	}
+
+	// Keep the loaded config in step so later reads see the new bindings
+	CallbackConfig* cfg = g_ConfigManager.GetConfig( toSave );
+	for ( const BindContext::ConfigEntry& entry : entries ) {
+		cfg->SetString( entry.Key, entry.Value );
+	}
+
+	if ( m_Writer == nullptr ) {
+		m_Writer = pNew( KeyBindingWriter );
+	}
+	pending.Ticket = m_Writer->Enqueue( toSave, entries );
+	m_PendingSaves.push_back( pending );
+}
+
+void KeyBindings::FlushConfigWrites() {
+	if ( m_Writer ) {
+		m_Writer->Flush();
+		ApplyFinishedWrites();
+	}
+}
+
+void KeyBindings::ApplyFinishedWrites() {
+	if ( m_Writer == nullptr ) {
+		return;
+	}
+	pVector<KeyBindingWriter::Result> results;
+	m_Writer->TakeResults( results );
+	for ( const KeyBindingWriter::Result& result : results ) {
+		if ( result.Error != "" ) {
+			INPUT_LOG( LogSeverity::WARNING_MSG, "KeyBindings", result.Error );
+		}
+		auto pending = std::find_if( m_PendingSaves.begin(), m_PendingSaves.end(), [&result]( const PendingSave& save ) {
+			return save.Ticket == result.Ticket;
+		} );
+		if ( pending == m_PendingSaves.end() ) {
+			continue;
+		}
+		// Failed writes leave the contexts dirty so the next SaveConfig writes them again
+		if ( result.Written ) {
+			for ( const SavedContext& saved : pending->Contexts ) {
+				BindContext* context = GetBindContext( saved.BindContext );
+				if ( context ) {
+					context->MarkClean( BindContext::Revisions { saved.ContextRevision, saved.KeyRevision, saved.ButtonRevision } );
+				}
+			}
+			m_CleanConfigPath = pending->ConfigPath;
+		}
+		m_PendingSaves.erase( pending );
+	}
+}
+
+bool KeyBindings::IsOwnConfigWrite( const rString& configPath, Uint64 contentHash ) const {
+	return m_Writer && m_Writer->WroteContents( configPath, contentHash );
 }
 
 bool KeyBindings::ActionUpDown( InputContext& input, BindContextHandle bindContextHandle, ActionIdentifier action, INPUT_TYPE inputType, bool ignorePause ) const {
 	assert( static_cast<int>( action ) < m_ActionDescriptions.size() );
-	const BindContext* context = GetBindContext( bindContextHandle );
+	if ( input.GetLatencyTracker().IsEnabled() ) {
+		ObserveLatency( input, bindContextHandle, action, inputType, true );
+	}
 	if ( inputType == INPUT_TYPE_KEYBOARD ) {
-		return input.KeyUpDown( context->GetKeyBindCollection().GetPrimaryScancodeFromAction( action )/*, ignorePause*/ ) ||
-			   input.KeyUpDown( context->GetKeyBindCollection().GetSecondaryScancodeFromAction( action )/*, ignorePause*/ );
+		return input.KeyUpDown( GetActiveScancode( bindContextHandle, action, KeyBindingType::Primary )/*, ignorePause*/ ) ||
+			   input.KeyUpDown( GetActiveScancode( bindContextHandle, action, KeyBindingType::Secondary )/*, ignorePause*/ ) ||
+			   QueryMouseBinding( input, GetActiveMouseBinding( bindContextHandle, action ), MouseQuery::UpDown );
 	} else if ( inputType == INPUT_TYPE_ANY ) {
 		if ( ActionUpDown( input, bindContextHandle, action, INPUT_TYPE_KEYBOARD, ignorePause ) ) {
 			return true;
@@ -94,16 +253,19 @@ bool KeyBindings::ActionUpDown( InputContext& input, BindContextHandle bindConte
 	} else {
 		assert( inputType >= 0 && static_cast<int>( inputType ) < INPUT_MAX_NR_OF_GAMEPADS );
 		const GamepadContext& gamepad = input.GetGamepadContext( inputType );
-		return gamepad.ButtonUpDown( context->GetGamepadBindCollection().GetButtonFromAction( action ) );
+		return gamepad.ButtonUpDown( GetActiveButton( bindContextHandle, action, inputType ) );
 	}
 }
 
 bool KeyBindings::ActionDownUp( InputContext& input, BindContextHandle bindContextHandle, ActionIdentifier action, INPUT_TYPE inputType, bool ignorePause ) const {
 	assert( static_cast<int>( action ) < m_ActionDescriptions.size() );
-	const BindContext* context = GetBindContext( bindContextHandle );
+	if ( input.GetLatencyTracker().IsEnabled() ) {
+		ObserveLatency( input, bindContextHandle, action, inputType, false );
+	}
 	if ( inputType == INPUT_TYPE_KEYBOARD ) {
-		return input.KeyDownUp( context->GetKeyBindCollection().GetPrimaryScancodeFromAction( action )/*, ignorePause*/ ) ||
-			   input.KeyDownUp( context->GetKeyBindCollection().GetSecondaryScancodeFromAction( action )/*, ignorePause*/ );
+		return input.KeyDownUp( GetActiveScancode( bindContextHandle, action, KeyBindingType::Primary )/*, ignorePause*/ ) ||
+			   input.KeyDownUp( GetActiveScancode( bindContextHandle, action, KeyBindingType::Secondary )/*, ignorePause*/ ) ||
+			   QueryMouseBinding( input, GetActiveMouseBinding( bindContextHandle, action ), MouseQuery::DownUp );
 	} else if ( inputType == INPUT_TYPE_ANY ) {
 		if ( ActionDownUp( input, bindContextHandle, action, INPUT_TYPE_KEYBOARD, ignorePause ) ) {
 			return true;
@@ -117,62 +279,65 @@ bool KeyBindings::ActionDownUp( InputContext& input, BindContextHandle bindConte
 	} else {
 		assert( inputType >= 0 && static_cast<int>( inputType ) < INPUT_MAX_NR_OF_GAMEPADS );
 		const GamepadContext& gamepad = input.GetGamepadContext( inputType );
-		return gamepad.ButtonDownUp( context->GetGamepadBindCollection().GetButtonFromAction( action ) );
+		return gamepad.ButtonDownUp( GetActiveButton( bindContextHandle, action, inputType ) );
 	}
 }
 
 bool KeyBindings::ActionUpDownConsume( InputContext& input, BindContextHandle bindContextHandle, ActionIdentifier action, INPUT_TYPE inputType, bool ignorePause ) const {
 	assert( static_cast<int>( action ) < m_ActionDescriptions.size() );
-	const BindContext* context = GetBindContext( bindContextHandle );
+	if ( input.GetLatencyTracker().IsEnabled() ) {
+		ObserveLatency( input, bindContextHandle, action, inputType, true );
+	}
+	// Consumes the edges of every input bound to the action, so no later query sees the action through another binding
 	if ( inputType == INPUT_TYPE_KEYBOARD ) {
-		return input.KeyUpDownConsume( context->GetKeyBindCollection().GetPrimaryScancodeFromAction( action )/*, ignorePause*/ ) ||
-			input.KeyUpDownConsume( context->GetKeyBindCollection().GetSecondaryScancodeFromAction( action )/*, ignorePause*/ );
+		bool primary   = input.KeyUpDownConsume( GetActiveScancode( bindContextHandle, action, KeyBindingType::Primary )/*, ignorePause*/ );
+		bool secondary = input.KeyUpDownConsume( GetActiveScancode( bindContextHandle, action, KeyBindingType::Secondary )/*, ignorePause*/ );
+		bool mouse	   = QueryMouseBinding( input, GetActiveMouseBinding( bindContextHandle, action ), MouseQuery::UpDownConsume );
+		return primary || secondary || mouse;
 	} else if ( inputType == INPUT_TYPE_ANY ) {
-		if ( ActionUpDownConsume( input, bindContextHandle, action, INPUT_TYPE_KEYBOARD, ignorePause ) ) {
-			return true;
-		}
+		bool consumed = ActionUpDownConsume( input, bindContextHandle, action, INPUT_TYPE_KEYBOARD, ignorePause );
 		for ( int i = 0; i < INPUT_MAX_NR_OF_GAMEPADS; ++i ) {
-			if ( ActionUpDownConsume( input, bindContextHandle, action, static_cast<INPUT_TYPE>( i ), ignorePause ) ) {
-				return true;
-			}
+			consumed |= ActionUpDownConsume( input, bindContextHandle, action, static_cast<INPUT_TYPE>( i ), ignorePause );
 		}
-		return false;
+		return consumed;
 	} else {
 		assert( inputType >= 0 && static_cast<int>( inputType ) < INPUT_MAX_NR_OF_GAMEPADS );
-		const GamepadContext& gamepad = input.GetGamepadContext( inputType );
-		return gamepad.ButtonUpDown( context->GetGamepadBindCollection().GetButtonFromAction( action ) );
+		return input.ButtonUpDownConsume( inputType, GetActiveButton( bindContextHandle, action, inputType ) );
 	}
 }
 
 bool KeyBindings::ActionDownUpConsume( InputContext& input, BindContextHandle bindContextHandle, ActionIdentifier action, INPUT_TYPE inputType, bool ignorePause ) const {
 	assert( static_cast<int>( action ) < m_ActionDescriptions.size() );
-	const BindContext* context = GetBindContext( bindContextHandle );
+	if ( input.GetLatencyTracker().IsEnabled() ) {
+		ObserveLatency( input, bindContextHandle, action, inputType, false );
+	}
+	// Consumes the edges of every input bound to the action, so no later query sees the action through another binding
 	if ( inputType == INPUT_TYPE_KEYBOARD ) {
-		return input.KeyDownUpConsume( context->GetKeyBindCollection().GetPrimaryScancodeFromAction( action )/*, ignorePause*/ ) ||
-			input.KeyDownUpConsume( context->GetKeyBindCollection().GetSecondaryScancodeFromAction( action )/*, ignorePause*/ );
+		bool primary   = input.KeyDownUpConsume( GetActiveScancode( bindContextHandle, action, KeyBindingType::Primary )/*, ignorePause*/ );
+		bool secondary = input.KeyDownUpConsume( GetActiveScancode( bindContextHandle, action, KeyBindingType::Secondary )/*, ignorePause*/ );
+		bool mouse	   = QueryMouseBinding( input, GetActiveMouseBinding( bindContextHandle, action ), MouseQuery::DownUpConsume );
+		return primary || secondary || mouse;
 	} else if ( inputType == INPUT_TYPE_ANY ) {
-		if ( ActionDownUpConsume( input, bindContextHandle, action, INPUT_TYPE_KEYBOARD, ignorePause ) ) {
-			return true;
-		}
+		bool consumed = ActionDownUpConsume( input, bindContextHandle, action, INPUT_TYPE_KEYBOARD, ignorePause );
 		for ( int i = 0; i < INPUT_MAX_NR_OF_GAMEPADS; ++i ) {
-			if ( ActionDownUpConsume( input, bindContextHandle, action, static_cast<INPUT_TYPE>( i ), ignorePause ) ) {
-				return true;
-			}
+			consumed |= ActionDownUpConsume( input, bindContextHandle, action, static_cast<INPUT_TYPE>( i ), ignorePause );
 		}
-		return false;
+		return consumed;
 	} else {
 		assert( inputType >= 0 && static_cast<int>( inputType ) < INPUT_MAX_NR_OF_GAMEPADS );
-		const GamepadContext& gamepad = input.GetGamepadContext( inputType );
-		return gamepad.ButtonDownUp( context->GetGamepadBindCollection().GetButtonFromAction( action ) );
+		return input.ButtonDownUpConsume( inputType, GetActiveButton( bindContextHandle, action, inputType ) );
 	}
 }
 
 bool KeyBindings::ActionUp( InputContext& input, BindContextHandle bindContextHandle, ActionIdentifier action, INPUT_TYPE inputType, bool ignorePause ) const {
 	assert( static_cast<int>( action ) < m_ActionDescriptions.size() );
-	const BindContext* context = GetBindContext( bindContextHandle );
+	if ( input.GetLatencyTracker().IsEnabled() ) {
+		ObserveLatency( input, bindContextHandle, action, inputType, false );
+	}
 	if ( inputType == INPUT_TYPE_KEYBOARD ) {
-		return input.KeyUp( context->GetKeyBindCollection().GetPrimaryScancodeFromAction( action ) /*, ignorePause*/ ) ||
-			   input.KeyUp( context->GetKeyBindCollection().GetSecondaryScancodeFromAction( action )	/*, ignorePause*/ );
+		return input.KeyUp( GetActiveScancode( bindContextHandle, action, KeyBindingType::Primary ) /*, ignorePause*/ ) ||
+			   input.KeyUp( GetActiveScancode( bindContextHandle, action, KeyBindingType::Secondary )	/*, ignorePause*/ ) ||
+			   QueryMouseBinding( input, GetActiveMouseBinding( bindContextHandle, action ), MouseQuery::Up );
 	} else if ( inputType == INPUT_TYPE_ANY ) {
 		if ( ActionUp( input, bindContextHandle, action, INPUT_TYPE_KEYBOARD, ignorePause ) ) {
 			return true;
@@ -186,17 +351,20 @@ bool KeyBindings::ActionUp( InputContext& input, BindContextHandle bindContextHa
 	} else {
 		assert( inputType >= 0 && static_cast<int>( inputType ) < INPUT_MAX_NR_OF_GAMEPADS );
 		const GamepadContext& gamepad = input.GetGamepadContext( inputType );
-		return gamepad.ButtonUp( context->GetGamepadBindCollection().GetButtonFromAction( action ) );
+		return gamepad.ButtonUp( GetActiveButton( bindContextHandle, action, inputType ) );
 	}
 }
 
 bool KeyBindings::ActionDown( InputContext& input, BindContextHandle bindContextHandle, ActionIdentifier action, INPUT_TYPE inputType, bool ignorePause ) const {
 	assert( static_cast<int>( action ) < m_ActionDescriptions.size() );
-	const BindContext* context = GetBindContext( bindContextHandle );
+	if ( input.GetLatencyTracker().IsEnabled() ) {
+		ObserveLatency( input, bindContextHandle, action, inputType, true );
+	}
 	if ( inputType == INPUT_TYPE_KEYBOARD ) {
 		// TODOJM: Implement ignore pause again if it is actually needed
-		return input.KeyDown( context->GetKeyBindCollection().GetPrimaryScancodeFromAction( action )	/*, ignorePause*/ ) ||
-			   input.KeyDown( context->GetKeyBindCollection().GetSecondaryScancodeFromAction( action ) /*, ignorePause*/ );
+		return input.KeyDown( GetActiveScancode( bindContextHandle, action, KeyBindingType::Primary )	/*, ignorePause*/ ) ||
+			   input.KeyDown( GetActiveScancode( bindContextHandle, action, KeyBindingType::Secondary ) /*, ignorePause*/ ) ||
+			   QueryMouseBinding( input, GetActiveMouseBinding( bindContextHandle, action ), MouseQuery::Down );
 	} else if ( inputType == INPUT_TYPE_ANY ) {
 		if ( ActionDown( input, bindContextHandle, action, INPUT_TYPE_KEYBOARD, ignorePause ) ) {
 			return true;
@@ -210,7 +378,22 @@ bool KeyBindings::ActionDown( InputContext& input, BindContextHandle bindContext
 	} else {
 		assert( inputType >= 0 && static_cast<int>( inputType ) < INPUT_MAX_NR_OF_GAMEPADS );
 		const GamepadContext& gamepad = input.GetGamepadContext( inputType );
-		return gamepad.ButtonDown( context->GetGamepadBindCollection().GetButtonFromAction( action ) );
+		return gamepad.ButtonDown( GetActiveButton( bindContextHandle, action, inputType ) );
+	}
+}
+
+void KeyBindings::ObserveLatency( InputContext& input, BindContextHandle bindContextHandle, ActionIdentifier action, INPUT_TYPE inputType, bool press ) const {
+	input.GetLatencyTracker().MarkQuery();
+	if ( inputType == INPUT_TYPE_KEYBOARD ) {
+		input.ObserveKeyEdge( GetActiveScancode( bindContextHandle, action, KeyBindingType::Primary ), press, action );
+		input.ObserveKeyEdge( GetActiveScancode( bindContextHandle, action, KeyBindingType::Secondary ), press, action );
+		// Wheel bindings have no timed edges to measure from
+		InputBinding mouse = GetActiveMouseBinding( bindContextHandle, action );
+		if ( mouse.GetDevice() == InputDevice::MouseButton ) {
+			input.ObserveMouseEdge( mouse.GetMouseButton(), press, action );
+		}
+	} else if ( InputTypeIsGamepad( inputType ) ) {
+		input.ObserveButtonEdge( static_cast<unsigned int>( inputType ), GetActiveButton( bindContextHandle, action, inputType ), press, action );
 	}
 }
 
@@ -219,12 +402,12 @@ ActionIdentifier KeyBindings::CreateAction( BindContextHandle bindContextHandle,
 	if ( bindContext ) {
 		ActionIdentifier identifier = static_cast<ActionIdentifier>( static_cast<int>( m_ActionDescriptions.size() ) );
 
-		m_ActionDescriptions.push_back( description );
-		m_ActionNames.push_back( name );
+		m_ActionDescriptions.push_back( m_Strings.Intern( description ) );
+		m_ActionNames.push_back( m_Strings.Intern( name ) );
 		AddAction( identifier, bindContextHandle, scancode, defaultButton );
 		return identifier;
 	} else {
-		LogInput( "Invalid bind context handle " + rToString( static_cast<int>( bindContextHandle ) ), "KeyBindings", LogSeverity::WARNING_MSG );
+		INPUT_LOG( LogSeverity::WARNING_MSG, "KeyBindings", "Invalid bind context handle " + rToString( static_cast<int>( bindContextHandle ) ) );
 		return ActionIdentifier::invalid();
 	}
 }
@@ -232,19 +415,325 @@ ActionIdentifier KeyBindings::CreateAction( BindContextHandle bindContextHandle,
 void KeyBindings::AddAction( ActionIdentifier actionIdentifier, BindContextHandle bindContextHandle, SDL_Scancode scancode, SDL_GameControllerButton defaultButton ) {
 	BindContext* bindContext = GetBindContext( bindContextHandle );
 	if ( bindContext ) {
-		const pString& name = m_ActionNames.at( static_cast<int>( actionIdentifier ) );
-		bindContext->AddAction( actionIdentifier, name, scancode, defaultButton );
+		bindContext->AddAction( actionIdentifier, GetActionName( actionIdentifier ), scancode, defaultButton );
+		++m_ActionRevision;
 	} else {
-		LogInput( "Invalid bind context handle " + rToString( static_cast<int>( bindContextHandle ) ), "KeyBindings", LogSeverity::WARNING_MSG );
+		INPUT_LOG( LogSeverity::WARNING_MSG, "KeyBindings", "Invalid bind context handle " + rToString( static_cast<int>( bindContextHandle ) ) );
+	}
+}
+
+bool KeyBindings::RegisterActionDefinitions( BindContextHandle bindContextHandle, ActionIdentifier firstAction, const ActionDefinition* definitions, int count ) {
+	BindContext* bindContext = GetBindContext( bindContextHandle );
+	if ( bindContext == nullptr ) {
+		INPUT_LOG( LogSeverity::WARNING_MSG, "KeyBindings", "Invalid bind context handle " + rToString( static_cast<int>( bindContextHandle ) ) );
+		return false;
+	}
+	if ( static_cast<int>( firstAction ) != static_cast<int>( m_ActionDescriptions.size() ) ) {
+		INPUT_LOG( LogSeverity::ERROR_MSG, "KeyBindings", "Action table starting at " + rToString( static_cast<int>( firstAction ) ) + " registered when the next free action is " +
+				  rToString( m_ActionDescriptions.size() ) );
+		return false;
+	}
+
+	size_t nrOfCharacters = 0;
+	for ( int i = 0; i < count; ++i ) {
+		nrOfCharacters += strlen( definitions[i].Description ) + strlen( definitions[i].Name ) + 2;
+	}
+	m_Strings.Reserve( count * 2, nrOfCharacters );
+	m_ActionDescriptions.reserve( m_ActionDescriptions.size() + count );
+	m_ActionNames.reserve( m_ActionNames.size() + count );
+	for ( int i = 0; i < count; ++i ) {
+		m_ActionDescriptions.push_back( m_Strings.Intern( definitions[i].Description ) );
+		m_ActionNames.push_back( m_Strings.Intern( definitions[i].Name ) );
+	}
+	bindContext->AddActions( firstAction, definitions, count );
+	++m_ActionRevision;
+	return true;
+}
+
+void KeyBindings::EvaluateVirtualDevices( VirtualDevicePool& pool, BindContextHandle bindContextHandle ) const {
+	pool.Evaluate( *this, bindContextHandle );
+}
+
+void KeyBindings::EvaluateInteractions( ActionInteractions& interactions, BindContextHandle bindContextHandle, const InputContext& input, Uint32 ticks ) const {
+	interactions.Evaluate( *this, bindContextHandle, input, ticks );
+}
+
+void KeyBindings::CaptureInputBuffer( InputBuffer& buffer, BindContextHandle bindContextHandle, const InputContext& input, Uint32 ticks ) const {
+	buffer.Capture( *this, bindContextHandle, input, ticks );
+}
+
+void KeyBindings::PushBindContext( BindContextHandle bindContextHandle, BindContextStackMode mode ) {
+	m_BindContextStack.push_back( StackEntry { bindContextHandle, mode } );
+	m_ResolutionDirty = true;
+}
+
+void KeyBindings::PopBindContext() {
+	if ( m_BindContextStack.empty() ) {
+		INPUT_LOG( LogSeverity::WARNING_MSG, "KeyBindings", "Tried to pop empty bind context stack" );
+		return;
+	}
+	m_BindContextStack.pop_back();
+	m_ResolutionDirty = true;
+}
+
+void KeyBindings::RemoveBindContextFromStack( BindContextHandle bindContextHandle ) {
+	for ( int i = static_cast<int>( m_BindContextStack.size() ) - 1; i >= 0; --i ) {
+		if ( m_BindContextStack[i].BindContext == bindContextHandle ) {
+			m_BindContextStack.erase( m_BindContextStack.begin() + i );
+			m_ResolutionDirty = true;
+		}
+	}
+}
+
+void KeyBindings::ClearBindContextStack() {
+	m_BindContextStack.clear();
+	m_ResolutionDirty = true;
+}
+
+bool KeyBindings::IsBindContextOnStack( BindContextHandle bindContextHandle ) const {
+	for ( const StackEntry& entry : m_BindContextStack ) {
+		if ( entry.BindContext == bindContextHandle ) {
+			return true;
+		}
+	}
+	return false;
+}
+
+const ResolvedBinding* KeyBindings::ResolveScancode( SDL_Scancode scancode, int& nrOfBindings ) const {
+	nrOfBindings = 0;
+	if ( scancode < 0 || scancode >= SDL_NUM_SCANCODES ) {
+		return nullptr;
+	}
+	UpdateResolution();
+	int first	 = m_KeyResolution.Offsets[scancode];
+	nrOfBindings = m_KeyResolution.Offsets[scancode + 1] - first;
+	return nrOfBindings > 0 ? &m_KeyResolution.Bindings[first] : nullptr;
+}
+
+const ResolvedBinding* KeyBindings::ResolveMouse( InputBinding binding, int& nrOfBindings ) const {
+	nrOfBindings = 0;
+	int index	 = binding.GetMouseIndex();
+	if ( index < 0 ) {
+		return nullptr;
 	}
+	UpdateResolution();
+	int first	 = m_MouseResolution.Offsets[index];
+	nrOfBindings = m_MouseResolution.Offsets[index + 1] - first;
+	return nrOfBindings > 0 ? &m_MouseResolution.Bindings[first] : nullptr;
+}
+
+const ResolvedBinding* KeyBindings::ResolveButton( SDL_GameControllerButton button, int& nrOfBindings, INPUT_TYPE player ) const {
+	nrOfBindings = 0;
+	if ( button < 0 || button >= SDL_CONTROLLER_BUTTON_MAX ) {
+		return nullptr;
+	}
+	UpdateResolution();
+	const Resolution& resolution = InputTypeIsGamepad( player ) && !m_ButtonResolutions[player + 1].Offsets.empty() ? m_ButtonResolutions[player + 1] : m_ButtonResolutions[0];
+	int				  first		 = resolution.Offsets[button];
+	nrOfBindings				 = resolution.Offsets[button + 1] - first;
+	return nrOfBindings > 0 ? &resolution.Bindings[first] : nullptr;
+}
+
+void KeyBindings::UpdateResolution() const {
+	// Every binding change goes through the binding index, so its revision tells whether the tables are stale
+	if ( !m_ResolutionDirty && m_ResolvedIndexRevision == m_BindingIndex.GetRevision() ) {
+		return;
+	}
+	m_ResolutionDirty		= false;
+	m_ResolvedIndexRevision = m_BindingIndex.GetRevision();
+
+	// Contexts below the topmost blocking one stay on the stack but resolve nothing
+	int lowestLevel = 0;
+	m_StackLevels.assign( m_BindContexts.size(), -1 );
+	for ( int level = 0; level < static_cast<int>( m_BindContextStack.size() ); ++level ) {
+		m_StackLevels[static_cast<int>( m_BindContextStack[level].BindContext )] = level;
+		if ( m_BindContextStack[level].Mode == BindContextStackMode::Block ) {
+			lowestLevel = level;
+		}
+	}
+
+	int nrOfUses;
+	m_KeyResolution.Bindings.clear();
+	m_KeyResolution.Offsets.resize( SDL_NUM_SCANCODES + 1 );
+	for ( int scancode = 0; scancode < SDL_NUM_SCANCODES; ++scancode ) {
+		m_KeyResolution.Offsets[scancode] = static_cast<int>( m_KeyResolution.Bindings.size() );
+		const BindingUse* uses = m_BindingIndex.GetScancodeUses( static_cast<SDL_Scancode>( scancode ), nrOfUses );
+		ResolveUses( uses, nrOfUses, lowestLevel, m_KeyResolution );
+	}
+	m_KeyResolution.Offsets[SDL_NUM_SCANCODES] = static_cast<int>( m_KeyResolution.Bindings.size() );
+
+	m_MouseResolution.Bindings.clear();
+	m_MouseResolution.Offsets.resize( INPUT_NR_OF_MOUSE_BINDINGS + 1 );
+	for ( int index = 0; index < INPUT_NR_OF_MOUSE_BINDINGS; ++index ) {
+		m_MouseResolution.Offsets[index] = static_cast<int>( m_MouseResolution.Bindings.size() );
+		const BindingUse* uses = m_BindingIndex.GetMouseUses( InputBinding::FromMouseIndex( index ), nrOfUses );
+		ResolveUses( uses, nrOfUses, lowestLevel, m_MouseResolution );
+	}
+	m_MouseResolution.Offsets[INPUT_NR_OF_MOUSE_BINDINGS] = static_cast<int>( m_MouseResolution.Bindings.size() );
+
+	// The shared table, then one per player whose bindings differ in a context on the stack. A context with
+	// player bindings is resolved through them instead of through its shared uses.
+	m_ButtonResolutions.resize( INPUT_MAX_NR_OF_GAMEPADS + 1 );
+	pVector<BindingUse> buttonUses;
+	for ( int player = -1; player < INPUT_MAX_NR_OF_GAMEPADS; ++player ) {
+		Resolution& resolution = m_ButtonResolutions[player + 1];
+		resolution.Bindings.clear();
+		resolution.Offsets.clear();
+		INPUT_TYPE playerType = player < 0 ? INPUT_TYPE_ANY : static_cast<INPUT_TYPE>( player );
+		bool	   hasPlayerBindings = false;
+		for ( const StackEntry& entry : m_BindContextStack ) {
+			hasPlayerBindings |= GetBindContext( entry.BindContext )->HasPlayerBindings( playerType );
+		}
+		if ( player >= 0 && !hasPlayerBindings ) {
+			continue;
+		}
+		resolution.Offsets.resize( SDL_CONTROLLER_BUTTON_MAX + 1 );
+		for ( int button = 0; button < SDL_CONTROLLER_BUTTON_MAX; ++button ) {
+			resolution.Offsets[button] = static_cast<int>( resolution.Bindings.size() );
+			const BindingUse* uses = m_BindingIndex.GetButtonUses( static_cast<SDL_GameControllerButton>( button ), nrOfUses );
+			buttonUses.clear();
+			for ( int i = 0; i < nrOfUses; ++i ) {
+				if ( uses[i].Player == INPUT_TYPE_ANY && !GetBindContext( uses[i].BindContext )->HasPlayerBindings( playerType ) ) {
+					buttonUses.push_back( uses[i] );
+				}
+			}
+			if ( hasPlayerBindings ) {
+				for ( const StackEntry& entry : m_BindContextStack ) {
+					const BindContext* context = GetBindContext( entry.BindContext );
+					ActionIdentifier   action;
+					if ( context->HasPlayerBindings( playerType ) &&
+						 ( action = context->GetActionFromButton( static_cast<SDL_GameControllerButton>( button ), playerType ) ) != ActionIdentifier() ) {
+						buttonUses.push_back( BindingUse { entry.BindContext, action, KeyBindingType::Primary, playerType } );
+					}
+				}
+			}
+			ResolveUses( buttonUses.data(), static_cast<int>( buttonUses.size() ), lowestLevel, resolution );
+		}
+		resolution.Offsets[SDL_CONTROLLER_BUTTON_MAX] = static_cast<int>( resolution.Bindings.size() );
+	}
+}
+
+void KeyBindings::ResolveUses( const BindingUse* uses, int nrOfUses, int lowestLevel, Resolution& resolution ) const {
+	// A shadowing context hides the input from the contexts below it
+	int cutoff = lowestLevel;
+	for ( int i = 0; i < nrOfUses; ++i ) {
+		int level = m_StackLevels[static_cast<int>( uses[i].BindContext )];
+		if ( level > cutoff && m_BindContextStack[level].Mode == BindContextStackMode::Shadow ) {
+			cutoff = level;
+		}
+	}
+	size_t first = resolution.Bindings.size();
+	for ( int i = 0; i < nrOfUses; ++i ) {
+		if ( m_StackLevels[static_cast<int>( uses[i].BindContext )] >= cutoff ) {
+			resolution.Bindings.push_back( ResolvedBinding { uses[i].BindContext, uses[i].Action } );
+		}
+	}
+	std::stable_sort( resolution.Bindings.begin() + first, resolution.Bindings.end(), [this]( const ResolvedBinding& lhs, const ResolvedBinding& rhs ) {
+		return m_StackLevels[static_cast<int>( lhs.BindContext )] > m_StackLevels[static_cast<int>( rhs.BindContext )];
+	} );
+}
+
+bool KeyBindings::IsBindingActive( const Resolution& resolution, int code, BindContextHandle bindContextHandle, ActionIdentifier action ) const {
+	int context = static_cast<int>( bindContextHandle );
+	if ( context >= static_cast<int>( m_StackLevels.size() ) || m_StackLevels[context] < 0 ) {
+		return true;
+	}
+	for ( int i = resolution.Offsets[code]; i < resolution.Offsets[code + 1]; ++i ) {
+		if ( resolution.Bindings[i].BindContext == bindContextHandle && resolution.Bindings[i].Action == action ) {
+			return true;
+		}
+	}
+	return false;
+}
+
+SDL_Scancode KeyBindings::GetActiveScancode( BindContextHandle bindContextHandle, ActionIdentifier action, KeyBindingType slot ) const {
+	// Actions that were never bound have no entry in the collection
+	const KeyBindingCollection&	 keys	  = GetBindContext( bindContextHandle )->GetKeyBindCollection();
+	const rVector<SDL_Scancode>& bindings = slot == KeyBindingType::Primary ? keys.GetPrimaryBindings() : keys.GetSecondaryBindings();
+	int							 index	  = static_cast<int>( action );
+	SDL_Scancode				 scancode = index >= 0 && index < static_cast<int>( bindings.size() ) ? bindings[index] : SDL_SCANCODE_UNKNOWN;
+	if ( scancode == SDL_SCANCODE_UNKNOWN || m_BindContextStack.empty() ) {
+		return scancode;
+	}
+	UpdateResolution();
+	return IsBindingActive( m_KeyResolution, scancode, bindContextHandle, action ) ? scancode : SDL_SCANCODE_UNKNOWN;
+}
+
+InputBinding KeyBindings::GetActiveMouseBinding( BindContextHandle bindContextHandle, ActionIdentifier action ) const {
+	InputBinding binding = GetBindContext( bindContextHandle )->GetKeyBindCollection().GetMouseBindingFromAction( action );
+	if ( binding.GetMouseIndex() < 0 || m_BindContextStack.empty() ) {
+		return binding;
+	}
+	UpdateResolution();
+	return IsBindingActive( m_MouseResolution, binding.GetMouseIndex(), bindContextHandle, action ) ? binding : InputBinding();
+}
+
+SDL_GameControllerButton KeyBindings::GetActiveButton( BindContextHandle bindContextHandle, ActionIdentifier action, INPUT_TYPE player ) const {
+	SDL_GameControllerButton button = GetBindContext( bindContextHandle )->GetButtonFromAction( action, player );
+	if ( button == SDL_CONTROLLER_BUTTON_INVALID || m_BindContextStack.empty() ) {
+		return button;
+	}
+	UpdateResolution();
+	return IsBindingActive( GetButtonResolution( player ), button, bindContextHandle, action ) ? button : SDL_CONTROLLER_BUTTON_INVALID;
+}
+
+ActionIdentifier KeyBindings::GetActiveActionFromScancode( BindContextHandle bindContextHandle, SDL_Scancode scancode ) const {
+	ActionIdentifier action = GetBindContext( bindContextHandle )->GetKeyBindCollection().GetGetActionFromScancode( scancode );
+	if ( action == ActionIdentifier() || m_BindContextStack.empty() ) {
+		return action;
+	}
+	UpdateResolution();
+	return IsBindingActive( m_KeyResolution, scancode, bindContextHandle, action ) ? action : ActionIdentifier();
+}
+
+ActionIdentifier KeyBindings::GetActiveActionFromMouseBinding( BindContextHandle bindContextHandle, InputBinding binding ) const {
+	ActionIdentifier action = GetBindContext( bindContextHandle )->GetKeyBindCollection().GetActionFromMouseBinding( binding );
+	if ( action == ActionIdentifier() || m_BindContextStack.empty() ) {
+		return action;
+	}
+	UpdateResolution();
+	return IsBindingActive( m_MouseResolution, binding.GetMouseIndex(), bindContextHandle, action ) ? action : ActionIdentifier();
+}
+
+ActionIdentifier KeyBindings::GetActiveActionFromButton( BindContextHandle bindContextHandle, SDL_GameControllerButton button, INPUT_TYPE player ) const {
+	ActionIdentifier action = GetBindContext( bindContextHandle )->GetActionFromButton( button, player );
+	if ( action == ActionIdentifier() || m_BindContextStack.empty() ) {
+		return action;
+	}
+	UpdateResolution();
+	return IsBindingActive( GetButtonResolution( player ), button, bindContextHandle, action ) ? action : ActionIdentifier();
+}
+
+const KeyBindings::Resolution& KeyBindings::GetButtonResolution( INPUT_TYPE player ) const {
+	return InputTypeIsGamepad( player ) && !m_ButtonResolutions[player + 1].Offsets.empty() ? m_ButtonResolutions[player + 1] : m_ButtonResolutions[0];
+}
+
+int KeyBindings::GetNrOfActions() const {
+	return static_cast<int>( m_ActionDescriptions.size() );
+}
+
+Uint32 KeyBindings::GetActionRevision() const {
+	return m_ActionRevision;
+}
+
+int KeyBindings::GetNrOfBindContexts() const {
+	return static_cast<int>( m_BindContexts.size() );
+}
+
+BindingIndex& KeyBindings::GetBindingIndex() {
+	return m_BindingIndex;
+}
+
+const BindingIndex& KeyBindings::GetBindingIndex() const {
+	return m_BindingIndex;
 }
 
-const rVector<rString>& KeyBindings::GetActionDescriptions() const {
-	return m_ActionDescriptions;
+const char* KeyBindings::GetDescription( ActionIdentifier action ) const {
+	return m_Strings.Get( m_ActionDescriptions.at( static_cast<int>( action ) ) );
 }
 
-const rString& KeyBindings::GetDescription( ActionIdentifier action ) const {
-	return m_ActionDescriptions.at( static_cast<int>( action ) );
+const char* KeyBindings::GetActionName( ActionIdentifier action ) const {
+	return m_Strings.Get( m_ActionNames.at( static_cast<int>( action ) ) );
 }
 
 const rString& KeyBindings::GetConfigPath() const {
@@ -5,30 +5,56 @@
 #include <SDL2/SDL_gamecontroller.h>
 #include "InputLibraryDefine.h"
 #include "Types.h"
+#include "StaticActionTable.h"
+#include "StringPool.h"
+#include "BindingIndex.h"
 
 class InputContext;
 class BindContext;
+class VirtualDevicePool;
+class ActionInteractions;
+class InputBuffer;
+class KeyBindingWriter;
 
 #define g_KeyBindings KeyBindings::GetInstance()
 
 class KeyBindings {
 public:
+	INPUT_API KeyBindings();
+	INPUT_API ~KeyBindings();
 
 	KeyBindings& operator = ( const KeyBindings & rhs ) = delete;
 	KeyBindings( const KeyBindings & rhs ) = delete;
 
+	// Default instance. Further instances can be created for e.g. headless simulations sharing a process.
 	INPUT_API static KeyBindings& GetInstance ();
 
 	INPUT_API BindContextHandle AllocateBindContext( const pString& name );
 	INPUT_API void				  ClearActions ();
 	INPUT_API void				  ReadConfig ( const rString& configPath = "" );
+	// Reads the config again into detached contexts and swaps their bindings in, so queries always see bindings.
 	INPUT_API void				  ReloadConfig ();
+	// Writes the bind contexts changed since the config was last read or saved. The file is written on a
+	// background thread, so this only copies the changed entries. The contexts are marked clean once the write
+	// succeeded, which the next SaveConfig, FlushConfigWrites or ReadConfig picks up.
 	INPUT_API void				  SaveConfig ( const rString& configPath = "" );
+	// Blocks until every SaveConfig so far has reached the disk and marks the written contexts clean.
+	INPUT_API void				  FlushConfigWrites ();
+	// True if configPath was last written by SaveConfig with contents of this KeyBindingCache::HashContents hash.
+	INPUT_API bool				  IsOwnConfigWrite ( const rString& configPath, Uint64 contentHash ) const;
 
 	INPUT_API ActionIdentifier CreateAction( BindContextHandle bindContextHandle, const pString &name, SDL_Scancode scancode,
 		const pString &description, SDL_GameControllerButton = SDL_CONTROLLER_BUTTON_INVALID );
 	INPUT_API void AddAction( ActionIdentifier actionIdentifier, BindContextHandle bindContextHandle, SDL_Scancode scancode, SDL_GameControllerButton = SDL_CONTROLLER_BUTTON_INVALID );
-
+	// Adds the actions of a compile-time table to a bind context. Fails if the next free identifier isn't the first of the table.
+	template<int First, size_t NrOfActions>
+	bool		   RegisterActionTable( BindContextHandle bindContextHandle, const StaticActionTable<First, NrOfActions>& table ) {
+		return RegisterActionDefinitions( bindContextHandle, static_cast<ActionIdentifier>( First ), table.Definitions, static_cast<int>( NrOfActions ) );
+	}
+	INPUT_API bool RegisterActionDefinitions( BindContextHandle bindContextHandle, ActionIdentifier firstAction, const ActionDefinition* definitions, int count );
+
+	// Bindings hidden by a context higher on the bind context stack don't trigger the action. Contexts that are
+	// not on the stack see all their bindings.
 	INPUT_API bool ActionUpDown			( InputContext& input, BindContextHandle bindContextHandle, ActionIdentifier action, INPUT_TYPE inputType = INPUT_TYPE_KEYBOARD, bool ignorePause = false ) const;
 	INPUT_API bool ActionDownUp			( InputContext& input, BindContextHandle bindContextHandle, ActionIdentifier action, INPUT_TYPE inputType = INPUT_TYPE_KEYBOARD, bool ignorePause = false ) const;
 	INPUT_API bool ActionUpDownConsume	( InputContext& input, BindContextHandle bindContextHandle, ActionIdentifier action, INPUT_TYPE inputType = INPUT_TYPE_KEYBOARD, bool ignorePause = false ) const;
@@ -36,24 +62,111 @@ public:
 	INPUT_API bool ActionUp				( InputContext& input, BindContextHandle bindContextHandle, ActionIdentifier action, INPUT_TYPE inputType = INPUT_TYPE_KEYBOARD, bool ignorePause = false ) const;
 	INPUT_API bool ActionDown			( InputContext& input, BindContextHandle bindContextHandle, ActionIdentifier action, INPUT_TYPE inputType = INPUT_TYPE_KEYBOARD, bool ignorePause = false ) const;
 
-	INPUT_API const rVector<rString>& GetActionDescriptions   () const;
-
-	INPUT_API const rString& GetDescription ( ActionIdentifier action ) const;
+	// Resolves all actions of the bind context for every device in pool, through the stack like the action queries.
+	INPUT_API void EvaluateVirtualDevices ( VirtualDevicePool& pool, BindContextHandle bindContextHandle ) const;
+	// Advances the tap and hold state machines with this frame's edges. Call once per frame after the events are handled.
+	INPUT_API void EvaluateInteractions ( ActionInteractions& interactions, BindContextHandle bindContextHandle, const InputContext& input, Uint32 ticks ) const;
+	// Appends this frame's edges of the bind context's actions to buffer. Call once per frame after the events are handled.
+	INPUT_API void CaptureInputBuffer ( InputBuffer& buffer, BindContextHandle bindContextHandle, const InputContext& input, Uint32 ticks ) const;
+
+	// Bind context stack. Contexts higher up take precedence over lower ones as given by their mode.
+	INPUT_API void PushBindContext ( BindContextHandle bindContextHandle, BindContextStackMode mode = BindContextStackMode::Shadow );
+	INPUT_API void PopBindContext ();
+	INPUT_API void RemoveBindContextFromStack ( BindContextHandle bindContextHandle );
+	INPUT_API void ClearBindContextStack ();
+	INPUT_API bool IsBindContextOnStack ( BindContextHandle bindContextHandle ) const;
+
+	// Actions the input triggers through the stack, topmost context first. The combined tables are only rebuilt
+	// when the stack or the binding index changes. Buttons resolve with the player bindings of player applied.
+	INPUT_API const ResolvedBinding* ResolveScancode ( SDL_Scancode scancode, int& nrOfBindings ) const;
+	INPUT_API const ResolvedBinding* ResolveMouse ( InputBinding binding, int& nrOfBindings ) const;
+	INPUT_API const ResolvedBinding* ResolveButton ( SDL_GameControllerButton button, int& nrOfBindings, INPUT_TYPE player = INPUT_TYPE_ANY ) const;
+
+	// The bindings of action that the stack leaves active, unknown or invalid if hidden. The action queries and
+	// everything evaluating actions outside of them go through these. Gamepad players get their player bindings.
+	INPUT_API SDL_Scancode			   GetActiveScancode ( BindContextHandle bindContextHandle, ActionIdentifier action, KeyBindingType slot ) const;
+	INPUT_API InputBinding			   GetActiveMouseBinding ( BindContextHandle bindContextHandle, ActionIdentifier action ) const;
+	INPUT_API SDL_GameControllerButton GetActiveButton ( BindContextHandle bindContextHandle, ActionIdentifier action, INPUT_TYPE player = INPUT_TYPE_ANY ) const;
+	// The action of the context an input edge triggers, invalid if it has none or the stack hides its binding.
+	INPUT_API ActionIdentifier GetActiveActionFromScancode ( BindContextHandle bindContextHandle, SDL_Scancode scancode ) const;
+	INPUT_API ActionIdentifier GetActiveActionFromMouseBinding ( BindContextHandle bindContextHandle, InputBinding binding ) const;
+	INPUT_API ActionIdentifier GetActiveActionFromButton ( BindContextHandle bindContextHandle, SDL_GameControllerButton button, INPUT_TYPE player = INPUT_TYPE_ANY ) const;
+
+	INPUT_API int					  GetNrOfActions () const;
+	// Incremented whenever bind contexts or actions are added or cleared.
+	INPUT_API Uint32				  GetActionRevision () const;
+	// Number of bind context slots. Slots may be empty.
+	INPUT_API int					  GetNrOfBindContexts () const;
+
+	// Which contexts use each key and button, and which contexts may share them.
+	INPUT_API BindingIndex&		  GetBindingIndex ();
+	INPUT_API const BindingIndex& GetBindingIndex () const;
+
+	INPUT_API const char*	 GetDescription ( ActionIdentifier action ) const;
+	INPUT_API const char*	 GetActionName ( ActionIdentifier action ) const;
 	INPUT_API const rString& GetConfigPath () const;
 	INPUT_API BindContext* GetBindContext( BindContextHandle bindContextHandle );
 	INPUT_API const BindContext* GetBindContext( BindContextHandle bindContextHandle ) const;
 
 private:
-	// No external instancing allowed
-	KeyBindings(){ };
-	~KeyBindings();
+	struct StackEntry {
+		BindContextHandle	 BindContext;
+		BindContextStackMode Mode;
+	};
+
+	// Actions per input code, those of code being Bindings[Offsets[code]] up to Bindings[Offsets[code + 1]]
+	struct Resolution {
+		pVector<ResolvedBinding> Bindings;
+		pVector<int>			 Offsets;
+	};
+
+	// Loads the bindings of configPath into contexts, from the binary cache if it is up to date.
+	void LoadConfig ( const pString& configPath, pVector<BindContext*>& contexts );
+
+	// A context handed to the writer, with the revisions it had when its entries were copied
+	struct SavedContext {
+		BindContextHandle BindContext;
+		Uint32			  ContextRevision;
+		Uint32			  KeyRevision;
+		Uint32			  ButtonRevision;
+	};
+
+	struct PendingSave {
+		Uint32				  Ticket;
+		pString				  ConfigPath;
+		pVector<SavedContext> Contexts;
+	};
+
+	void ApplyFinishedWrites ();
+	void UpdateResolution () const;
+	void ResolveUses ( const BindingUse* uses, int nrOfUses, int lowestLevel, Resolution& resolution ) const;
+	// False if the binding of action in the context is hidden by a context higher on the stack.
+	bool IsBindingActive ( const Resolution& resolution, int code, BindContextHandle bindContextHandle, ActionIdentifier action ) const;
+	const Resolution& GetButtonResolution ( INPUT_TYPE player ) const;
+
+	void ObserveLatency( InputContext& input, BindContextHandle bindContextHandle, ActionIdentifier action, INPUT_TYPE inputType, bool press ) const;
 
 
 	const pString m_KeybindingsConfigPath = "keybindings.cfg";
 
-	pVector<rString> m_ActionDescriptions;
-	pVector<rString> m_ActionNames;
+	StringPool		  m_Strings;	// Action names and descriptions
+	pVector<StringId> m_ActionDescriptions;
+	pVector<StringId> m_ActionNames;
 
+	BindingIndex		  m_BindingIndex;
 	pVector<BindContext*> m_BindContexts;
+	Uint32				  m_ActionRevision = 0;
+
+	KeyBindingWriter*	 m_Writer = nullptr;
+	pVector<PendingSave> m_PendingSaves;	// Queued on the writer, in ticket order
+	pString				 m_CleanConfigPath;	// File that matches the clean contexts
+
+	pVector<StackEntry>			m_BindContextStack;
+	mutable bool				m_ResolutionDirty = true;	// Set when the stack changes, binding changes bump the index revision
+	mutable Uint32				m_ResolvedIndexRevision = 0;
+	mutable pVector<int>		m_StackLevels;	// Per bind context, position of its topmost stack entry or -1
+	mutable Resolution			m_KeyResolution;
+	mutable Resolution			m_MouseResolution;
+	mutable pVector<Resolution> m_ButtonResolutions;	// Shared, then per player. Empty for players without player bindings on the stack
 };
 
@@ -0,0 +1,44 @@
+#include "LogInput.h"
+#include <cstring>
+#include <mutex>
+
+std::atomic<int>  InputLog::m_SeverityMask( INPUT_LOG_DEFAULT_SEVERITY_MASK );
+std::atomic<bool> InputLog::m_HasDisabledCategories( false );
+
+namespace {
+	// Disabling categories is rare, so a short list searched under a lock is enough
+	std::mutex		 CategoryLock;
+	pVector<pString> DisabledCategories;
+}
+
+void InputLog::SetSeverityMask( int severityMask ) {
+	m_SeverityMask.store( severityMask, std::memory_order_relaxed );
+}
+
+int InputLog::GetSeverityMask() {
+	return m_SeverityMask.load( std::memory_order_relaxed );
+}
+
+void InputLog::SetCategoryEnabled( const char* category, bool enabled ) {
+	std::lock_guard<std::mutex> lock( CategoryLock );
+	auto it = DisabledCategories.begin();
+	while ( it != DisabledCategories.end() && *it != category ) {
+		++it;
+	}
+	if ( enabled && it != DisabledCategories.end() ) {
+		DisabledCategories.erase( it );
+	} else if ( !enabled && it == DisabledCategories.end() ) {
+		DisabledCategories.push_back( category );
+	}
+	m_HasDisabledCategories.store( !DisabledCategories.empty(), std::memory_order_relaxed );
+}
+
+bool InputLog::IsCategoryEnabled( const char* category ) {
+	std::lock_guard<std::mutex> lock( CategoryLock );
+	for ( const pString& disabled : DisabledCategories ) {
+		if ( strcmp( disabled.c_str(), category ) == 0 ) {
+			return false;
+		}
+	}
+	return true;
+}
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <atomic>
 #include "InputLibraryDefine.h"
 
 #ifdef LOG_TO_COUT
+#include <iostream>
 namespace LogSeverity {
 	enum BitFlag {
 		/// <summary> Program is likely to crash or not work correctly. </summary>
@@ -29,3 +31,50 @@ static void LogInput( const rString& message, const char* category = "Input", in
 	Logger::Log( message, category, static_cast<LogSeverity::BitFlag>( severityMask ) );
 }
 #endif
+
+// Severities InputLog lets through until SetSeverityMask is called. Printing to cout shows everything, so
+// everything is formatted. The Logger can't be asked which severities it is interested in, so there debug
+// messages are opt-in: call InputLog::SetSeverityMask with the severities registered with the Logger.
+#ifndef INPUT_LOG_DEFAULT_SEVERITY_MASK
+#ifdef LOG_TO_COUT
+#define INPUT_LOG_DEFAULT_SEVERITY_MASK LogSeverity::ALL
+#else
+#define INPUT_LOG_DEFAULT_SEVERITY_MASK ( LogSeverity::ERROR_MSG | LogSeverity::WARNING_MSG | LogSeverity::INFO_MSG )
+#endif
+#endif
+
+// Severities not in this mask are compiled out of INPUT_LOG, message expression included.
+// Release builds can define it as e.g. LogSeverity::ERROR_MSG | LogSeverity::WARNING_MSG.
+#ifndef INPUT_LOG_SEVERITY_MASK
+#define INPUT_LOG_SEVERITY_MASK LogSeverity::ALL
+#endif
+
+// Runtime filter for the messages the library logs. Checked before the message is built.
+class InputLog {
+public:
+	INPUT_API static void SetSeverityMask ( int severityMask );
+	INPUT_API static int  GetSeverityMask ();
+	INPUT_API static void SetCategoryEnabled ( const char* category, bool enabled );
+
+	static bool IsEnabled ( int severity, const char* category ) {
+		return ( m_SeverityMask.load( std::memory_order_relaxed ) & severity ) != 0 &&
+			   ( !m_HasDisabledCategories.load( std::memory_order_relaxed ) || IsCategoryEnabled( category ) );
+	}
+
+private:
+	INPUT_API static bool IsCategoryEnabled ( const char* category );
+
+	INPUT_API static std::atomic<int>  m_SeverityMask;
+	INPUT_API static std::atomic<bool> m_HasDisabledCategories;
+};
+
+// Logs message only if severity passes both filters. The message expression is not evaluated otherwise,
+// so it can concatenate strings freely:
+//
+//	INPUT_LOG( LogSeverity::DEBUG_MSG, "KeyBindings", "Bound key \"" + keyName + "\"" );
+#define INPUT_LOG( severity, category, message ) \
+	do { \
+		if ( ( ( severity ) & ( INPUT_LOG_SEVERITY_MASK ) ) != 0 && InputLog::IsEnabled( severity, category ) ) { \
+			LogInput( message, category, severity ); \
+		} \
+	} while ( false )
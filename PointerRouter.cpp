@@ -0,0 +1,308 @@
+#include "PointerRouter.h"
+#include <algorithm>
+#include "InputState.h"
+#include "LogInput.h"
+
+PointerRouter::PointerRouter( InputState& inputState, int width, int height, int cellSize, int priority )
+	: m_InputState( inputState ), m_Width( width ), m_Height( height ), m_CellSize( std::max( cellSize, 1 ) ) {
+	Resize( width, height );
+	m_EventCallbackHandle = m_InputState.RegisterEventInterest( [this]( const SDL_Event& event ) {
+		return HandleEvent( event );
+	}, priority );
+}
+
+PointerRouter::~PointerRouter() {
+	m_InputState.UnregisterEventInterest( m_EventCallbackHandle );
+}
+
+PointerRegionHandle PointerRouter::AddRegion( const PointerRect& rect, int z, PointerHandlerFunction handlerFunction ) {
+	int index;
+	if ( m_FreeRegions.empty() ) {
+		index = static_cast<int>( m_Regions.size() );
+		m_Regions.push_back( Region() );
+	} else {
+		index = m_FreeRegions.back();
+		m_FreeRegions.pop_back();
+	}
+	Region& region	= m_Regions[index];
+	region.Rect		= rect;
+	region.Z		= z;
+	region.Order	= m_NextOrder++;
+	region.Enabled	= true;
+	region.Alive	= true;
+	region.Function = handlerFunction;
+	InsertInGrid( index );
+	UpdateHover();
+	return static_cast<PointerRegionHandle>( index );
+}
+
+void PointerRouter::RemoveRegion( PointerRegionHandle handle ) {
+	Region* region = GetRegion( handle );
+	if ( region == nullptr ) {
+		INPUT_LOG( LogSeverity::WARNING_MSG, "PointerRouter", "Tried to remove invalid pointer region handle: " + rToString( static_cast<int>( handle ) ) );
+		return;
+	}
+	int index = static_cast<int>( handle );
+	RemoveFromGrid( index );
+	region->Alive	 = false;
+	region->Function = nullptr;
+	m_FreeRegions.push_back( index );
+	DropCaptures( handle );
+	// A removed region is not told that the pointer left it
+	if ( m_Hovered == handle ) {
+		m_Hovered = PointerRegionHandle();
+	}
+	UpdateHover();
+}
+
+void PointerRouter::SetRegionRect( PointerRegionHandle handle, const PointerRect& rect ) {
+	Region* region = GetRegion( handle );
+	if ( region == nullptr ) {
+		return;
+	}
+	int index = static_cast<int>( handle );
+	RemoveFromGrid( index );
+	region->Rect = rect;
+	InsertInGrid( index );
+	UpdateHover();
+}
+
+void PointerRouter::SetRegionZ( PointerRegionHandle handle, int z ) {
+	Region* region = GetRegion( handle );
+	if ( region != nullptr ) {
+		region->Z = z;
+		UpdateHover();
+	}
+}
+
+void PointerRouter::SetRegionEnabled( PointerRegionHandle handle, bool enabled ) {
+	Region* region = GetRegion( handle );
+	if ( region != nullptr ) {
+		region->Enabled = enabled;
+		if ( !enabled ) {
+			DropCaptures( handle );
+		}
+		UpdateHover();
+	}
+}
+
+void PointerRouter::Resize( int width, int height ) {
+	m_Width		  = std::max( width, 0 );
+	m_Height	  = std::max( height, 0 );
+	m_NrOfColumns = ( m_Width + m_CellSize - 1 ) / m_CellSize;
+	m_NrOfRows	  = ( m_Height + m_CellSize - 1 ) / m_CellSize;
+	m_Cells.clear();
+	m_Cells.resize( m_NrOfColumns * m_NrOfRows );
+	for ( int i = 0; i < static_cast<int>( m_Regions.size() ); ++i ) {
+		if ( m_Regions[i].Alive ) {
+			InsertInGrid( i );
+		}
+	}
+	UpdateHover();
+}
+
+PointerRegionHandle PointerRouter::HitTest( int x, int y ) const {
+	if ( x < 0 || y < 0 || x >= m_Width || y >= m_Height ) {
+		return PointerRegionHandle();
+	}
+	int topmost = -1;
+	for ( int index : m_Cells[( y / m_CellSize ) * m_NrOfColumns + x / m_CellSize] ) {
+		const Region& region = m_Regions[index];
+		if ( region.Enabled && region.Rect.Contains( x, y ) && ( topmost == -1 || IsAbove( index, topmost ) ) ) {
+			topmost = index;
+		}
+	}
+	return static_cast<PointerRegionHandle>( topmost );
+}
+
+PointerRegionHandle PointerRouter::GetHoveredRegion() const {
+	return m_Hovered;
+}
+
+bool PointerRouter::HandleEvent( const SDL_Event& event ) {
+	switch ( event.type ) {
+		case SDL_MOUSEMOTION: {
+			// Touch is routed from the finger events, not from the mouse events SDL synthesizes for it
+			if ( event.motion.which == SDL_TOUCH_MOUSEID ) {
+				return false;
+			}
+			m_HasMousePosition = true;
+			m_MouseX		   = event.motion.x;
+			m_MouseY		   = event.motion.y;
+			UpdateHover();
+			return Dispatch( POINTER_EVENT_MOTION, m_MouseX, m_MouseY, false, event );
+		}
+		case SDL_MOUSEBUTTONDOWN:
+		case SDL_MOUSEBUTTONUP: {
+			if ( event.button.which == SDL_TOUCH_MOUSEID ) {
+				return false;
+			}
+			m_HasMousePosition = true;
+			m_MouseX		   = event.button.x;
+			m_MouseY		   = event.button.y;
+			UpdateHover();
+			return Dispatch( event.type == SDL_MOUSEBUTTONDOWN ? POINTER_EVENT_PRESS : POINTER_EVENT_RELEASE, m_MouseX, m_MouseY, false, event );
+		}
+		case SDL_MOUSEWHEEL: {
+			if ( event.wheel.which == SDL_TOUCH_MOUSEID || !m_HasMousePosition ) {
+				return false;
+			}
+			return Dispatch( POINTER_EVENT_WHEEL, m_MouseX, m_MouseY, false, event );
+		}
+		case SDL_WINDOWEVENT: {
+			// Where the mouse is stays unknown until it moves back into the window
+			if ( event.window.event == SDL_WINDOWEVENT_LEAVE ) {
+				m_HasMousePosition = false;
+				UpdateHover();
+			}
+			return false;
+		}
+		case SDL_FINGERDOWN:
+		case SDL_FINGERUP:
+		case SDL_FINGERMOTION: {
+			POINTER_EVENT type = event.type == SDL_FINGERDOWN ? POINTER_EVENT_PRESS : ( event.type == SDL_FINGERUP ? POINTER_EVENT_RELEASE : POINTER_EVENT_MOTION );
+			return Dispatch( type, static_cast<int>( event.tfinger.x * m_Width ), static_cast<int>( event.tfinger.y * m_Height ), true, event );
+		}
+	}
+	return false;
+}
+
+PointerRouter::Region* PointerRouter::GetRegion( PointerRegionHandle handle ) {
+	int index = static_cast<int>( handle );
+	if ( index < 0 || index >= static_cast<int>( m_Regions.size() ) || !m_Regions[index].Alive ) {
+		return nullptr;
+	}
+	return &m_Regions[index];
+}
+
+void PointerRouter::InsertInGrid( int index ) {
+	Region& region = m_Regions[index];
+	int		left   = std::max( region.Rect.X, 0 );
+	int		top	   = std::max( region.Rect.Y, 0 );
+	int		right  = std::min( region.Rect.X + region.Rect.Width, m_Width );
+	int		bottom = std::min( region.Rect.Y + region.Rect.Height, m_Height );
+	if ( left >= right || top >= bottom ) {
+		region.CellBegin[0] = region.CellEnd[0] = 0;
+		region.CellBegin[1] = region.CellEnd[1] = 0;
+		return;
+	}
+	region.CellBegin[0] = left / m_CellSize;
+	region.CellBegin[1] = top / m_CellSize;
+	region.CellEnd[0]	= ( right - 1 ) / m_CellSize + 1;
+	region.CellEnd[1]	= ( bottom - 1 ) / m_CellSize + 1;
+	for ( int row = region.CellBegin[1]; row < region.CellEnd[1]; ++row ) {
+		for ( int column = region.CellBegin[0]; column < region.CellEnd[0]; ++column ) {
+			m_Cells[row * m_NrOfColumns + column].push_back( index );
+		}
+	}
+}
+
+void PointerRouter::RemoveFromGrid( int index ) {
+	const Region& region = m_Regions[index];
+	for ( int row = region.CellBegin[1]; row < region.CellEnd[1]; ++row ) {
+		for ( int column = region.CellBegin[0]; column < region.CellEnd[0]; ++column ) {
+			pVector<int>& cell = m_Cells[row * m_NrOfColumns + column];
+			auto		  it   = std::find( cell.begin(), cell.end(), index );
+			if ( it != cell.end() ) {
+				*it = cell.back();
+				cell.pop_back();
+			}
+		}
+	}
+}
+
+void PointerRouter::GatherHits( int x, int y ) {
+	m_Hits.clear();
+	if ( x < 0 || y < 0 || x >= m_Width || y >= m_Height ) {
+		return;
+	}
+	for ( int index : m_Cells[( y / m_CellSize ) * m_NrOfColumns + x / m_CellSize] ) {
+		if ( m_Regions[index].Enabled && m_Regions[index].Rect.Contains( x, y ) ) {
+			m_Hits.push_back( index );
+		}
+	}
+	std::sort( m_Hits.begin(), m_Hits.end(), [this]( int lhs, int rhs ) {
+		return IsAbove( lhs, rhs );
+	} );
+}
+
+bool PointerRouter::Dispatch( POINTER_EVENT type, int x, int y, bool touch, const SDL_Event& event ) {
+	Sint64 pointer = -1;
+	if ( touch ) {
+		pointer = static_cast<Sint64>( event.tfinger.fingerId );
+	} else if ( type == POINTER_EVENT_PRESS || type == POINTER_EVENT_RELEASE ) {
+		pointer = event.button.button;
+	}
+
+	// Captured presses go to the region that consumed them regardless of where the pointer is
+	int captureIndex = -1;
+	if ( type == POINTER_EVENT_MOTION || type == POINTER_EVENT_RELEASE ) {
+		captureIndex = FindCapture( touch || type == POINTER_EVENT_RELEASE ? pointer : -1, touch );
+	}
+	if ( captureIndex != -1 ) {
+		int region = static_cast<int>( m_Captures[captureIndex].Region );
+		if ( type == POINTER_EVENT_RELEASE ) {
+			m_Captures.erase( m_Captures.begin() + captureIndex );
+		}
+		return Send( region, type, x, y, touch, &event );
+	}
+
+	GatherHits( x, y );
+	// Handlers may add or remove regions, which reuses the scratch list
+	pVector<int> hits;
+	hits.swap( m_Hits );
+	bool consumed = false;
+	for ( int index : hits ) {
+		if ( m_Regions[index].Alive && Send( index, type, x, y, touch, &event ) ) {
+			if ( type == POINTER_EVENT_PRESS ) {
+				m_Captures.push_back( Capture { pointer, touch, static_cast<PointerRegionHandle>( index ) } );
+			}
+			consumed = true;
+			break;
+		}
+	}
+	hits.swap( m_Hits );
+	return consumed;
+}
+
+bool PointerRouter::Send( int index, POINTER_EVENT type, int x, int y, bool touch, const SDL_Event* event ) {
+	// Copied since the handler may add regions and move the one being called
+	PointerHandlerFunction function = m_Regions[index].Function;
+	return function && function( PointerEvent { type, static_cast<PointerRegionHandle>( index ), x, y, touch, event } );
+}
+
+void PointerRouter::UpdateHover() {
+	PointerRegionHandle hovered = m_HasMousePosition ? HitTest( m_MouseX, m_MouseY ) : PointerRegionHandle();
+	if ( hovered == m_Hovered ) {
+		return;
+	}
+	PointerRegionHandle previous = m_Hovered;
+	m_Hovered					 = hovered;
+	if ( GetRegion( previous ) != nullptr ) {
+		Send( static_cast<int>( previous ), POINTER_EVENT_LEAVE, m_MouseX, m_MouseY, false, nullptr );
+	}
+	if ( m_Hovered == hovered && GetRegion( hovered ) != nullptr ) {
+		Send( static_cast<int>( hovered ), POINTER_EVENT_ENTER, m_MouseX, m_MouseY, false, nullptr );
+	}
+}
+
+bool PointerRouter::IsAbove( int lhs, int rhs ) const {
+	const Region& left	= m_Regions[lhs];
+	const Region& right = m_Regions[rhs];
+	return left.Z != right.Z ? left.Z > right.Z : left.Order > right.Order;
+}
+
+int PointerRouter::FindCapture( Sint64 pointer, bool touch ) const {
+	for ( size_t i = 0; i < m_Captures.size(); ++i ) {
+		if ( m_Captures[i].Touch == touch && ( m_Captures[i].Pointer == pointer || ( !touch && pointer == -1 ) ) ) {
+			return static_cast<int>( i );
+		}
+	}
+	return -1;
+}
+
+void PointerRouter::DropCaptures( PointerRegionHandle handle ) {
+	m_Captures.erase( std::remove_if( m_Captures.begin(), m_Captures.end(), [handle]( const Capture& capture ) {
+		return capture.Region == handle;
+	} ), m_Captures.end() );
+}
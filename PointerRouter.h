@@ -0,0 +1,129 @@
+#pragma once
+
+#include <functional>
+#include <SDL2/SDL_events.h>
+#include <utility/Handle.h>
+#include INPUT_ALLOCATION_HEADER
+#include "InputLibraryDefine.h"
+#include "InputStateTypes.h"
+#include "Types.h"
+
+class InputState;
+
+enum POINTER_EVENT {
+	POINTER_EVENT_PRESS,
+	POINTER_EVENT_RELEASE,
+	POINTER_EVENT_MOTION,
+	POINTER_EVENT_WHEEL,
+	POINTER_EVENT_ENTER,	// The mouse moved onto the region, or the region appeared below it
+	POINTER_EVENT_LEAVE,	// The mouse moved off the region or out of the window, or the region moved or was disabled
+};
+
+struct PointerRect {
+	int X;
+	int Y;
+	int Width;
+	int Height;
+
+	bool Contains( int x, int y ) const {
+		return x >= X && y >= Y && x - X < Width && y - Y < Height;
+	}
+};
+
+struct PointerRegionHandle_tag { };
+typedef Handle<PointerRegionHandle_tag, int, -1> PointerRegionHandle;
+
+struct PointerEvent {
+	POINTER_EVENT		Type;
+	PointerRegionHandle Region;
+	int					X;		// Window pixels
+	int					Y;
+	bool				Touch;
+	const SDL_Event*	Event;	// nullptr for enter and leave
+};
+
+// Returns true to consume the event. Otherwise it is offered to the next region below.
+typedef std::function<bool ( const PointerEvent& event )> PointerHandlerFunction;
+
+// Routes mouse and touch events to screen regions instead of offering them to every event interest.
+// Regions are kept in a uniform grid that is updated as they move, so a hit test only looks at the regions
+// overlapping one cell. Events go to the hit regions from the highest z down until one consumes it; a region
+// that consumes a press also gets the motion and release of that button or finger until it is let go.
+class PointerRouter {
+public:
+	// Registers with inputState at priority. Points outside width x height hit nothing.
+	INPUT_API PointerRouter( InputState& inputState, int width, int height, int cellSize = 64, int priority = 0 );
+	INPUT_API ~PointerRouter();
+
+	PointerRouter( const PointerRouter& rhs ) = delete;
+	PointerRouter& operator = ( const PointerRouter& rhs ) = delete;
+
+	// Regions with the same z are ordered by when they were added, later ones on top.
+	INPUT_API PointerRegionHandle AddRegion ( const PointerRect& rect, int z, PointerHandlerFunction handlerFunction );
+	INPUT_API void				  RemoveRegion ( PointerRegionHandle handle );
+	INPUT_API void				  SetRegionRect ( PointerRegionHandle handle, const PointerRect& rect );
+	INPUT_API void				  SetRegionZ ( PointerRegionHandle handle, int z );
+	// Disabling a region also ends the presses it captured; their releases go to whatever is below.
+	INPUT_API void				  SetRegionEnabled ( PointerRegionHandle handle, bool enabled );
+	// Changes the window size and rebuilds the grid.
+	INPUT_API void				  Resize ( int width, int height );
+
+	// Topmost enabled region at the point.
+	INPUT_API PointerRegionHandle HitTest ( int x, int y ) const;
+	INPUT_API PointerRegionHandle GetHoveredRegion () const;
+
+	// Called through the event interest. Exposed so a router can also be fed directly.
+	INPUT_API bool HandleEvent ( const SDL_Event& event );
+
+private:
+	struct Region {
+		PointerRect			   Rect;
+		int					   Z;
+		Uint32				   Order;
+		bool				   Enabled;
+		bool				   Alive;
+		int					   CellBegin[2];	// Grid cells the rect covers, [begin, end)
+		int					   CellEnd[2];
+		PointerHandlerFunction Function;
+	};
+
+	struct Capture {
+		Sint64				Pointer;	// Mouse button or finger id
+		bool				Touch;
+		PointerRegionHandle Region;
+	};
+
+	Region*		 GetRegion ( PointerRegionHandle handle );
+	void		 InsertInGrid ( int index );
+	void		 RemoveFromGrid ( int index );
+	void		 GatherHits ( int x, int y );
+	bool		 Dispatch ( POINTER_EVENT type, int x, int y, bool touch, const SDL_Event& event );
+	bool		 Send ( int index, POINTER_EVENT type, int x, int y, bool touch, const SDL_Event* event );
+	void		 UpdateHover ();
+	bool		 IsAbove ( int lhs, int rhs ) const;
+	// pointer -1 matches any mouse capture.
+	int			 FindCapture ( Sint64 pointer, bool touch ) const;
+	void		 DropCaptures ( PointerRegionHandle handle );
+
+	InputState&				 m_InputState;
+	InputEventCallbackHandle m_EventCallbackHandle;
+
+	int m_Width;
+	int m_Height;
+	int m_CellSize;
+	int m_NrOfColumns = 0;
+	int m_NrOfRows	  = 0;
+
+	pVector<Region>		  m_Regions;
+	pVector<int>		  m_FreeRegions;
+	pVector<pVector<int>> m_Cells;	// Region indices per cell, row major
+	Uint32				  m_NextOrder = 0;
+
+	pVector<int>	 m_Hits;	// Scratch, hit regions of the event being routed from the top down
+	pVector<Capture> m_Captures;
+
+	PointerRegionHandle m_Hovered;
+	bool				m_HasMousePosition = false;
+	int					m_MouseX		   = 0;
+	int					m_MouseY		   = 0;
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <SDL2/SDL_scancode.h>
+#include <SDL2/SDL_gamecontroller.h>
+#include "Types.h"
+
+// One action of a table declared at compile time.
+struct ActionDefinition {
+	const char*				 Name;
+	const char*				 Description;
+	SDL_Scancode			 DefaultScancode;
+	SDL_GameControllerButton DefaultButton;
+};
+
+// The actions of a bind context declared in a header, with identifiers known at compile time through
+// Identifier. Identifiers are First, First + 1, ... in declaration order. Tables are chained by starting one where the previous ends:
+//
+//	enum MENU_ACTION { MENU_ACTION_UP, MENU_ACTION_DOWN };
+//	constexpr ActionDefinition MENU_ACTIONS[] = {
+//		{ "up", "Move up", SDL_SCANCODE_UP, SDL_CONTROLLER_BUTTON_DPAD_UP },
+//		{ "down", "Move down", SDL_SCANCODE_DOWN, SDL_CONTROLLER_BUTTON_DPAD_DOWN },
+//	};
+//	constexpr auto MENU_TABLE = MakeActionTable( MENU_ACTIONS );
+//	constexpr auto GAME_TABLE = MakeActionTable<MENU_TABLE.End>( GAME_ACTIONS );
+//	static_assert( MENU_TABLE.HasUniqueNames(), "" );
+//
+// Register tables with KeyBindings::RegisterActionTable in the same order, before any runtime actions.
+template<int First, size_t NrOfActions>
+struct StaticActionTable {
+	static constexpr int FirstAction = First;
+	static constexpr int End		 = First + static_cast<int>( NrOfActions );
+	static constexpr int Size		 = static_cast<int>( NrOfActions );
+
+	const ActionDefinition* Definitions;
+
+	static constexpr int Identifier( int index ) {
+		return First + index;
+	}
+
+	// Not constexpr since ActionIdentifier isn't a literal type. Use Identifier where a constant is needed.
+	ActionIdentifier operator[] ( int index ) const {
+		return static_cast<ActionIdentifier>( First + index );
+	}
+
+	constexpr bool HasUniqueNames() const {
+		for ( size_t i = 0; i < NrOfActions; ++i ) {
+			for ( size_t j = i + 1; j < NrOfActions; ++j ) {
+				if ( NamesEqual( Definitions[i].Name, Definitions[j].Name ) ) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+private:
+	static constexpr bool NamesEqual( const char* lhs, const char* rhs ) {
+		for ( ; *lhs != '\0' && *lhs == *rhs; ++lhs, ++rhs ) { }
+		return *lhs == *rhs;
+	}
+};
+
+template<int First = 0, size_t NrOfActions>
+constexpr StaticActionTable<First, NrOfActions> MakeActionTable( const ActionDefinition ( &definitions )[NrOfActions] ) {
+	return StaticActionTable<First, NrOfActions> { definitions };
+}
@@ -0,0 +1,132 @@
+#include "StringPool.h"
+#include <algorithm>
+
+StringId StringPool::Intern( const char* str, size_t length ) {
+	Uint32 hash = Hash( str, length );
+	if ( !m_Slots.empty() ) {
+		size_t slot = FindSlot( str, length, hash );
+		if ( m_Slots[slot] != STRING_ID_INVALID ) {
+			return m_Slots[slot];
+		}
+	}
+	// Keep the table at most half full
+	if ( ( m_Offsets.size() + 1 ) * 2 > m_Slots.size() ) {
+		Rehash( m_Slots.empty() ? 64 : m_Slots.size() * 2 );
+	}
+
+	StringId id = static_cast<StringId>( m_Offsets.size() );
+	m_Offsets.push_back( static_cast<Uint32>( m_Characters.size() ) );
+	m_Lengths.push_back( static_cast<Uint32>( length ) );
+	m_Hashes.push_back( hash );
+	m_Characters.insert( m_Characters.end(), str, str + length );
+	m_Characters.push_back( '\0' );
+	m_Slots[FindSlot( str, length, hash )] = id;
+	return id;
+}
+
+StringId StringPool::Intern( const char* str ) {
+	return Intern( str, strlen( str ) );
+}
+
+StringId StringPool::Intern( const rString& str ) {
+	return Intern( str.c_str(), str.size() );
+}
+
+StringId StringPool::Concatenate( const char* first, const char* second, const char* third ) {
+	// Built at the end of the buffer, which is where a new string would go anyway
+	size_t start = m_Characters.size();
+	m_Characters.insert( m_Characters.end(), first, first + strlen( first ) );
+	m_Characters.insert( m_Characters.end(), second, second + strlen( second ) );
+	m_Characters.insert( m_Characters.end(), third, third + strlen( third ) );
+	size_t length = m_Characters.size() - start;
+
+	StringId existing = Find( m_Characters.data() + start, length );
+	if ( existing != STRING_ID_INVALID ) {
+		m_Characters.resize( start );
+		return existing;
+	}
+	if ( ( m_Offsets.size() + 1 ) * 2 > m_Slots.size() ) {
+		Rehash( m_Slots.empty() ? 64 : m_Slots.size() * 2 );
+	}
+	Uint32	 hash = Hash( m_Characters.data() + start, length );
+	StringId id	  = static_cast<StringId>( m_Offsets.size() );
+	m_Offsets.push_back( static_cast<Uint32>( start ) );
+	m_Lengths.push_back( static_cast<Uint32>( length ) );
+	m_Hashes.push_back( hash );
+	m_Characters.push_back( '\0' );
+	m_Slots[FindSlot( m_Characters.data() + start, length, hash )] = id;
+	return id;
+}
+
+StringId StringPool::Find( const char* str, size_t length ) const {
+	if ( m_Slots.empty() ) {
+		return STRING_ID_INVALID;
+	}
+	return m_Slots[FindSlot( str, length, Hash( str, length ) )];
+}
+
+const char* StringPool::Get( StringId id ) const {
+	return id < m_Offsets.size() ? m_Characters.data() + m_Offsets[id] : "";
+}
+
+size_t StringPool::GetLength( StringId id ) const {
+	return id < m_Lengths.size() ? m_Lengths[id] : 0;
+}
+
+int StringPool::GetNrOfStrings() const {
+	return static_cast<int>( m_Offsets.size() );
+}
+
+void StringPool::Reserve( int nrOfStrings, size_t nrOfCharacters ) {
+	size_t totalStrings = m_Offsets.size() + nrOfStrings;
+	m_Characters.reserve( m_Characters.size() + nrOfCharacters );
+	m_Offsets.reserve( totalStrings );
+	m_Lengths.reserve( totalStrings );
+	m_Hashes.reserve( totalStrings );
+	size_t nrOfSlots = 64;
+	while ( nrOfSlots < totalStrings * 2 ) {
+		nrOfSlots *= 2;
+	}
+	if ( nrOfSlots > m_Slots.size() ) {
+		Rehash( nrOfSlots );
+	}
+}
+
+void StringPool::Clear() {
+	m_Characters.clear();
+	m_Offsets.clear();
+	m_Lengths.clear();
+	m_Hashes.clear();
+	std::fill( m_Slots.begin(), m_Slots.end(), STRING_ID_INVALID );
+}
+
+Uint32 StringPool::Hash( const char* str, size_t length ) {
+	Uint32 hash = 2166136261u;
+	for ( size_t i = 0; i < length; ++i ) {
+		hash = ( hash ^ static_cast<Uint8>( str[i] ) ) * 16777619u;
+	}
+	return hash;
+}
+
+size_t StringPool::FindSlot( const char* str, size_t length, Uint32 hash ) const {
+	size_t mask = m_Slots.size() - 1;
+	for ( size_t slot = hash & mask;; slot = ( slot + 1 ) & mask ) {
+		StringId id = m_Slots[slot];
+		if ( id == STRING_ID_INVALID ||
+			 ( m_Hashes[id] == hash && m_Lengths[id] == length && memcmp( m_Characters.data() + m_Offsets[id], str, length ) == 0 ) ) {
+			return slot;
+		}
+	}
+}
+
+void StringPool::Rehash( size_t nrOfSlots ) {
+	m_Slots.assign( nrOfSlots, STRING_ID_INVALID );
+	size_t mask = nrOfSlots - 1;
+	for ( StringId id = 0; id < m_Offsets.size(); ++id ) {
+		size_t slot = m_Hashes[id] & mask;
+		while ( m_Slots[slot] != STRING_ID_INVALID ) {
+			slot = ( slot + 1 ) & mask;
+		}
+		m_Slots[slot] = id;
+	}
+}
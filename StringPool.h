@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstring>
+#include INPUT_ALLOCATION_HEADER
+#include "InputLibraryDefine.h"
+#include "Types.h"
+
+typedef Uint32 StringId;
+#define STRING_ID_INVALID 0xFFFFFFFFu
+
+// Interned strings stored back to back in one buffer and referred to by 32 bit ids. Interning a string that
+// is already in the pool returns the existing id without allocating.
+class StringPool {
+public:
+	INPUT_API StringId Intern ( const char* str, size_t length );
+	INPUT_API StringId Intern ( const char* str );
+	INPUT_API StringId Intern ( const rString& str );
+	// Interns the concatenation of the parts without building it first.
+	INPUT_API StringId Concatenate ( const char* first, const char* second, const char* third = "" );
+	// STRING_ID_INVALID if not interned.
+	INPUT_API StringId Find ( const char* str, size_t length ) const;
+
+	// Null terminated. Valid until the next string is interned, so don't intern strings taken from the pool itself.
+	INPUT_API const char* Get ( StringId id ) const;
+	INPUT_API size_t	  GetLength ( StringId id ) const;
+	INPUT_API int		  GetNrOfStrings () const;
+
+	// Makes room for nrOfStrings more strings of nrOfCharacters in total.
+	INPUT_API void Reserve ( int nrOfStrings, size_t nrOfCharacters );
+	INPUT_API void Clear ();
+
+private:
+	static Uint32 Hash ( const char* str, size_t length );
+	size_t		  FindSlot ( const char* str, size_t length, Uint32 hash ) const;
+	void		  Rehash ( size_t nrOfSlots );
+
+	pVector<char>	m_Characters;
+	pVector<Uint32> m_Offsets;	// Start of each string in m_Characters
+	pVector<Uint32> m_Lengths;
+	pVector<Uint32> m_Hashes;
+	pVector<Uint32> m_Slots;	// Open addressed table of ids, STRING_ID_INVALID if free
+};
@@ -18,6 +18,17 @@ enum class INPUT_API KeyBindingType {
 	Any
 };
 
+enum class BindContextStackMode {
+	PassThrough,	// Keys of lower contexts stay active
+	Shadow,			// Keys bound in this context hide the same keys in lower contexts
+	Block			// Lower contexts are inactive
+};
+
+struct ResolvedBinding {
+	BindContextHandle BindContext;
+	ActionIdentifier  Action;
+};
+
 #define INPUT_MAX_NR_OF_GAMEPADS 16
 
 enum INPUT_API MOUSE_BUTTON : Uint8 {
@@ -28,6 +39,13 @@ enum INPUT_API MOUSE_BUTTON : Uint8 {
 	MOUSE_BUTTON_5		= SDL_BUTTON_X2,
 };
 
+enum INPUT_API MOUSE_WHEEL : Uint8 {
+	MOUSE_WHEEL_UP,
+	MOUSE_WHEEL_DOWN,
+	MOUSE_WHEEL_LEFT,
+	MOUSE_WHEEL_RIGHT,
+};
+
 enum INPUT_TYPE {
 	INPUT_TYPE_NONE				= -3,
 	INPUT_TYPE_ANY				= -2,
@@ -0,0 +1,191 @@
+#include "VirtualDevicePool.h"
+#include <cassert>
+#include <algorithm>
+#include "KeyBindings.h"
+#include "BindContext.h"
+#include "InputBinding.h"
+
+VirtualDevicePool::VirtualDevicePool( int nrOfDevices )
+	: m_NrOfDevices( nrOfDevices ) {
+	assert( nrOfDevices > 0 );
+	m_KeyWords.resize( INPUT_KEYBOARD_STATE_WORDS * nrOfDevices, 0 );
+	m_MouseMasks.resize( nrOfDevices, 0 );
+	m_ButtonMasks.resize( nrOfDevices, 0 );
+	m_Axes.resize( SDL_CONTROLLER_AXIS_MAX * nrOfDevices, 0.0f );
+}
+
+void VirtualDevicePool::BeginFrame() {
+	m_PreviousActionBits = m_ActionBits;
+}
+
+void VirtualDevicePool::Clear() {
+	std::fill( m_KeyWords.begin(), m_KeyWords.end(), 0 );
+	std::fill( m_MouseMasks.begin(), m_MouseMasks.end(), 0 );
+	std::fill( m_ButtonMasks.begin(), m_ButtonMasks.end(), 0 );
+	std::fill( m_Axes.begin(), m_Axes.end(), 0.0f );
+}
+
+void VirtualDevicePool::SetKey( int device, SDL_Scancode scancode, bool down ) {
+	assert( device >= 0 && device < m_NrOfDevices && scancode < SDL_NUM_SCANCODES );
+	Uint64& word = m_KeyWords[( scancode >> 6 ) * m_NrOfDevices + device];
+	Uint64	bit	 = Uint64( 1 ) << ( scancode & 63 );
+	word		 = down ? word | bit : word & ~bit;
+}
+
+void VirtualDevicePool::SetMouseButton( int device, MOUSE_BUTTON button, bool down ) {
+	int index = InputBinding::Mouse( button ).GetMouseIndex();
+	assert( device >= 0 && device < m_NrOfDevices && index >= 0 );
+	Uint32 bit = 1u << index;
+	m_MouseMasks[device] = down ? m_MouseMasks[device] | bit : m_MouseMasks[device] & ~bit;
+}
+
+void VirtualDevicePool::SetMouseWheel( int device, MOUSE_WHEEL wheel, bool scrolled ) {
+	int index = InputBinding::Wheel( wheel ).GetMouseIndex();
+	assert( device >= 0 && device < m_NrOfDevices && index >= 0 );
+	Uint32 bit = 1u << index;
+	m_MouseMasks[device] = scrolled ? m_MouseMasks[device] | bit : m_MouseMasks[device] & ~bit;
+}
+
+void VirtualDevicePool::SetButton( int device, SDL_GameControllerButton button, bool down ) {
+	assert( device >= 0 && device < m_NrOfDevices && button >= 0 && button < SDL_CONTROLLER_BUTTON_MAX );
+	Uint32 bit = 1u << button;
+	m_ButtonMasks[device] = down ? m_ButtonMasks[device] | bit : m_ButtonMasks[device] & ~bit;
+}
+
+void VirtualDevicePool::SetButtonMask( int device, Uint32 buttonMask ) {
+	assert( device >= 0 && device < m_NrOfDevices );
+	m_ButtonMasks[device] = buttonMask;
+}
+
+void VirtualDevicePool::SetAxis( int device, SDL_GameControllerAxis axis, float value ) {
+	assert( device >= 0 && device < m_NrOfDevices && axis >= 0 && axis < SDL_CONTROLLER_AXIS_MAX );
+	m_Axes[axis * m_NrOfDevices + device] = value;
+}
+
+void VirtualDevicePool::SetButtonMasks( int firstDevice, int count, const Uint32* buttonMasks ) {
+	assert( firstDevice >= 0 && firstDevice + count <= m_NrOfDevices );
+	std::copy( buttonMasks, buttonMasks + count, m_ButtonMasks.begin() + firstDevice );
+}
+
+void VirtualDevicePool::SetAxes( SDL_GameControllerAxis axis, int firstDevice, int count, const float* values ) {
+	assert( firstDevice >= 0 && firstDevice + count <= m_NrOfDevices && axis >= 0 && axis < SDL_CONTROLLER_AXIS_MAX );
+	std::copy( values, values + count, m_Axes.begin() + axis * m_NrOfDevices + firstDevice );
+}
+
+bool VirtualDevicePool::KeyDown( int device, SDL_Scancode scancode ) const {
+	return ( ( m_KeyWords[( scancode >> 6 ) * m_NrOfDevices + device] >> ( scancode & 63 ) ) & 1 ) != 0;
+}
+
+Uint32 VirtualDevicePool::GetMouseMask( int device ) const {
+	return m_MouseMasks[device];
+}
+
+Uint32 VirtualDevicePool::GetButtonMask( int device ) const {
+	return m_ButtonMasks[device];
+}
+
+float VirtualDevicePool::GetAxis( int device, SDL_GameControllerAxis axis ) const {
+	return m_Axes[axis * m_NrOfDevices + device];
+}
+
+void VirtualDevicePool::Evaluate( const KeyBindings& keyBindings, BindContextHandle bindContextHandle ) {
+	int nrOfActions	  = keyBindings.GetNrOfActions();
+	m_NrOfActionWords = ( nrOfActions + 63 ) / 64;
+	m_ActionBits.assign( static_cast<size_t>( m_NrOfActionWords ) * m_NrOfDevices, 0 );
+	if ( m_PreviousActionBits.size() != m_ActionBits.size() ) {
+		m_PreviousActionBits.assign( m_ActionBits.size(), 0 );
+	}
+
+	const BindContext* context = keyBindings.GetBindContext( bindContextHandle );
+	for ( const BindContext::ActionTitleMapping& mapping : context->GetActions() ) {
+		ActionIdentifier		 identifier	  = mapping.Action;
+		int						 action		  = static_cast<int>( identifier );
+		SDL_Scancode			 primaryKey	  = keyBindings.GetActiveScancode( bindContextHandle, identifier, KeyBindingType::Primary );
+		SDL_Scancode			 secondaryKey = keyBindings.GetActiveScancode( bindContextHandle, identifier, KeyBindingType::Secondary );
+		InputBinding			 mouse		  = keyBindings.GetActiveMouseBinding( bindContextHandle, identifier );
+		SDL_GameControllerButton button		  = keyBindings.GetActiveButton( bindContextHandle, identifier );
+
+		// Unbound inputs get an empty mask so the loop below has no branches
+		const Uint64* primaryWords	 = &m_KeyWords[( primaryKey >> 6 ) * m_NrOfDevices];
+		const Uint64* secondaryWords = &m_KeyWords[( secondaryKey >> 6 ) * m_NrOfDevices];
+		Uint64 primaryMask	 = primaryKey != SDL_SCANCODE_UNKNOWN ? Uint64( 1 ) << ( primaryKey & 63 ) : 0;
+		Uint64 secondaryMask = secondaryKey != SDL_SCANCODE_UNKNOWN ? Uint64( 1 ) << ( secondaryKey & 63 ) : 0;
+		Uint32 mouseMask	 = mouse.GetMouseIndex() >= 0 ? 1u << mouse.GetMouseIndex() : 0;
+		Uint32 buttonMask	 = button != SDL_CONTROLLER_BUTTON_INVALID ? 1u << button : 0;
+		if ( ( primaryMask | secondaryMask | mouseMask | buttonMask ) == 0 ) {
+			continue;
+		}
+
+		const Uint32* mice	  = m_MouseMasks.data();
+		const Uint32* buttons = m_ButtonMasks.data();
+		Uint64*		  out	  = &m_ActionBits[( action >> 6 ) * m_NrOfDevices];
+		int			  shift	  = action & 63;
+		for ( int device = 0; device < m_NrOfDevices; ++device ) {
+			Uint64 down = ( ( primaryWords[device] & primaryMask ) | ( secondaryWords[device] & secondaryMask ) |
+							( mice[device] & mouseMask ) | ( buttons[device] & buttonMask ) ) != 0;
+			out[device] |= down << shift;
+		}
+	}
+
+	// Players that rebound buttons are redone with their own buttons, the others keep the shared result
+	int nrOfPlayers = std::min( m_NrOfDevices, INPUT_MAX_NR_OF_GAMEPADS );
+	for ( int device = 0; device < nrOfPlayers; ++device ) {
+		INPUT_TYPE player = static_cast<INPUT_TYPE>( device );
+		if ( !context->HasPlayerBindings( player ) ) {
+			continue;
+		}
+		for ( const BindContext::ActionTitleMapping& mapping : context->GetActions() ) {
+			ActionIdentifier		 identifier	  = mapping.Action;
+			int						 action		  = static_cast<int>( identifier );
+			SDL_Scancode			 primaryKey	  = keyBindings.GetActiveScancode( bindContextHandle, identifier, KeyBindingType::Primary );
+			SDL_Scancode			 secondaryKey = keyBindings.GetActiveScancode( bindContextHandle, identifier, KeyBindingType::Secondary );
+			InputBinding			 mouse		  = keyBindings.GetActiveMouseBinding( bindContextHandle, identifier );
+			SDL_GameControllerButton button		  = keyBindings.GetActiveButton( bindContextHandle, identifier, player );
+			bool down = ( primaryKey != SDL_SCANCODE_UNKNOWN && KeyDown( device, primaryKey ) ) ||
+						( secondaryKey != SDL_SCANCODE_UNKNOWN && KeyDown( device, secondaryKey ) ) ||
+						( mouse.GetMouseIndex() >= 0 && ( m_MouseMasks[device] & ( 1u << mouse.GetMouseIndex() ) ) != 0 ) ||
+						( button != SDL_CONTROLLER_BUTTON_INVALID && ( m_ButtonMasks[device] & ( 1u << button ) ) != 0 );
+			Uint64& word = m_ActionBits[( action >> 6 ) * m_NrOfDevices + device];
+			Uint64	bit	 = Uint64( 1 ) << ( action & 63 );
+			word		 = down ? word | bit : word & ~bit;
+		}
+	}
+}
+
+bool VirtualDevicePool::ActionDown( int device, ActionIdentifier action ) const {
+	return GetActionBit( m_ActionBits, device, action ) != 0;
+}
+
+bool VirtualDevicePool::ActionUp( int device, ActionIdentifier action ) const {
+	return GetActionBit( m_ActionBits, device, action ) == 0;
+}
+
+bool VirtualDevicePool::ActionUpDown( int device, ActionIdentifier action ) const {
+	return GetActionBit( m_ActionBits, device, action ) != 0 && GetActionBit( m_PreviousActionBits, device, action ) == 0;
+}
+
+bool VirtualDevicePool::ActionDownUp( int device, ActionIdentifier action ) const {
+	return GetActionBit( m_ActionBits, device, action ) == 0 && GetActionBit( m_PreviousActionBits, device, action ) != 0;
+}
+
+const Uint64* VirtualDevicePool::GetActionWord( int word ) const {
+	assert( word >= 0 && word < m_NrOfActionWords );
+	return &m_ActionBits[word * m_NrOfDevices];
+}
+
+int VirtualDevicePool::GetNrOfDevices() const {
+	return m_NrOfDevices;
+}
+
+int VirtualDevicePool::GetNrOfActionWords() const {
+	return m_NrOfActionWords;
+}
+
+Uint64 VirtualDevicePool::GetActionBit( const pVector<Uint64>& actionBits, int device, ActionIdentifier action ) const {
+	int index = static_cast<int>( action );
+	assert( device >= 0 && device < m_NrOfDevices );
+	if ( index < 0 || index >= m_NrOfActionWords * 64 || actionBits.empty() ) {
+		return 0;
+	}
+	return ( actionBits[( index >> 6 ) * m_NrOfDevices + device] >> ( index & 63 ) ) & 1;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <SDL2/SDL_scancode.h>
+#include <SDL2/SDL_gamecontroller.h>
+#include INPUT_ALLOCATION_HEADER
+#include "InputLibraryDefine.h"
+#include "InputQuery.h"
+#include "Types.h"
+
+class KeyBindings;
+
+// Keyboard and gamepad state for any number of simulated devices, e.g. bots.
+// State is stored as structure of arrays, one array per key word, button mask and axis, indexed by device,
+// so both bulk writes and the per frame action evaluation run over contiguous memory.
+class VirtualDevicePool {
+public:
+	INPUT_API VirtualDevicePool( int nrOfDevices );
+
+	// Remembers this frame's action state as the previous one. Call once per frame before Evaluate.
+	INPUT_API void BeginFrame ();
+	INPUT_API void Clear ();
+
+	INPUT_API void SetKey ( int device, SDL_Scancode scancode, bool down );
+	INPUT_API void SetMouseButton ( int device, MOUSE_BUTTON button, bool down );
+	// A scrolled wheel direction stays down until it is set again or the pool is cleared, so set it for one frame.
+	INPUT_API void SetMouseWheel ( int device, MOUSE_WHEEL wheel, bool scrolled );
+	INPUT_API void SetButton ( int device, SDL_GameControllerButton button, bool down );
+	INPUT_API void SetButtonMask ( int device, Uint32 buttonMask );
+	INPUT_API void SetAxis ( int device, SDL_GameControllerAxis axis, float value );
+	// Bulk writes for count devices starting at firstDevice.
+	INPUT_API void SetButtonMasks ( int firstDevice, int count, const Uint32* buttonMasks );
+	INPUT_API void SetAxes ( SDL_GameControllerAxis axis, int firstDevice, int count, const float* values );
+
+	INPUT_API bool	 KeyDown ( int device, SDL_Scancode scancode ) const;
+	// Mouse buttons and wheel directions, bit InputBinding::GetMouseIndex.
+	INPUT_API Uint32 GetMouseMask ( int device ) const;
+	INPUT_API Uint32 GetButtonMask ( int device ) const;
+	INPUT_API float	 GetAxis ( int device, SDL_GameControllerAxis axis ) const;
+
+	// Resolves every action of the bind context for all devices in one pass over the pool. The bindings are the ones
+	// KeyBindings::ActionDown would use, so the bind context stack hides the same ones. A device triggers an action
+	// through its key, mouse or gamepad bindings. Devices below INPUT_MAX_NR_OF_GAMEPADS are the players of that
+	// index and use their player bindings.
+	INPUT_API void Evaluate ( const KeyBindings& keyBindings, BindContextHandle bindContextHandle );
+
+	// Action queries, valid after Evaluate.
+	INPUT_API bool ActionDown ( int device, ActionIdentifier action ) const;
+	INPUT_API bool ActionUp ( int device, ActionIdentifier action ) const;
+	INPUT_API bool ActionUpDown ( int device, ActionIdentifier action ) const;
+	INPUT_API bool ActionDownUp ( int device, ActionIdentifier action ) const;
+	// Action bits of every device for actions [word * 64, word * 64 + 63], indexed by device.
+	INPUT_API const Uint64* GetActionWord ( int word ) const;
+
+	INPUT_API int GetNrOfDevices () const;
+	INPUT_API int GetNrOfActionWords () const;
+
+private:
+	Uint64 GetActionBit ( const pVector<Uint64>& actionBits, int device, ActionIdentifier action ) const;
+
+	int m_NrOfDevices;
+	int m_NrOfActionWords = 0;
+
+	pVector<Uint64> m_KeyWords;				// [word * m_NrOfDevices + device]
+	pVector<Uint32> m_MouseMasks;			// [device]
+	pVector<Uint32> m_ButtonMasks;			// [device]
+	pVector<float>	m_Axes;					// [axis * m_NrOfDevices + device]
+	pVector<Uint64> m_ActionBits;			// [word * m_NrOfDevices + device]
+	pVector<Uint64> m_PreviousActionBits;
+};